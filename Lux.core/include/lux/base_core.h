@@ -11,6 +11,15 @@
 #include <stdexcept>
 #include <chrono>
 
+/*
+*	MSVC accepts [[no_unique_address]] but ignores it to keep its ABI, the empty members need its own spelling
+*/
+#if defined(_MSC_VER) && !defined(__clang__)
+#define LUX_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define LUX_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+
 namespace lux
 {
 
@@ -0,0 +1,392 @@
+#pragma once
+
+#include <lux/base_core.h>
+
+#include <lux/simd.h>
+#include <lux/sorted_vector.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+namespace lux
+{
+
+	/**
+	 * @brief sorted_vector with a write buffer, for insert-heavy phases
+	 *
+	 * New entries are appended to a small unsorted buffer instead of being moved into place one by one.
+	 * The buffer is merged into the sorted entries in a single pass once it reaches the threshold,
+	 * or before an iterator is given out by begin(), end() or find(). The other lookups search the sorted entries and scan the buffer.
+	 * The merge does not change the entries, so the const members may do it too: like the modifiers,
+	 * the iteration and find must not run concurrently with other members.
+	*/
+	template<
+		class Key, class Value = void,
+		class Compare = std::less<Key>,
+		class Alloc = std::allocator<sorted_vector_type<Key, Value>>,
+		class Search = lux::default_search
+	>
+	class buffered_sorted_vector
+	{
+	public:
+		using sorted_type				= lux::sorted_vector<Key, Value, Compare, Alloc, Search>;
+
+		using key_type					= Key;
+		using mapped_type				= Value;
+		using value_type				= sorted_type::value_type;
+		using key_compare				= Compare;
+		using is_mapped					= sorted_type::is_mapped;
+		using vector_type				= sorted_type::vector_type;
+		using allocator_type			= sorted_type::allocator_type;
+		using size_type					= sorted_type::size_type;
+		using difference_type			= sorted_type::difference_type;
+		using reference					= sorted_type::reference;
+		using const_reference			= sorted_type::const_reference;
+		using pointer					= sorted_type::pointer;
+		using const_pointer				= sorted_type::const_pointer;
+		// begin(), end() and find() merge the buffer first, their iterators point into the sorted entries
+		using iterator					= pointer;
+		using const_iterator			= const_pointer;
+
+		// a scan of this many entries costs about as much as a few cache missing probes of the search
+		static constexpr size_type default_threshold = 256;
+
+	private:
+		using _access_return_type = decltype(std::declval<value_type&>().value());
+		using _const_access_return_type = decltype(std::declval<const value_type&>().value());
+
+		using _keys_type = std::vector<key_type, typename std::allocator_traits<allocator_type>::template rebind_alloc<key_type>>;
+
+		// with the natural order, equivalent keys are equal keys and the buffer can be scanned by value
+		static constexpr bool _dense_keys = _impls::_is_simd_key_v<key_type>
+			&& (std::is_same_v<key_compare, std::less<key_type>> || std::is_same_v<key_compare, std::less<>>);
+
+	public:
+		constexpr ~buffered_sorted_vector() = default;
+
+		constexpr explicit buffered_sorted_vector(size_type threshold = default_threshold, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+			: _main(comp, alloc), _buffer(alloc), _keys(alloc), _threshold(threshold > 0 ? threshold : 1) {
+		}
+		constexpr explicit buffered_sorted_vector(sorted_type&& sorted, size_type threshold = default_threshold)
+			: _main(std::move(sorted)), _buffer(_main.get_allocator()), _keys(_main.get_allocator()), _threshold(threshold > 0 ? threshold : 1) {
+		}
+
+		constexpr buffered_sorted_vector(const buffered_sorted_vector& other) = default;
+		constexpr buffered_sorted_vector(buffered_sorted_vector&& other) = default;
+
+		constexpr buffered_sorted_vector& operator=(const buffered_sorted_vector& other) = default;
+		constexpr buffered_sorted_vector& operator=(buffered_sorted_vector&& other) = default;
+
+		constexpr allocator_type get_allocator() const noexcept {
+			return _main.get_allocator();
+		}
+		constexpr key_compare key_comp() const {
+			return _main.key_comp();
+		}
+
+		constexpr size_type threshold() const noexcept {
+			return _threshold;
+		}
+		constexpr void set_threshold(size_type threshold) {
+			_threshold = threshold > 0 ? threshold : 1;
+			if (_buffer.size() >= _threshold)
+				flush();
+		}
+
+		constexpr bool empty() const noexcept {
+			return _main.empty() && _buffer.empty();
+		}
+		constexpr size_type size() const noexcept {
+			return _main.size() + _buffer.size();
+		}
+		/**
+		 * @brief Number of entries waiting in the buffer
+		*/
+		constexpr size_type buffered() const noexcept {
+			return _buffer.size();
+		}
+
+		/**
+		 * @brief Merge the buffer into the sorted entries, in O(n + m log n)
+		 *
+		 * The entries are merged into a new array that replaces the sorted one, so if a comparison,
+		 * a copy or the allocation throws, the container is left unchanged.
+		*/
+		constexpr void flush() const {
+			if (_buffer.empty())
+				return;
+
+			// the buffer is ordered through pointers and every position is found before an entry is moved
+			const auto& main = _main;
+			auto comp = _main.key_comp();
+			std::vector<value_type*> order;
+			order.reserve(_buffer.size());
+			for (auto& val : _buffer)
+				order.push_back(&val);
+			std::sort(order.begin(), order.end(), [&comp](const value_type* left, const value_type* right) { return comp(left->key(), right->key()); });
+
+			std::vector<size_type> positions;
+			positions.reserve(order.size());
+			for (auto val : order)
+				positions.push_back(static_cast<size_type>(main.lower_bound(val->key()) - main.begin()));
+
+			// the buffered keys are unique and missing from the sorted entries, nothing is dropped
+			vector_type merged(get_allocator());
+			merged.reserve(main.size() + order.size());
+			auto& sorted = _main.vector();
+			size_type from = 0;
+			for (size_type i = 0; i < order.size(); i++) {
+				for (; from < positions[i]; from++)
+					merged.push_back(std::move_if_noexcept(sorted[from]));
+				merged.push_back(std::move_if_noexcept(*order[i]));
+			}
+			for (; from < sorted.size(); from++)
+				merged.push_back(std::move_if_noexcept(sorted[from]));
+
+			sorted.swap(merged);
+			_buffer.clear();
+			_keys.clear();
+		}
+
+		/**
+		 * @brief The sorted entries, after flushing the buffer
+		*/
+		constexpr sorted_type& sorted() {
+			flush();
+			return _main;
+		}
+
+		/*
+		*	Ordered iteration flushes the buffer, so begin() and end() may be taken in any order
+		*/
+
+		constexpr iterator begin() {
+			flush();
+			return std::to_address(_main.begin());
+		}
+		constexpr const_iterator begin() const {
+			flush();
+			return std::to_address(_main.begin());
+		}
+		constexpr const_iterator cbegin() const {
+			return begin();
+		}
+
+		constexpr iterator end() {
+			flush();
+			return std::to_address(_main.end());
+		}
+		constexpr const_iterator end() const {
+			flush();
+			return std::to_address(_main.end());
+		}
+		constexpr const_iterator cend() const {
+			return end();
+		}
+
+		constexpr void clear() noexcept {
+			_main.clear();
+			_buffer.clear();
+			_keys.clear();
+		}
+
+	private:
+		constexpr bool _equal(const key_type& left, const key_type& right) const {
+			auto comp = _main.key_comp();
+			return !comp(left, right) && !comp(right, left);
+		}
+
+		constexpr size_type _buffer_find(const key_type& key) const {
+			if constexpr (_dense_keys)
+				return _impls::_find_equal(_keys.data(), _keys.size(), key);
+			else {
+				for (size_type i = 0; i < _buffer.size(); i++) {
+					if (_equal(_buffer[i].key(), key))
+						return i;
+				}
+				return _buffer.size();
+			}
+		}
+
+		// the entry with the given key in the sorted entries or the buffer of self, nullptr if it is missing
+		template< class Self >
+		static constexpr auto _find_in(Self& self, const key_type& key) -> decltype(self._buffer.data()) {
+			auto it = self._main.find(key);
+			if (it != self._main.end())
+				return std::to_address(it);
+
+			auto pos = self._buffer_find(key);
+			if (pos != self._buffer.size())
+				return self._buffer.data() + pos;
+			return nullptr;
+		}
+
+		constexpr pointer _find(const key_type& key) {
+			return _find_in(*this, key);
+		}
+		constexpr const_pointer _find(const key_type& key) const {
+			return _find_in(*this, key);
+		}
+
+		// the entry that would fill the buffer goes straight into the sorted entries after the flush
+		constexpr iterator _push(value_type&& val) {
+			if (_buffer.size() + 1 >= _threshold) {
+				flush();
+				return std::to_address(_main.emplace(std::move(val)).first);
+			}
+
+			if constexpr (_dense_keys) {
+				_keys.push_back(val.key());
+				try {
+					_buffer.push_back(std::move(val));
+				}
+				catch (...) {
+					_keys.pop_back();
+					throw;
+				}
+			}
+			else
+				_buffer.push_back(std::move(val));
+			return &_buffer.back();
+		}
+
+	public:
+		/**
+		 * @brief Insert an entry if its key is missing, in O(log n + threshold)
+		 *
+		 * The iterator points to the entry in the sorted entries or in the buffer, the next insertion or flush invalidates it;
+		 * find gives an iterator that can be compared with end().
+		*/
+		template< class... Args >
+		constexpr std::pair<iterator, bool> emplace(Args&&... args) {
+			value_type val{ std::forward<Args>(args)... };
+			if (auto ptr = _find(val.key()))
+				return { ptr, false };
+
+			return { _push(std::move(val)), true };
+		}
+
+		constexpr std::pair<iterator, bool> insert(const value_type& value) {
+			return emplace(value);
+		}
+		constexpr std::pair<iterator, bool> insert(value_type&& value) {
+			return emplace(std::move(value));
+		}
+
+		/**
+		 * @brief Insert a range of entries, they are merged at once with the buffer
+		*/
+		template< class It >
+		constexpr void insert(It first, It last) {
+			flush();
+			_main.insert(first, last);
+		}
+
+		template< class K, class... Args >
+		constexpr std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+			static_assert(is_mapped::value, "mapped_value must be valid");
+
+			if (auto ptr = _find(key))
+				return { ptr, false };
+
+			return { _push(value_type(std::forward<K>(key), mapped_type(std::forward<Args>(args)...))), true };
+		}
+
+		template< class K, class T >
+		constexpr std::pair<iterator, bool> insert_or_assign(K&& key, T&& val) {
+			static_assert(is_mapped::value, "mapped_value must be valid");
+
+			if (auto ptr = _find(key)) {
+				ptr->value() = std::forward<T>(val);
+				return { ptr, false };
+			}
+
+			return { _push(value_type(std::forward<K>(key), std::forward<T>(val))), true };
+		}
+
+		constexpr size_type erase(const key_type& key) {
+			if (_main.erase(key) > 0)
+				return 1;
+
+			auto pos = _buffer_find(key);
+			if (pos == _buffer.size())
+				return 0;
+
+			// the buffer is unordered, the last entry fills the hole
+			if (pos + 1 != _buffer.size()) {
+				_buffer[pos] = std::move(_buffer.back());
+				if constexpr (_dense_keys)
+					_keys[pos] = _keys.back();
+			}
+			_buffer.pop_back();
+			if constexpr (_dense_keys)
+				_keys.pop_back();
+			return 1;
+		}
+
+		/*
+		*	Lookups do not flush the buffer, but for find
+		*/
+
+		/**
+		 * @brief Iterator to the entry with the given key, end() if it is missing
+		 *
+		 * The buffer is merged first, so the iterator is valid against begin() and end() until the next insertion;
+		 * contains and at test for a key without merging.
+		*/
+		constexpr iterator find(const key_type& key) {
+			flush();
+			return std::to_address(_main.find(key));
+		}
+		constexpr const_iterator find(const key_type& key) const {
+			flush();
+			return std::to_address(_main.find(key));
+		}
+
+		constexpr bool contains(const key_type& key) const {
+			return _main.contains(key) || _buffer_find(key) != _buffer.size();
+		}
+		constexpr size_type count(const key_type& key) const {
+			return contains(key) ? 1 : 0;
+		}
+
+		constexpr _access_return_type at(const key_type& key) {
+			if (auto ptr = _find(key))
+				return ptr->value();
+
+			if constexpr (is_mapped::value)
+				throw std::out_of_range("invalid lux::buffered_sorted_vector<K, T> key");
+			else
+				throw std::out_of_range("invalid lux::buffered_sorted_vector<K> key");
+		}
+		constexpr _const_access_return_type at(const key_type& key) const {
+			if (auto ptr = _find(key))
+				return ptr->value();
+
+			if constexpr (is_mapped::value)
+				throw std::out_of_range("invalid lux::buffered_sorted_vector<K, T> key");
+			else
+				throw std::out_of_range("invalid lux::buffered_sorted_vector<K> key");
+		}
+
+		constexpr _access_return_type operator[](const key_type& key) {
+			if (auto ptr = _find(key))
+				return ptr->value();
+
+			if constexpr (is_mapped::value)
+				return _push(value_type(key, mapped_type{}))->value();
+			else
+				return _push(value_type(key))->value();
+		}
+
+	private:
+		// the merge of the buffer keeps the entries, so it is done by the const members too
+		mutable sorted_type _main;
+		mutable vector_type _buffer;
+		mutable _keys_type _keys;
+		size_type _threshold;
+	};
+
+}
@@ -3,18 +3,20 @@
 #include <lux/base_core.h>
 
 #include <lux/math.h>
+#include <lux/stats.h>
 
 #include <memory>
 
 namespace lux
 {
 
-	template< class Ty, class Ay = std::allocator<Ty> >
+	template< class Ty, class Ay = std::allocator<Ty>, class Stats = lux::no_stats >
 	class dynamic_array
 	{
 	public:
 		using value_type = Ty;
 		using allocator_type = Ay;
+		using stats_type = Stats;
 
 		using size_type = size_t;
 		using difference_type = ptrdiff_t;
@@ -237,6 +239,18 @@ namespace lux
 			return _alloc;
 		}
 
+		/**
+		 * @brief Operation counters of the array, all zero unless its stats policy counts
+		 *
+		 * Counted are the bytes allocated, and the reallocations of resize with the elements they move.
+		*/
+		container_stats stats() const noexcept {
+			return _stats.get();
+		}
+		constexpr void reset_stats() noexcept {
+			_stats.reset();
+		}
+
 		/*
 		*	Iterators
 		*/
@@ -314,6 +328,9 @@ namespace lux
 			}
 			else {
 				auto newdata = _alloc_array(count);
+				// the bytes of newdata are counted by _alloc_array
+				if (!empty())
+					_stats.reallocated(0, count < _size ? count : _size);
 				if (count > _size) {
 					for (size_type i = 0; i < _size; i++)
 						new (newdata + i) value_type(std::move(_data[i]));
@@ -337,6 +354,9 @@ namespace lux
 			}
 			else {
 				auto newdata = _alloc_array(count);
+				// the bytes of newdata are counted by _alloc_array
+				if (!empty())
+					_stats.reallocated(0, count < _size ? count : _size);
 				if (count > _size) {
 					for (size_type i = 0; i < _size; i++)
 						new (newdata + i) value_type(std::move(_data[i]));
@@ -358,6 +378,7 @@ namespace lux
 		pointer _alloc_array(size_type size) {
 			if (size == 0)
 				return nullptr;
+			_stats.allocated(size * sizeof(value_type));
 			return _alloc.allocate(size);
 		}
 		void _dealloc_array(pointer data, size_type size) {
@@ -368,6 +389,7 @@ namespace lux
 
 		size_type _size;
 		pointer _data;
+		LUX_NO_UNIQUE_ADDRESS stats_type _stats;
 	};
 
 }
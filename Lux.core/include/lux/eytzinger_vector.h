@@ -0,0 +1,360 @@
+#pragma once
+
+#include <lux/base_core.h>
+
+#include <lux/memory.h>
+#include <lux/sorted_vector.h>
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <vector>
+
+namespace lux
+{
+
+	/**
+	 * @brief Frozen, read-only companion of sorted_vector
+	 *
+	 * The entries are stored in Eytzinger (BFS) order: the node k has its children at 2k and 2k + 1 (1-based).
+	 * The first levels of the implicit tree share few cache lines and the descendants of the next levels are
+	 * prefetched while searching, so a lookup costs far fewer cache misses than a search on the flat layout.
+	 * Iteration visits the tree in order, so it yields the same sequence as the source sorted_vector.
+	*/
+	template<
+		class Key, class Value = void,
+		class Compare = std::less<Key>,
+		class Alloc = std::allocator<sorted_vector_type<Key, Value>>
+	>
+	class eytzinger_vector
+	{
+		using _this_type = sorted_vector_type<Key, Value>;
+
+	public:
+		class const_iterator;
+
+		using key_type					= Key;
+		using mapped_type				= Value;
+		using value_type				= _this_type;
+		using key_compare				= Compare;
+		using is_mapped					= _this_type::is_mapped;
+		using vector_type				= std::vector<value_type, Alloc>;
+		using allocator_type			= vector_type::allocator_type;
+		using size_type					= vector_type::size_type;
+		using difference_type			= vector_type::difference_type;
+		using reference					= vector_type::const_reference;
+		using const_reference			= vector_type::const_reference;
+		using pointer					= vector_type::const_pointer;
+		using const_pointer				= vector_type::const_pointer;
+		using iterator					= const_iterator;
+		using reverse_iterator			= std::reverse_iterator<const_iterator>;
+		using const_reverse_iterator	= std::reverse_iterator<const_iterator>;
+
+		template< class Search, class Stats = lux::no_stats >
+		using sorted_vector_t = lux::sorted_vector<Key, Value, Compare, Alloc, Search, Stats>;
+
+	private:
+		using _const_access_return_type = decltype(std::declval<const value_type&>().value());
+
+		static inline const key_type& _key(const value_type& value) {
+			return value.key();
+		}
+		static inline _const_access_return_type _value(const value_type& value) {
+			return value.value();
+		}
+
+		// entries sharing a cache line, the prefetch distance of the search,
+		// the descendants of a node d levels down are 2^d consecutive nodes so it must be a power of two
+		static constexpr size_type _block = std::bit_floor(std::max<size_type>(1, 64 / sizeof(value_type)));
+
+		/*
+		*	In-order navigation over the 1-based node indices, 0 is the end
+		*/
+
+		static constexpr size_type _leftmost(size_type k, size_type n) noexcept {
+			while (2 * k <= n)
+				k = 2 * k;
+			return k;
+		}
+		static constexpr size_type _rightmost(size_type k, size_type n) noexcept {
+			while (2 * k + 1 <= n)
+				k = 2 * k + 1;
+			return k;
+		}
+
+		static constexpr size_type _first(size_type n) noexcept {
+			return n > 0 ? _leftmost(1, n) : 0;
+		}
+		static constexpr size_type _next(size_type k, size_type n) noexcept {
+			if (2 * k + 1 <= n)
+				return _leftmost(2 * k + 1, n);
+			// climb while k is a right child, then one more step
+			return k >> (std::countr_one(k) + 1);
+		}
+		static constexpr size_type _prev(size_type k, size_type n) noexcept {
+			if (k == 0)
+				return n > 0 ? _rightmost(1, n) : 0;
+			if (2 * k <= n)
+				return _rightmost(2 * k, n);
+			// climb while k is a left child, then one more step
+			return k >> (std::countr_zero(k) + 1);
+		}
+
+	public:
+		class const_iterator
+		{
+			friend class eytzinger_vector;
+
+		public:
+			using iterator_category	= std::bidirectional_iterator_tag;
+			using value_type		= eytzinger_vector::value_type;
+			using difference_type	= eytzinger_vector::difference_type;
+			using pointer			= eytzinger_vector::const_pointer;
+			using reference			= eytzinger_vector::const_reference;
+
+			constexpr const_iterator() noexcept
+				: _data(nullptr), _size(0), _node(0) {
+			}
+
+			constexpr reference operator*() const noexcept {
+				return _data[_node - 1];
+			}
+			constexpr pointer operator->() const noexcept {
+				return _data + (_node - 1);
+			}
+
+			constexpr const_iterator& operator++() noexcept {
+				_node = _next(_node, _size);
+				return *this;
+			}
+			constexpr const_iterator operator++(int) noexcept {
+				auto tmp = *this;
+				++(*this);
+				return tmp;
+			}
+			constexpr const_iterator& operator--() noexcept {
+				_node = _prev(_node, _size);
+				return *this;
+			}
+			constexpr const_iterator operator--(int) noexcept {
+				auto tmp = *this;
+				--(*this);
+				return tmp;
+			}
+
+			constexpr bool operator==(const const_iterator& other) const noexcept {
+				return _node == other._node && _data == other._data;
+			}
+
+			/**
+			 * @brief Position of the entry in the Eytzinger array, size() for the end
+			*/
+			constexpr size_type index() const noexcept {
+				return _node == 0 ? _size : _node - 1;
+			}
+
+		private:
+			constexpr const_iterator(const_pointer data, size_type size, size_type node) noexcept
+				: _data(data), _size(size), _node(node) {
+			}
+
+			const_pointer _data;
+			size_type _size;
+			size_type _node;
+		};
+
+		constexpr ~eytzinger_vector() = default;
+
+		constexpr eytzinger_vector(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+			: _data(alloc), _comp(comp) {
+		}
+
+		template< class Search, class Stats >
+		explicit eytzinger_vector(const sorted_vector_t<Search, Stats>& other)
+			: _data(other.get_allocator()), _comp(other.key_comp()) {
+			_build(other.vector(), [](const value_type& val) -> const value_type& { return val; });
+		}
+		template< class Search, class Stats >
+		explicit eytzinger_vector(sorted_vector_t<Search, Stats>&& other)
+			: _data(other.get_allocator()), _comp(other.key_comp()) {
+			_build(other.vector(), [](value_type& val) -> value_type&& { return std::move(val); });
+			other.clear();
+		}
+
+		constexpr eytzinger_vector(const eytzinger_vector& other) = default;
+		constexpr eytzinger_vector(eytzinger_vector&& other) = default;
+
+		constexpr eytzinger_vector& operator=(const eytzinger_vector& other) = default;
+		constexpr eytzinger_vector& operator=(eytzinger_vector&& other) = default;
+
+		/**
+		 * @brief Copy the entries back to a sorted_vector, in O(n)
+		*/
+		template< class Search = lux::default_search >
+		sorted_vector_t<Search> to_sorted_vector() const& {
+			sorted_vector_t<Search> res(_comp, _data.get_allocator());
+			auto& vec = res.vector();
+			vec.reserve(size());
+			for (auto& el : *this)
+				vec.push_back(el);
+
+			return res;
+		}
+		/**
+		 * @brief Move the entries back to a sorted_vector, in O(n)
+		*/
+		template< class Search = lux::default_search >
+		sorted_vector_t<Search> to_sorted_vector() && {
+			sorted_vector_t<Search> res(_comp, _data.get_allocator());
+			auto& vec = res.vector();
+			vec.reserve(size());
+			for (auto k = _first(size()); k != 0; k = _next(k, size()))
+				vec.push_back(std::move(_data[k - 1]));
+			_data.clear();
+
+			return res;
+		}
+
+		constexpr const vector_type& vector() const noexcept {
+			return _data;
+		}
+
+		constexpr allocator_type get_allocator() const noexcept {
+			return _data.get_allocator();
+		}
+		constexpr key_compare key_comp() const {
+			return _comp;
+		}
+
+		constexpr bool empty() const noexcept {
+			return _data.empty();
+		}
+		constexpr size_type size() const noexcept {
+			return _data.size();
+		}
+
+		constexpr const_iterator begin() const noexcept {
+			return { _data.data(), size(), _first(size()) };
+		}
+		constexpr const_iterator cbegin() const noexcept {
+			return begin();
+		}
+		constexpr const_iterator end() const noexcept {
+			return { _data.data(), size(), 0 };
+		}
+		constexpr const_iterator cend() const noexcept {
+			return end();
+		}
+
+		constexpr const_reverse_iterator rbegin() const noexcept {
+			return const_reverse_iterator(end());
+		}
+		constexpr const_reverse_iterator crbegin() const noexcept {
+			return rbegin();
+		}
+		constexpr const_reverse_iterator rend() const noexcept {
+			return const_reverse_iterator(begin());
+		}
+		constexpr const_reverse_iterator crend() const noexcept {
+			return rend();
+		}
+
+	private:
+		template< class Vec, class Get >
+		void _build(Vec& sorted, Get get) {
+			const auto n = sorted.size();
+
+			// index of the sorted entry that belongs to every node
+			std::vector<size_type> order(n);
+			size_type i = 0;
+			for (auto k = _first(n); k != 0; k = _next(k, n))
+				order[k - 1] = i++;
+
+			_data.reserve(n);
+			for (size_type k = 0; k < n; k++)
+				_data.emplace_back(get(sorted[order[k]]));
+		}
+
+		constexpr size_type _lower_bound(const key_type& key) const {
+			const auto n = size();
+			const auto data = _data.data();
+
+			size_type k = 1;
+			while (k <= n) {
+				if (k * _block <= n)
+					lux::prefetch(data + (k * _block - 1));
+				k = 2 * k + (_comp(_key(data[k - 1]), key) ? 1 : 0);
+			}
+
+			// drop the trailing right turns and the last left turn
+			return k >> (std::countr_one(k) + 1);
+		}
+		constexpr size_type _upper_bound(const key_type& key) const {
+			const auto n = size();
+			const auto data = _data.data();
+
+			size_type k = 1;
+			while (k <= n) {
+				if (k * _block <= n)
+					lux::prefetch(data + (k * _block - 1));
+				k = 2 * k + (_comp(key, _key(data[k - 1])) ? 0 : 1);
+			}
+
+			return k >> (std::countr_one(k) + 1);
+		}
+
+		constexpr size_type _find(const key_type& key) const {
+			auto k = _lower_bound(key);
+			if (k != 0 && !_comp(key, _key(_data[k - 1])))
+				return k;
+			return 0;
+		}
+
+		constexpr const_iterator _make(size_type k) const noexcept {
+			return { _data.data(), size(), k };
+		}
+
+	public:
+		constexpr const_iterator find(const key_type& key) const {
+			return _make(_find(key));
+		}
+
+		constexpr bool contains(const key_type& key) const {
+			return _find(key) != 0;
+		}
+		constexpr size_type count(const key_type& key) const {
+			return _find(key) != 0 ? 1 : 0;
+		}
+
+		constexpr _const_access_return_type at(const key_type& key) const {
+			auto k = _find(key);
+			if (k != 0)
+				return _value(_data[k - 1]);
+
+			if constexpr (is_mapped::value)
+				throw std::out_of_range("invalid lux::eytzinger_vector<K, T> key");
+			else
+				throw std::out_of_range("invalid lux::eytzinger_vector<K> key");
+		}
+
+		constexpr const_iterator lower_bound(const key_type& key) const {
+			return _make(_lower_bound(key));
+		}
+		constexpr const_iterator upper_bound(const key_type& key) const {
+			return _make(_upper_bound(key));
+		}
+		constexpr std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+			auto k = _find(key);
+			if (k == 0) {
+				auto ub = upper_bound(key);
+				return { ub, ub };
+			}
+			return { _make(k), _make(_next(k, size())) };
+		}
+
+	private:
+		vector_type _data;
+		key_compare _comp;
+	};
+
+}
@@ -0,0 +1,372 @@
+#pragma once
+
+#include <lux/base_core.h>
+
+#include <lux/math.h>
+#include <lux/searching.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+
+namespace lux
+{
+
+	namespace _impls
+	{
+
+		/**
+		 * @brief Perfect hash over N integral keys, built at compile time
+		 *
+		 * Hash and displace: the keys are spread over buckets, then every bucket, the largest first,
+		 * searches a displacement that sends all its keys to free slots. Every displacement tried costs
+		 * the slot probes it makes, and all the seeds share a budget linear in N, so the build stays
+		 * within the step limits of the constant evaluation. The build gives up (valid() is false)
+		 * once the budget is spent, and the lookups fall back to the search.
+		*/
+		template< size_t N >
+		class _frozen_hash
+		{
+		public:
+			static constexpr size_t table_size = std::bit_ceil(N + N / 4 + 1);
+			static constexpr size_t bucket_count = N / 2 + 1;
+
+			constexpr _frozen_hash() = default;
+
+			template< class Key >
+			constexpr bool build(const std::array<Key, N>& keys) {
+				size_t budget = _budget;
+				for (uint64_t seed = 1; seed <= _seeds; seed++) {
+					if (_try_build(keys, seed, budget)) {
+						_seed = seed;
+						return _valid = true;
+					}
+				}
+				return _valid = false;
+			}
+
+			constexpr bool valid() const noexcept {
+				return _valid;
+			}
+
+			// position of the key among the N keys if it is one of them, N otherwise
+			template< class Key >
+			constexpr size_t lookup(const Key& key) const noexcept {
+				const auto h = _hash(key, _seed);
+				const auto slot = _slot(h, _displace[h % bucket_count]);
+				return _slots[slot] == 0 ? N : _slots[slot] - 1;
+			}
+
+		private:
+			static constexpr uint64_t _seeds = 16;
+			static constexpr uint32_t _displacements = 1 << 16;
+			// slot probes of all the seeds, a successful seed takes about 4 to 8 per key
+			static constexpr size_t _budget = 32 * N + 1024;
+
+			template< class Key >
+			static constexpr uint64_t _hash(const Key& key, uint64_t seed) noexcept {
+				return mix64(static_cast<uint64_t>(key) ^ mix64(seed));
+			}
+			static constexpr size_t _slot(uint64_t h, uint32_t d) noexcept {
+				return static_cast<size_t>(mix64(h + d * 0x9e3779b97f4a7c15ull)) & (table_size - 1);
+			}
+
+			template< class Key >
+			constexpr bool _try_build(const std::array<Key, N>& keys, uint64_t seed, size_t& budget) {
+				_slots = {};
+				_displace = {};
+
+				std::array<uint64_t, N> hashes{};
+				std::array<size_t, bucket_count> sizes{};
+				for (size_t i = 0; i < N; i++) {
+					hashes[i] = _hash(keys[i], seed);
+					sizes[hashes[i] % bucket_count]++;
+				}
+
+				// keys grouped by bucket, largest buckets first
+				std::array<size_t, N> order{};
+				for (size_t i = 0; i < N; i++)
+					order[i] = i;
+				std::sort(order.begin(), order.end(), [&](size_t left, size_t right) {
+					const auto lb = hashes[left] % bucket_count, rb = hashes[right] % bucket_count;
+					return sizes[lb] != sizes[rb] ? sizes[lb] > sizes[rb] : lb < rb;
+				});
+
+				for (size_t first = 0; first < N;) {
+					const auto bucket = hashes[order[first]] % bucket_count;
+					const auto last = first + sizes[bucket];
+					// probes of a displacement, the keys of the bucket are also checked against each other
+					const auto cost = (last - first) * (last - first + 1) / 2;
+
+					bool placed = false;
+					for (uint32_t d = 0; d < _displacements && !placed; d++) {
+						if (budget < cost)
+							return false;
+						budget -= cost;
+
+						placed = true;
+						for (size_t i = first; i < last && placed; i++) {
+							const auto slot = _slot(hashes[order[i]], d);
+							placed = _slots[slot] == 0;
+							// keys of the same bucket must not collide either
+							for (size_t j = first; j < i && placed; j++)
+								placed = _slot(hashes[order[j]], d) != slot;
+						}
+						if (placed) {
+							_displace[bucket] = d;
+							for (size_t i = first; i < last; i++)
+								_slots[_slot(hashes[order[i]], d)] = static_cast<uint32_t>(order[i] + 1);
+						}
+					}
+					if (!placed)
+						return false;
+
+					first = last;
+				}
+
+				return true;
+			}
+
+			std::array<uint32_t, table_size> _slots{};
+			std::array<uint32_t, bucket_count> _displace{};
+			uint64_t _seed = 0;
+			bool _valid = false;
+		};
+
+	}
+
+	/**
+	 * @brief Immutable sorted table, sorted and indexed at compile time
+	 *
+	 * Built with make_frozen_map or make_frozen_set, a constexpr instance lives in read-only storage and
+	 * needs no allocation nor sorting at startup. The lookup API is the one of sorted_vector.
+	 * Integral keys under the natural order also get a perfect hash, so find is O(1).
+	*/
+	template<
+		class Key, class Value, size_t N,
+		class Compare = std::less<Key>,
+		class Search = lux::branchless_search
+	>
+	class frozen_vector
+	{
+	public:
+		using key_type					= Key;
+		using mapped_type				= Value;
+		using is_mapped					= std::negation<std::is_same<Value, void>>;
+		using value_type				= std::conditional_t<is_mapped::value, std::pair<key_type, mapped_type>, key_type>;
+		using key_compare				= Compare;
+		using search_type				= Search;
+		using array_type				= std::array<value_type, N>;
+		using size_type					= size_t;
+		using difference_type			= ptrdiff_t;
+		using reference					= const value_type&;
+		using const_reference			= const value_type&;
+		using pointer					= const value_type*;
+		using const_pointer				= const value_type*;
+		using iterator					= array_type::const_iterator;
+		using const_iterator			= array_type::const_iterator;
+		using reverse_iterator			= array_type::const_reverse_iterator;
+		using const_reverse_iterator	= array_type::const_reverse_iterator;
+
+	private:
+		using _const_access_return_type = std::conditional_t<is_mapped::value, std::add_lvalue_reference_t<const mapped_type>, const key_type&>;
+
+		static constexpr bool _hashable = std::is_integral_v<key_type> && !std::is_same_v<key_type, bool>
+			&& (std::is_same_v<key_compare, std::less<key_type>> || std::is_same_v<key_compare, std::less<>>);
+
+		struct _no_hash { };
+		using _hash_type = std::conditional_t<_hashable, _impls::_frozen_hash<N>, _no_hash>;
+
+		static constexpr const key_type& _key(const value_type& value) noexcept {
+			if constexpr (is_mapped::value)
+				return value.first;
+			else
+				return value;
+		}
+		static constexpr _const_access_return_type _value(const value_type& value) noexcept {
+			if constexpr (is_mapped::value)
+				return value.second;
+			else
+				return value;
+		}
+
+		struct _key_projection
+		{
+			constexpr const key_type& operator()(const value_type& value) const noexcept {
+				return _key(value);
+			}
+		};
+
+	public:
+		/**
+		 * @brief Sort the entries and build the index
+		 * @throw std::invalid_argument if two entries have equal keys, a compile error in a constant expression
+		*/
+		constexpr explicit frozen_vector(const array_type& data, const key_compare& comp = key_compare())
+			: _data(data), _comp(comp), _search(), _hash() {
+			std::sort(_data.begin(), _data.end(), [this](const value_type& left, const value_type& right) {
+				return _comp(_key(left), _key(right));
+			});
+			for (size_type i = 1; i < N; i++) {
+				if (!_comp(_key(_data[i - 1]), _key(_data[i])))
+					throw std::invalid_argument("lux::frozen_vector keys are not unique");
+			}
+
+			if constexpr (_hashable) {
+				std::array<key_type, N> keys{};
+				for (size_type i = 0; i < N; i++)
+					keys[i] = _key(_data[i]);
+				_hash.build(keys);
+			}
+		}
+
+		constexpr const array_type& array() const noexcept {
+			return _data;
+		}
+
+		constexpr key_compare key_comp() const {
+			return _comp;
+		}
+
+		/**
+		 * @brief True if find runs on the perfect hash
+		*/
+		constexpr bool hashed() const noexcept {
+			if constexpr (_hashable)
+				return _hash.valid();
+			else
+				return false;
+		}
+
+		constexpr bool empty() const noexcept {
+			return N == 0;
+		}
+		constexpr size_type size() const noexcept {
+			return N;
+		}
+		constexpr size_type max_size() const noexcept {
+			return N;
+		}
+
+		constexpr const_iterator begin() const noexcept {
+			return _data.begin();
+		}
+		constexpr const_iterator cbegin() const noexcept {
+			return _data.cbegin();
+		}
+		constexpr const_iterator end() const noexcept {
+			return _data.end();
+		}
+		constexpr const_iterator cend() const noexcept {
+			return _data.cend();
+		}
+
+		constexpr const_reverse_iterator rbegin() const noexcept {
+			return _data.rbegin();
+		}
+		constexpr const_reverse_iterator crbegin() const noexcept {
+			return _data.crbegin();
+		}
+		constexpr const_reverse_iterator rend() const noexcept {
+			return _data.rend();
+		}
+		constexpr const_reverse_iterator crend() const noexcept {
+			return _data.crend();
+		}
+
+	private:
+		constexpr size_type _lower_bound(const key_type& key) const {
+			return _search.lower_bound(_data.data(), N, key, _comp, _key_projection{});
+		}
+		constexpr size_type _upper_bound(const key_type& key) const {
+			return _search.upper_bound(_data.data(), N, key, _comp, _key_projection{});
+		}
+
+		constexpr size_type _find(const key_type& key) const {
+			if constexpr (_hashable) {
+				if (_hash.valid()) {
+					const auto pos = _hash.lookup(key);
+					return pos < N && _key(_data[pos]) == key ? pos : N;
+				}
+			}
+
+			const auto pos = _lower_bound(key);
+			if (pos < N && !_comp(key, _key(_data[pos])))
+				return pos;
+			return N;
+		}
+
+	public:
+		constexpr const_iterator find(const key_type& key) const {
+			return begin() + _find(key);
+		}
+
+		constexpr bool contains(const key_type& key) const {
+			return _find(key) != N;
+		}
+		constexpr size_type count(const key_type& key) const {
+			return _find(key) != N ? 1 : 0;
+		}
+
+		constexpr _const_access_return_type at(const key_type& key) const {
+			const auto pos = _find(key);
+			if (pos != N)
+				return _value(_data[pos]);
+
+			if constexpr (is_mapped::value)
+				throw std::out_of_range("invalid lux::frozen_map<K, T> key");
+			else
+				throw std::out_of_range("invalid lux::frozen_set<K> key");
+		}
+
+		constexpr const_iterator lower_bound(const key_type& key) const {
+			return begin() + _lower_bound(key);
+		}
+		constexpr const_iterator upper_bound(const key_type& key) const {
+			return begin() + _upper_bound(key);
+		}
+		constexpr std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+			const auto pos = _find(key);
+			if (pos == N)
+				return { lower_bound(key), lower_bound(key) };
+			return { begin() + pos, begin() + (pos + 1) };
+		}
+
+	private:
+		array_type _data;
+		key_compare _comp;
+		search_type _search;
+		_hash_type _hash;
+	};
+
+	template< class Key, class Value, size_t N, class Compare = std::less<Key>, class Search = lux::branchless_search >
+	using frozen_map = frozen_vector<Key, Value, N, Compare, Search>;
+
+	template< class Key, size_t N, class Compare = std::less<Key>, class Search = lux::branchless_search >
+	using frozen_set = frozen_vector<Key, void, N, Compare, Search>;
+
+	/**
+	 * @brief Build a frozen_map from a list of key/value pairs, usable in a constant expression
+	*/
+	template< class Key, class Value, class Compare = std::less<Key>, size_t N >
+	constexpr frozen_map<Key, Value, N, Compare> make_frozen_map(const std::pair<Key, Value>(&items)[N], const Compare& comp = Compare()) {
+		std::array<std::pair<Key, Value>, N> data{};
+		for (size_t i = 0; i < N; i++)
+			data[i] = items[i];
+		return frozen_map<Key, Value, N, Compare>(data, comp);
+	}
+
+	/**
+	 * @brief Build a frozen_set from a list of keys, usable in a constant expression
+	*/
+	template< class Key, class Compare = std::less<Key>, size_t N >
+	constexpr frozen_set<Key, N, Compare> make_frozen_set(const Key(&items)[N], const Compare& comp = Compare()) {
+		std::array<Key, N> data{};
+		for (size_t i = 0; i < N; i++)
+			data[i] = items[i];
+		return frozen_set<Key, N, Compare>(data, comp);
+	}
+
+}
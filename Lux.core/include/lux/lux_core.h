@@ -17,9 +17,23 @@
 
 #include <lux/types.h>
 #include <lux/math.h>
+#include <lux/simd.h>
+#include <lux/stats.h>
 #include <lux/functions.h>
 #include <lux/memory.h>
 #include <lux/iterating.h>
+#include <lux/searching.h>
 
 #include <lux/dynamic_array.h>
 #include <lux/sorted_vector.h>
+#include <lux/sorted_algorithm.h>
+#include <lux/sorted_multivector.h>
+#include <lux/buffered_sorted_vector.h>
+#include <lux/split_sorted_vector.h>
+#include <lux/paged_sorted_vector.h>
+#include <lux/eytzinger_vector.h>
+#include <lux/frozen_vector.h>
+#include <lux/packed_sorted_set.h>
+
+#include <lux/rcu.h>
+#include <lux/sharded_sorted_vector.h>
@@ -0,0 +1,601 @@
+#pragma once
+
+#include <lux/base_core.h>
+
+#include <lux/searching.h>
+#include <lux/sorted_vector.h>
+#include <lux/split_sorted_vector.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <vector>
+
+// not part of lux_core.h, the umbrella header stays free of the platform headers
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#define _LUX_LEAN_AND_MEAN
+#endif // WIN32_LEAN_AND_MEAN
+#ifdef NOMINMAX
+#include <windows.h>
+#else
+#define NOMINMAX
+#include <windows.h>
+#undef NOMINMAX
+#endif // NOMINMAX
+#ifdef _LUX_LEAN_AND_MEAN
+#undef WIN32_LEAN_AND_MEAN
+#undef _LUX_LEAN_AND_MEAN
+#endif // _LUX_LEAN_AND_MEAN
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+namespace lux
+{
+
+	/**
+	 * @brief How much of an image is verified when it is opened
+	*/
+	enum class image_check
+	{
+		header,		// the layout only, O(1): the pages are read on demand
+		checksum	// the layout and the checksum of the whole payload, O(n)
+	};
+
+	namespace _impls
+	{
+
+		/*
+		*	Image layout: the header, then the key array and the value array, each aligned on 64 bytes.
+		*	The arrays are raw copies of trivially copyable types, in the byte order of the machine.
+		*/
+
+		struct _image_header
+		{
+			static constexpr char magic_value[8] = { 'L', 'U', 'X', 'S', 'V', 'I', 'M', 'G' };
+			static constexpr uint32_t current_version = 1;
+			static constexpr uint32_t endian_tag = 0x01020304;
+
+			char magic[8];
+			uint32_t version;
+			uint32_t endian;
+			uint32_t key_size;
+			uint32_t key_align;
+			uint32_t value_size;
+			uint32_t value_align;
+			uint64_t count;
+			uint64_t keys_offset;
+			uint64_t values_offset;
+			uint64_t file_size;
+			uint64_t checksum;
+		};
+
+		_INLINE_VAR constexpr uint64_t _image_alignment = 64;
+
+		constexpr uint64_t _image_align(uint64_t offset) noexcept {
+			return (offset + _image_alignment - 1) / _image_alignment * _image_alignment;
+		}
+
+		// FNV-1a over 8 byte words, the tail byte by byte
+		class _image_checksum
+		{
+		public:
+			void update(const void* data, size_t size) noexcept {
+				auto bytes = static_cast<const unsigned char*>(data);
+				for (; _pending > 0 && size > 0; size--)
+					_push(*bytes++);
+				for (; size >= 8; size -= 8, bytes += 8) {
+					uint64_t word;
+					std::memcpy(&word, bytes, 8);
+					_mix(word);
+				}
+				for (; size > 0; size--)
+					_push(*bytes++);
+			}
+
+			uint64_t value() const noexcept {
+				auto res = _hash;
+				for (size_t i = 0; i < _pending; i++)
+					res = (res ^ _buffer[i]) * _prime;
+				return res;
+			}
+
+		private:
+			static constexpr uint64_t _prime = 0x100000001b3ull;
+
+			void _mix(uint64_t word) noexcept {
+				_hash = (_hash ^ word) * _prime;
+			}
+			void _push(unsigned char byte) noexcept {
+				_buffer[_pending++] = byte;
+				if (_pending == 8) {
+					uint64_t word;
+					std::memcpy(&word, _buffer, 8);
+					_mix(word);
+					_pending = 0;
+				}
+			}
+
+			uint64_t _hash = 0xcbf29ce484222325ull;
+			unsigned char _buffer[8] = {};
+			size_t _pending = 0;
+		};
+
+		template< class Key, class Value >
+		_image_header _make_image_header(uint64_t count) noexcept {
+			_image_header res{};
+			std::memcpy(res.magic, _image_header::magic_value, sizeof(res.magic));
+			res.version = _image_header::current_version;
+			res.endian = _image_header::endian_tag;
+			res.key_size = sizeof(Key);
+			res.key_align = alignof(Key);
+			res.count = count;
+			res.keys_offset = _image_align(sizeof(_image_header));
+			res.values_offset = _image_align(res.keys_offset + count * sizeof(Key));
+			if constexpr (std::is_void_v<Value>)
+				res.file_size = res.keys_offset + count * sizeof(Key);
+			else {
+				res.value_size = sizeof(Value);
+				res.value_align = alignof(Value);
+				res.file_size = res.values_offset + count * sizeof(Value);
+			}
+			return res;
+		}
+
+		// writes the image, key_at(i) and value_at(i) give the entries in key order
+		template< class Key, class Value, class KeyAt, class ValueAt >
+		void _save_image(const std::filesystem::path& path, size_t count, KeyAt key_at, ValueAt value_at) {
+			static_assert(std::is_trivially_copyable_v<Key>, "lux image keys must be trivially copyable");
+			static_assert(std::is_void_v<Value> || std::is_trivially_copyable_v<Value>, "lux image values must be trivially copyable");
+
+			auto header = _make_image_header<Key, Value>(count);
+			std::ofstream out(path, std::ios::binary | std::ios::trunc);
+			if (!out)
+				throw std::runtime_error("lux image cannot be created");
+
+			_image_checksum checksum;
+			uint64_t offset = 0;
+			auto write = [&](const void* data, size_t size, bool payload) {
+				out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+				if (payload)
+					checksum.update(data, size);
+				offset += size;
+			};
+			auto pad = [&](uint64_t to, bool payload) {
+				static constexpr char zeros[_image_alignment] = {};
+				while (offset < to)
+					write(zeros, static_cast<size_t>(std::min<uint64_t>(to - offset, _image_alignment)), payload);
+			};
+
+			// the chunks bound the memory used to gather the keys out of the entries
+			auto write_array = [&]<class Ty, class At>(At at) {
+				constexpr size_t chunk = 4096;
+				std::vector<Ty> buffer;
+				buffer.reserve(std::min(chunk, count));
+				for (size_t first = 0; first < count; first += chunk) {
+					buffer.clear();
+					for (size_t i = first; i < std::min(first + chunk, count); i++)
+						buffer.push_back(at(i));
+					write(buffer.data(), buffer.size() * sizeof(Ty), true);
+				}
+			};
+
+			write(&header, sizeof(header), false);
+			pad(header.keys_offset, false);
+			write_array.template operator()<Key>(key_at);
+			if constexpr (!std::is_void_v<Value>) {
+				pad(header.values_offset, true);
+				write_array.template operator()<Value>(value_at);
+			}
+
+			header.checksum = checksum.value();
+			out.seekp(0);
+			out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			if (!out.flush())
+				throw std::runtime_error("lux image cannot be written");
+		}
+
+		/**
+		 * @brief Read-only mapping of a whole file
+		*/
+		class _file_mapping
+		{
+		public:
+			explicit _file_mapping(const std::filesystem::path& path) {
+#ifdef _WIN32
+				_file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+				if (_file == INVALID_HANDLE_VALUE)
+					throw std::runtime_error("lux image cannot be opened");
+
+				LARGE_INTEGER size;
+				if (!::GetFileSizeEx(_file, &size) || size.QuadPart == 0) {
+					_close();
+					throw std::runtime_error("lux image cannot be mapped");
+				}
+				_size = static_cast<size_t>(size.QuadPart);
+
+				_mapping = ::CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (_mapping != nullptr)
+					_data = static_cast<const std::byte*>(::MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+				const int fd = ::open(path.c_str(), O_RDONLY);
+				if (fd < 0)
+					throw std::runtime_error("lux image cannot be opened");
+
+				struct stat st;
+				if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+					_size = static_cast<size_t>(st.st_size);
+					void* addr = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+					if (addr != MAP_FAILED)
+						_data = static_cast<const std::byte*>(addr);
+				}
+				// the mapping keeps its own reference to the file
+				::close(fd);
+#endif // _WIN32
+				if (_data == nullptr) {
+					_close();
+					throw std::runtime_error("lux image cannot be mapped");
+				}
+			}
+
+			~_file_mapping() {
+				_close();
+			}
+
+			_file_mapping(const _file_mapping&) = delete;
+			_file_mapping& operator=(const _file_mapping&) = delete;
+
+			_file_mapping(_file_mapping&& other) noexcept {
+				_steal(other);
+			}
+			_file_mapping& operator=(_file_mapping&& other) noexcept {
+				if (this != &other) {
+					_close();
+					_steal(other);
+				}
+				return *this;
+			}
+
+			const std::byte* data() const noexcept {
+				return _data;
+			}
+			size_t size() const noexcept {
+				return _size;
+			}
+
+		private:
+			void _close() noexcept {
+#ifdef _WIN32
+				if (_data != nullptr)
+					::UnmapViewOfFile(_data);
+				if (_mapping != nullptr)
+					::CloseHandle(_mapping);
+				if (_file != INVALID_HANDLE_VALUE)
+					::CloseHandle(_file);
+				_mapping = nullptr, _file = INVALID_HANDLE_VALUE;
+#else
+				if (_data != nullptr)
+					::munmap(const_cast<std::byte*>(_data), _size);
+#endif // _WIN32
+				_data = nullptr, _size = 0;
+			}
+
+			void _steal(_file_mapping& other) noexcept {
+#ifdef _WIN32
+				_file = std::exchange(other._file, INVALID_HANDLE_VALUE);
+				_mapping = std::exchange(other._mapping, nullptr);
+#endif // _WIN32
+				_data = std::exchange(other._data, nullptr);
+				_size = std::exchange(other._size, 0);
+			}
+
+#ifdef _WIN32
+			HANDLE _file = INVALID_HANDLE_VALUE;
+			HANDLE _mapping = nullptr;
+#endif // _WIN32
+			const std::byte* _data = nullptr;
+			size_t _size = 0;
+		};
+
+		template< class Key, class Value, class Compare >
+		struct _mapped_iterator
+		{
+			using type = split_sorted_vector<Key, Value, Compare>::const_iterator;
+		};
+		template< class Key, class Compare >
+		struct _mapped_iterator<Key, void, Compare>
+		{
+			using type = const Key*;
+		};
+
+	}
+
+	/**
+	 * @brief Save the entries of a sorted_vector as an image for mapped_sorted_vector
+	 *
+	 * The key and mapped types must be trivially copyable.
+	 * @throw std::runtime_error if the file cannot be written
+	*/
+	template< class Key, class Value, class Compare, class Alloc, class Search, class Stats >
+	void save_image(const sorted_vector<Key, Value, Compare, Alloc, Search, Stats>& sv, const std::filesystem::path& path) {
+		const auto& data = sv.vector();
+		if constexpr (sorted_vector<Key, Value, Compare, Alloc, Search, Stats>::is_mapped::value)
+			_impls::_save_image<Key, Value>(path, data.size(),
+				[&](size_t i) { return data[i].key(); }, [&](size_t i) { return data[i].value(); });
+		else
+			_impls::_save_image<Key, void>(path, data.size(),
+				[&](size_t i) { return data[i].key(); }, nullptr);
+	}
+
+	/**
+	 * @brief Save the entries of a split_sorted_vector as an image for mapped_sorted_vector
+	 * @throw std::runtime_error if the file cannot be written
+	*/
+	template< class Key, class Value, class Compare, class Alloc, class Search >
+	void save_image(const split_sorted_vector<Key, Value, Compare, Alloc, Search>& sv, const std::filesystem::path& path) {
+		const auto& keys = sv.keys();
+		const auto& values = sv.values();
+		_impls::_save_image<Key, Value>(path, keys.size(),
+			[&](size_t i) { return keys[i]; }, [&](size_t i) { return values[i]; });
+	}
+
+	/**
+	 * @brief Read-only sorted_vector mapped from an image written by save_image
+	 *
+	 * Opening maps the file and checks its header, nothing is deserialized: the pages are read on the first access.
+	 * The keys and the values are two parallel arrays, as in split_sorted_vector, and the lookup API is the one of sorted_vector.
+	*/
+	template<
+		class Key, class Value = void,
+		class Compare = std::less<Key>,
+		class Search = lux::default_search
+	>
+	class mapped_sorted_vector
+	{
+	public:
+		using key_type					= Key;
+		using mapped_type				= Value;
+		using is_mapped					= std::negation<std::is_same<Value, void>>;
+		using key_compare				= Compare;
+		using search_type				= Search;
+		using size_type					= size_t;
+		using difference_type			= ptrdiff_t;
+		using iterator					= _impls::_mapped_iterator<Key, Value, Compare>::type;
+		using const_iterator			= iterator;
+		using reverse_iterator			= std::reverse_iterator<iterator>;
+		using const_reverse_iterator	= reverse_iterator;
+
+		static_assert(std::is_trivially_copyable_v<key_type>, "lux::mapped_sorted_vector keys must be trivially copyable");
+
+	private:
+		using _const_access_return_type = std::conditional_t<is_mapped::value, std::add_lvalue_reference_t<const mapped_type>, const key_type&>;
+
+		static constexpr bool _is_transparent = requires { typename key_compare::is_transparent; };
+
+	public:
+		/**
+		 * @brief Map an image
+		 * @throw std::runtime_error if the file cannot be mapped, is not an image of this layout or fails the check
+		*/
+		explicit mapped_sorted_vector(const std::filesystem::path& path, image_check check = image_check::header, const key_compare& comp = key_compare())
+			: _mapping(path), _header(), _keys(nullptr), _values(nullptr), _size(0), _comp(comp), _search() {
+			if (_mapping.size() < sizeof(_impls::_image_header))
+				throw std::runtime_error("lux::mapped_sorted_vector image is truncated");
+
+			std::memcpy(&_header, _mapping.data(), sizeof(_header));
+
+			// a count the file cannot hold would overflow the offsets derived from it
+			const uint64_t keys_offset = _impls::_image_align(sizeof(_impls::_image_header));
+			uint64_t entry_size = sizeof(key_type);
+			if constexpr (is_mapped::value)
+				entry_size += sizeof(mapped_type);
+			if (_mapping.size() < keys_offset || _header.count > (_mapping.size() - keys_offset) / entry_size)
+				throw std::runtime_error("lux::mapped_sorted_vector image is truncated");
+
+			const auto expected = _impls::_make_image_header<key_type, mapped_type>(_header.count);
+			if (std::memcmp(_header.magic, expected.magic, sizeof(_header.magic)) != 0
+				|| _header.version != expected.version || _header.endian != expected.endian)
+				throw std::runtime_error("lux::mapped_sorted_vector file is not a supported image");
+			if (_header.key_size != expected.key_size || _header.key_align != expected.key_align
+				|| _header.value_size != expected.value_size || _header.value_align != expected.value_align
+				|| _header.keys_offset != expected.keys_offset || _header.values_offset != expected.values_offset
+				|| _header.file_size != expected.file_size)
+				throw std::runtime_error("lux::mapped_sorted_vector image layout mismatch");
+			if (_mapping.size() < _header.file_size)
+				throw std::runtime_error("lux::mapped_sorted_vector image is truncated");
+
+			_size = static_cast<size_type>(_header.count);
+			_keys = reinterpret_cast<const key_type*>(_mapping.data() + _header.keys_offset);
+			if constexpr (is_mapped::value)
+				_values = reinterpret_cast<const mapped_type*>(_mapping.data() + _header.values_offset);
+
+			if (check == image_check::checksum && !verify())
+				throw std::runtime_error("lux::mapped_sorted_vector image checksum mismatch");
+
+#ifdef _DEBUG
+			for (size_type i = 1; i < _size; i++) {
+				if (!_comp(_keys[i - 1], _keys[i]))
+					throw std::runtime_error("lux::mapped_sorted_vector image is not sorted and unique");
+			}
+#endif // _DEBUG
+		}
+
+		mapped_sorted_vector(const mapped_sorted_vector&) = delete;
+		mapped_sorted_vector& operator=(const mapped_sorted_vector&) = delete;
+
+		mapped_sorted_vector(mapped_sorted_vector&& other) noexcept = default;
+		mapped_sorted_vector& operator=(mapped_sorted_vector&& other) noexcept = default;
+
+		/**
+		 * @brief Recompute the checksum of the payload, this reads the whole file
+		*/
+		bool verify() const noexcept {
+			_impls::_image_checksum checksum;
+			checksum.update(_mapping.data() + _header.keys_offset, static_cast<size_t>(_header.file_size - _header.keys_offset));
+			return checksum.value() == _header.checksum;
+		}
+
+		std::span<const key_type> keys() const noexcept {
+			return { _keys, _size };
+		}
+		std::span<const mapped_type> values() const noexcept requires is_mapped::value {
+			return { _values, _size };
+		}
+
+		key_compare key_comp() const {
+			return _comp;
+		}
+
+		const search_type& search_policy() const noexcept {
+			return _search;
+		}
+
+		bool empty() const noexcept {
+			return _size == 0;
+		}
+		size_type size() const noexcept {
+			return _size;
+		}
+
+		const_iterator begin() const noexcept {
+			return _iterator_at(0);
+		}
+		const_iterator cbegin() const noexcept {
+			return begin();
+		}
+		const_iterator end() const noexcept {
+			return _iterator_at(_size);
+		}
+		const_iterator cend() const noexcept {
+			return end();
+		}
+
+		const_reverse_iterator rbegin() const noexcept {
+			return const_reverse_iterator(end());
+		}
+		const_reverse_iterator crbegin() const noexcept {
+			return rbegin();
+		}
+		const_reverse_iterator rend() const noexcept {
+			return const_reverse_iterator(begin());
+		}
+		const_reverse_iterator crend() const noexcept {
+			return rend();
+		}
+
+	private:
+		const_iterator _iterator_at(size_type pos) const noexcept {
+			if constexpr (is_mapped::value)
+				return const_iterator(_keys + pos, _values + pos);
+			else
+				return _keys + pos;
+		}
+
+		template< class K >
+		size_type _lower_bound(const K& key) const {
+			return _search.lower_bound(_keys, _size, key, _comp);
+		}
+		template< class K >
+		size_type _upper_bound(const K& key) const {
+			return _search.upper_bound(_keys, _size, key, _comp);
+		}
+
+		template< class K >
+		size_type _find(const K& key) const {
+			const auto pos = _lower_bound(key);
+			if (pos < _size && !_comp(key, _keys[pos]))
+				return pos;
+			return _size;
+		}
+
+		template< class K >
+		_const_access_return_type _at(const K& key) const {
+			const auto pos = _find(key);
+			if (pos == _size)
+				throw std::out_of_range(is_mapped::value ? "invalid lux::mapped_sorted_vector<K, T> key" : "invalid lux::mapped_sorted_vector<K> key");
+
+			if constexpr (is_mapped::value)
+				return _values[pos];
+			else
+				return _keys[pos];
+		}
+
+	public:
+		const_iterator find(const key_type& key) const {
+			return _iterator_at(_find(key));
+		}
+		template< class K > requires _is_transparent
+		const_iterator find(const K& key) const {
+			return _iterator_at(_find(key));
+		}
+
+		bool contains(const key_type& key) const {
+			return _find(key) != _size;
+		}
+		template< class K > requires _is_transparent
+		bool contains(const K& key) const {
+			return _find(key) != _size;
+		}
+
+		size_type count(const key_type& key) const {
+			return contains(key) ? 1 : 0;
+		}
+		template< class K > requires _is_transparent
+		size_type count(const K& key) const {
+			return contains(key) ? 1 : 0;
+		}
+
+		_const_access_return_type at(const key_type& key) const {
+			return _at(key);
+		}
+		template< class K > requires _is_transparent
+		_const_access_return_type at(const K& key) const {
+			return _at(key);
+		}
+
+		const_iterator lower_bound(const key_type& key) const {
+			return _iterator_at(_lower_bound(key));
+		}
+		template< class K > requires _is_transparent
+		const_iterator lower_bound(const K& key) const {
+			return _iterator_at(_lower_bound(key));
+		}
+
+		const_iterator upper_bound(const key_type& key) const {
+			return _iterator_at(_upper_bound(key));
+		}
+		template< class K > requires _is_transparent
+		const_iterator upper_bound(const K& key) const {
+			return _iterator_at(_upper_bound(key));
+		}
+
+		std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+			const auto pos = _lower_bound(key);
+			const auto last = pos < _size && !_comp(key, _keys[pos]) ? pos + 1 : pos;
+			return { _iterator_at(pos), _iterator_at(last) };
+		}
+		template< class K > requires _is_transparent
+		std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+			return { lower_bound(key), upper_bound(key) };
+		}
+
+	private:
+		_impls::_file_mapping _mapping;
+		_impls::_image_header _header;
+		const key_type* _keys;
+		const mapped_type* _values;
+		size_type _size;
+		key_compare _comp;
+		search_type _search;
+	};
+
+}
@@ -2,6 +2,8 @@
 
 #include <lux/base_core.h>
 
+#include <cstdint>
+
 namespace lux
 {
 
@@ -26,39 +28,51 @@ namespace lux
 		return std::sqrt((x * x) + (y * y));
 	}
 
-	template< class Ty, class Uy >
+	/**
+	 * @brief Spread the bits of x over the whole word, the splitmix64 finalizer
+	*/
+	constexpr uint64_t mix64(uint64_t x) noexcept {
+		x ^= x >> 30, x *= 0xbf58476d1ce4e5b9ull;
+		x ^= x >> 27, x *= 0x94d049bb133111ebull;
+		return x ^ (x >> 31);
+	}
+
+	/**
+	 * @brief Transparent less, evaluates left < right with either operator< or operator>
+	 *
+	 * The comparison is not bound to Ty and Uy, any pair of comparable types is accepted.
+	*/
+	template< class Ty = void, class Uy = Ty >
 	struct less
 	{
 	private:
 		template< class T, class U, class = decltype(std::declval<T>() < std::declval<U>()) >
-			static std::true_type _test_less(int);
-			template< class T, class U >
-			static std::false_type _test_less(...);
+		static std::true_type _test_less(int);
+		template< class T, class U >
+		static std::false_type _test_less(...);
 
-			template< class T, class U, class = decltype(std::declval<T>() > std::declval<U>()) >
+		template< class T, class U, class = decltype(std::declval<T>() > std::declval<U>()) >
 		static std::true_type _test_greater(int);
 		template< class T, class U >
 		static std::false_type _test_greater(...);
 
+		template< class T >
+		static constexpr bool _no_operator = false;
+
 	public:
+		using is_transparent = void;
+
 		constexpr ~less() = default;
 		constexpr less() = default;
 
-		constexpr bool operator()(const Ty& left, const Uy& right) {
-			if constexpr (decltype(_test_less<Ty, Uy>(0))::value)
-				return left < right;
-			else if constexpr (decltype(_test_greater<Uy, Ty>(0))::value)
-				return right > left;
-			else
-				static_assert(false, "No valid operator for Ty < Uy");
-		}
-		constexpr bool operator()(const Uy& left, const Ty& right) {
-			if constexpr (decltype(_test_less<Uy, Ty>(0))::value)
+		template< class T, class U >
+		constexpr bool operator()(const T& left, const U& right) const {
+			if constexpr (decltype(_test_less<const T&, const U&>(0))::value)
 				return left < right;
-			else if constexpr (decltype(_test_greater<Ty, Uy>(0))::value)
+			else if constexpr (decltype(_test_greater<const U&, const T&>(0))::value)
 				return right > left;
 			else
-				static_assert(false, "No valid operator for Uy < Ty");
+				static_assert(_no_operator<T>, "No valid operator for left < right");
 		}
 	};
 
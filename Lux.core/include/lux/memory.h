@@ -6,6 +6,10 @@
 
 #include <memory>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
 namespace lux
 {
 
@@ -23,4 +27,18 @@ namespace lux
 		}
 	};
 
+	/**
+	 * @brief Hint the cpu to load the cache line containing addr
+	 * @param addr Address to prefetch, it is never dereferenced
+	*/
+	constexpr void prefetch(const void* addr) noexcept {
+		if (std::is_constant_evaluated())
+			return;
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		_mm_prefetch(static_cast<const char*>(addr), _MM_HINT_T0);
+#elif defined(__GNUC__)
+		__builtin_prefetch(addr);
+#endif
+	}
+
 }
@@ -0,0 +1,646 @@
+#pragma once
+
+#include <lux/base_core.h>
+
+#include <lux/simd.h>
+#include <lux/searching.h>
+#include <lux/sorted_vector.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+namespace lux
+{
+
+	/**
+	 * @brief Immutable sorted set of unsigned integers, compressed by blocks
+	 *
+	 * The keys are cut in blocks of BlockSize: the first key of each block is kept as an uncompressed fence,
+	 * the gaps between the following keys are bit-packed with the width of the largest gap of the block.
+	 * Dense ids take a few bits per key. A lookup searches the fences, then decodes a single block.
+	*/
+	template<
+		class Key,
+		size_t BlockSize = 128,
+		class Search = lux::default_search
+	>
+	class packed_sorted_set
+	{
+		static_assert(std::is_unsigned_v<Key> && !std::is_same_v<Key, bool>, "lux::packed_sorted_set keys must be unsigned integers");
+		static_assert(BlockSize >= 2, "lux::packed_sorted_set blocks need at least two keys");
+
+	public:
+		using key_type					= Key;
+		using value_type				= Key;
+		using key_compare				= std::less<Key>;
+		using search_type				= Search;
+		using size_type					= size_t;
+		using difference_type			= ptrdiff_t;
+
+		static constexpr size_type block_size = BlockSize;
+
+		/**
+		 * @brief Forward iterator, the keys are decoded on the fly and returned by value
+		*/
+		class const_iterator
+		{
+			friend class packed_sorted_set;
+
+		public:
+			using iterator_concept	= std::forward_iterator_tag;
+			using iterator_category	= std::input_iterator_tag;
+			using value_type		= Key;
+			using difference_type	= ptrdiff_t;
+			using reference			= Key;
+			using pointer			= void;
+
+			const_iterator() noexcept
+				: _set(nullptr), _index(0), _value(0) {
+			}
+
+			reference operator*() const noexcept {
+				return _value;
+			}
+
+			const_iterator& operator++() noexcept {
+				_index++;
+				if (_index < _set->_size) {
+					const auto pos = _index % block_size;
+					_value = pos == 0 ? _set->_fences[_index / block_size] : _value + 1 + _set->_gap(_index / block_size, pos - 1);
+				}
+				return *this;
+			}
+			const_iterator operator++(int) noexcept {
+				auto tmp = *this;
+				++(*this);
+				return tmp;
+			}
+
+			/**
+			 * @brief Position of the key in the set, its rank
+			*/
+			size_type index() const noexcept {
+				return _index;
+			}
+
+			bool operator==(const const_iterator& other) const noexcept {
+				return _index == other._index;
+			}
+
+		private:
+			const_iterator(const packed_sorted_set* set, size_type index, key_type value) noexcept
+				: _set(set), _index(index), _value(value) {
+			}
+
+			const packed_sorted_set* _set;
+			size_type _index;
+			key_type _value;
+		};
+
+		using iterator = const_iterator;
+
+		packed_sorted_set()
+			: _fences(), _offsets{ 0 }, _widths(), _words(), _size(0), _search() {
+		}
+
+		/**
+		 * @brief Compress a range of sorted and unique keys in O(n)
+		 *
+		 * The order is verified in debug builds only.
+		*/
+		template< class It >
+		packed_sorted_set(sorted_unique_t, It first, It last)
+			: packed_sorted_set() {
+			_compress(first, last, std::identity());
+		}
+
+		/**
+		 * @brief Compress the keys proj gives for a range of sorted and unique entries in O(n)
+		*/
+		template< class It, class Proj >
+		packed_sorted_set(sorted_unique_t, It first, It last, Proj proj)
+			: packed_sorted_set() {
+			_compress(first, last, proj);
+		}
+
+		template< class Alloc, class SvSearch, class SvStats >
+		explicit packed_sorted_set(const sorted_vector<Key, void, std::less<Key>, Alloc, SvSearch, SvStats>& sv)
+			: packed_sorted_set() {
+			_compress(sv.begin(), sv.end(), [](const auto& entry) -> const key_type& { return entry.key(); });
+		}
+
+		/**
+		 * @brief Compress a range of keys in any order, the duplicates are dropped
+		*/
+		template< class It >
+		packed_sorted_set(It first, It last)
+			: packed_sorted_set(sorted_vector<Key>(first, last)) {
+		}
+		packed_sorted_set(std::initializer_list<key_type> ilist)
+			: packed_sorted_set(ilist.begin(), ilist.end()) {
+		}
+
+		packed_sorted_set(const packed_sorted_set&) = default;
+		packed_sorted_set(packed_sorted_set&&) noexcept = default;
+
+		packed_sorted_set& operator=(const packed_sorted_set&) = default;
+		packed_sorted_set& operator=(packed_sorted_set&&) noexcept = default;
+
+		bool empty() const noexcept {
+			return _size == 0;
+		}
+		size_type size() const noexcept {
+			return _size;
+		}
+		size_type block_count() const noexcept {
+			return _fences.size();
+		}
+
+		/**
+		 * @brief Bytes used by the packed keys and the block index
+		*/
+		size_type memory_usage() const noexcept {
+			return _fences.capacity() * sizeof(key_type) + _offsets.capacity() * sizeof(size_type)
+				+ _widths.capacity() * sizeof(uint8_t) + _words.capacity() * sizeof(uint64_t);
+		}
+
+		const_iterator begin() const noexcept {
+			return empty() ? end() : const_iterator(this, 0, _fences[0]);
+		}
+		const_iterator cbegin() const noexcept {
+			return begin();
+		}
+		const_iterator end() const noexcept {
+			return const_iterator(this, _size, 0);
+		}
+		const_iterator cend() const noexcept {
+			return end();
+		}
+
+	private:
+		// zero words past the last block, so a vector load at the end of a block stays inside _words
+		static constexpr size_type _padding = 4;
+
+		template< class It, class Proj >
+		void _compress(It first, It last, Proj proj) {
+			std::vector<key_type> block;
+			block.reserve(block_size);
+#ifdef _DEBUG
+			bool first_key = true;
+			key_type prev = 0;
+#endif // _DEBUG
+			for (; first != last; ++first) {
+				const auto key = static_cast<key_type>(proj(*first));
+#ifdef _DEBUG
+				if (!first_key && !(prev < key))
+					throw std::invalid_argument("lux::packed_sorted_set keys are not sorted and unique");
+				prev = key, first_key = false;
+#endif // _DEBUG
+				block.push_back(key);
+				if (block.size() == block_size)
+					_append_block(block), block.clear();
+			}
+			if (!block.empty())
+				_append_block(block);
+
+			_words.resize(_words.size() + _padding);
+			_fences.shrink_to_fit(), _offsets.shrink_to_fit(), _widths.shrink_to_fit(), _words.shrink_to_fit();
+		}
+
+		static uint64_t _read_bits(const uint64_t* words, size_type bit, unsigned width) noexcept {
+			if (width == 0)
+				return 0;
+			const auto shift = bit % 64;
+			auto res = words[bit / 64] >> shift;
+			if (shift + width > 64)
+				res |= words[bit / 64 + 1] << (64 - shift);
+			return width == 64 ? res : res & ((uint64_t(1) << width) - 1);
+		}
+
+		static void _write_bits(uint64_t* words, size_type bit, unsigned width, uint64_t value) noexcept {
+			if (width == 0)
+				return;
+			const auto shift = bit % 64;
+			words[bit / 64] |= value << shift;
+			if (shift + width > 64)
+				words[bit / 64 + 1] |= value >> (64 - shift);
+		}
+
+		void _append_block(const std::vector<key_type>& block) {
+			// the keys are unique, so a gap is at least 1 and gap - 1 is stored
+			uint64_t widest = 0;
+			for (size_type i = 1; i < block.size(); i++)
+				widest |= static_cast<uint64_t>(block[i] - block[i - 1] - 1);
+			const auto width = static_cast<unsigned>(std::bit_width(widest));
+
+			const auto first_word = _words.size();
+			_words.resize(first_word + ((block.size() - 1) * width + 63) / 64);
+			for (size_type i = 1; i < block.size(); i++)
+				_write_bits(_words.data() + first_word, (i - 1) * width, width, static_cast<uint64_t>(block[i] - block[i - 1] - 1));
+
+			_fences.push_back(block.front());
+			_widths.push_back(static_cast<uint8_t>(width));
+			_offsets.push_back(_words.size());
+			_size += block.size();
+		}
+
+		// gap - 1 between the keys pos and pos + 1 of the block
+		uint64_t _gap(size_type block, size_type pos) const noexcept {
+			return _read_bits(_words.data() + _offsets[block], pos * _widths[block], _widths[block]);
+		}
+
+		size_type _block_length(size_type block) const noexcept {
+			return block + 1 < block_count() ? block_size : _size - block * block_size;
+		}
+
+		static constexpr bool _past(bool upper, key_type key, key_type value) noexcept {
+			return upper ? key < value : !(value < key);
+		}
+
+		// position in the block of the first key past key and that key, { length, _ } if there is none
+		template< bool Upper >
+		std::pair<size_type, key_type> _scan(size_type block, size_type length, key_type key) const noexcept {
+			key_type value = _fences[block];
+			for (size_type pos = 0; pos < length; pos++) {
+				if (pos > 0)
+					value += static_cast<key_type>(1 + _gap(block, pos - 1));
+				if (_past(Upper, key, value))
+					return { pos, value };
+			}
+			return { length, value };
+		}
+
+		// _scan for a width that divides 64: no gap straddles two words, so a word is loaded once and shifted
+		template< bool Upper, unsigned Width >
+		std::pair<size_type, key_type> _scan_words(size_type block, size_type length, key_type key) const noexcept {
+			constexpr size_type per_word = 64 / Width;
+			constexpr uint64_t mask = (uint64_t(1) << Width) - 1;
+
+			key_type value = _fences[block];
+			if (_past(Upper, key, value))
+				return { 0, value };
+
+			const auto* words = _words.data() + _offsets[block];
+			for (size_type pos = 1; pos < length; words++) {
+				auto word = *words;
+				for (const auto end = std::min(length, pos + per_word); pos < end; pos++, word >>= Width) {
+					value += static_cast<key_type>(1 + (word & mask));
+					if (_past(Upper, key, value))
+						return { pos, value };
+				}
+			}
+			return { length, value };
+		}
+
+#ifdef LUX_SIMD_X86
+		// true if the offsets of a block of this width from its fence fit in a signed 32 bit lane,
+		// the 8 gaps read past the end of the block included
+		static constexpr bool _fits_avx2(unsigned width) noexcept {
+			return width <= 16 && (uint64_t(block_size + 8) << width) <= uint64_t(INT32_MAX);
+		}
+
+		// _scan for the widths that divide 32: 8 gaps are unpacked at once by variable shifts, turned into
+		// offsets from the fence by a prefix sum, and compared with the key in a single step
+		template< bool Upper >
+		LUX_TARGET("avx2") std::pair<size_type, key_type> _scan_avx2(size_type block, size_type length, key_type key) const noexcept {
+			const auto fence = _fences[block];
+			if (_past(Upper, key, fence))
+				return { 0, fence };
+
+			const auto width = static_cast<int>(_widths[block]);
+			const auto dist = static_cast<uint64_t>(key - fence);
+			const auto target = _mm256_set1_epi32(dist > uint64_t(INT32_MAX) ? INT32_MAX : static_cast<int>(dist));
+
+			// the gap i of 8 is in the 32 bit word i * width / 32 of the load, at bit i * width % 32
+			const auto lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+			const auto bit = _mm256_mullo_epi32(lane, _mm256_set1_epi32(width));
+			const auto word = _mm256_srli_epi32(bit, 5), shift = _mm256_and_si256(bit, _mm256_set1_epi32(31));
+			const auto mask = _mm256_set1_epi32(static_cast<int>((uint64_t(1) << width) - 1));
+			const auto one = _mm256_set1_epi32(1), last = _mm256_set1_epi32(7);
+
+			const auto* bytes = reinterpret_cast<const char*>(_words.data() + _offsets[block]);
+			auto base = _mm256_setzero_si256();
+			alignas(32) int32_t offsets[8];
+			for (size_type gap = 0; gap + 1 < length; gap += 8) {
+				auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + gap * width / 8));
+				x = _mm256_and_si256(_mm256_srlv_epi32(_mm256_permutevar8x32_epi32(x, word), shift), mask);
+
+				// the keys are the fence plus the prefix sums of gap + 1
+				x = _mm256_add_epi32(x, one);
+				x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+				x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+				const auto low = _mm256_shuffle_epi32(x, 0xff);
+				x = _mm256_add_epi32(x, _mm256_permute2x128_si256(low, low, 0x08));
+				x = _mm256_add_epi32(x, base);
+				base = _mm256_permutevar8x32_epi32(x, last);
+
+				// the offsets increase, so the lanes on the left side of the key are a prefix
+				const auto left = Upper ? _mm256_andnot_si256(_mm256_cmpgt_epi32(x, target), _mm256_set1_epi32(-1)) : _mm256_cmpgt_epi32(target, x);
+				const auto valid = std::min<size_type>(8, length - 1 - gap);
+				const auto count = std::min<size_type>(std::popcount(unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(left)))), valid);
+				if (count < valid) {
+					_mm256_store_si256(reinterpret_cast<__m256i*>(offsets), x);
+					return { gap + count + 1, static_cast<key_type>(fence + static_cast<key_type>(offsets[count])) };
+				}
+			}
+			return { length, fence };
+		}
+#endif // LUX_SIMD_X86
+
+		// the decoder of the block for its width
+		template< bool Upper >
+		std::pair<size_type, key_type> _scan_block(size_type block, size_type length, key_type key) const noexcept {
+			const auto width = _widths[block];
+#ifdef LUX_SIMD_X86
+			if (std::has_single_bit(unsigned(width)) && _fits_avx2(width) && cpu().avx2)
+				return _scan_avx2<Upper>(block, length, key);
+#endif // LUX_SIMD_X86
+
+			switch (width) {
+			case 0: {
+				// consecutive keys, the position is the distance to the fence
+				const auto fence = _fences[block];
+				const auto dist = static_cast<uint64_t>(key - fence);
+				if (Upper ? dist < length - 1 : dist < length)
+					return { static_cast<size_type>(dist + Upper), static_cast<key_type>(fence + dist + Upper) };
+				return { length, key_type() };
+			}
+			case 1: return _scan_words<Upper, 1>(block, length, key);
+			case 2: return _scan_words<Upper, 2>(block, length, key);
+			case 4: return _scan_words<Upper, 4>(block, length, key);
+			case 8: return _scan_words<Upper, 8>(block, length, key);
+			case 16: return _scan_words<Upper, 16>(block, length, key);
+			case 32: return _scan_words<Upper, 32>(block, length, key);
+			default: return _scan<Upper>(block, length, key);
+			}
+		}
+
+		// first position whose key is not less than key (Upper == false) or greater than key (Upper == true)
+		template< bool Upper >
+		const_iterator _bound(key_type key) const {
+			if (empty())
+				return end();
+
+			const auto ub = _search.upper_bound(_fences.data(), _fences.size(), key, key_compare());
+			if (ub == 0)
+				return begin();
+
+			// the key falls in the block ub - 1, or the answer is the fence of the block ub
+			const auto block = ub - 1;
+			const auto length = _block_length(block);
+			const auto found = _scan_block<Upper>(block, length, key);
+			if (found.first < length)
+				return const_iterator(this, block * block_size + found.first, found.second);
+			return ub < block_count() ? const_iterator(this, ub * block_size, _fences[ub]) : end();
+		}
+
+	public:
+		const_iterator lower_bound(key_type key) const {
+			return _bound<false>(key);
+		}
+		const_iterator upper_bound(key_type key) const {
+			return _bound<true>(key);
+		}
+		std::pair<const_iterator, const_iterator> equal_range(key_type key) const {
+			auto first = lower_bound(key);
+			if (first != end() && *first == key) {
+				auto last = first;
+				return { first, ++last };
+			}
+			return { first, first };
+		}
+
+		const_iterator find(key_type key) const {
+			auto it = lower_bound(key);
+			return it != end() && *it == key ? it : end();
+		}
+		bool contains(key_type key) const {
+			return find(key) != end();
+		}
+		size_type count(key_type key) const {
+			return contains(key) ? 1 : 0;
+		}
+
+		/**
+		 * @brief Number of keys less than key
+		*/
+		size_type rank(key_type key) const {
+			return lower_bound(key).index();
+		}
+
+		/**
+		 * @brief The key of rank index
+		 * @throw std::out_of_range if index is not less than size()
+		*/
+		key_type select(size_type index) const {
+			if (index >= _size)
+				throw std::out_of_range("invalid lux::packed_sorted_set<K> index");
+
+			const auto block = index / block_size;
+			key_type value = _fences[block];
+			for (size_type pos = 0; pos < index % block_size; pos++)
+				value += static_cast<key_type>(1 + _gap(block, pos));
+			return value;
+		}
+
+	private:
+		std::vector<key_type> _fences;
+		std::vector<size_type> _offsets;
+		std::vector<uint8_t> _widths;
+		std::vector<uint64_t> _words;
+		size_type _size;
+		search_type _search;
+	};
+
+	/**
+	 * @brief Immutable sorted map from unsigned integers, with the keys compressed by blocks
+	 *
+	 * The keys are held by a packed_sorted_set, the values are stored uncompressed in the order of the keys,
+	 * so the value of a key is found at its rank.
+	*/
+	template<
+		class Key, class Value,
+		size_t BlockSize = 128,
+		class Search = lux::default_search
+	>
+	class packed_sorted_map
+	{
+	public:
+		using key_type					= Key;
+		using mapped_type				= Value;
+		using key_set_type				= packed_sorted_set<Key, BlockSize, Search>;
+		using key_compare				= std::less<Key>;
+		using search_type				= Search;
+		using size_type					= size_t;
+		using difference_type			= ptrdiff_t;
+
+		static constexpr size_type block_size = BlockSize;
+
+		/**
+		 * @brief Forward iterator, the key is decoded on the fly and returned by value with a reference to its value
+		*/
+		class const_iterator
+		{
+			friend class packed_sorted_map;
+
+		public:
+			using iterator_concept	= std::forward_iterator_tag;
+			using iterator_category	= std::input_iterator_tag;
+			using value_type		= std::pair<Key, Value>;
+			using difference_type	= ptrdiff_t;
+			using reference			= std::pair<Key, const Value&>;
+			using pointer			= void;
+
+			const_iterator() noexcept
+				: _key(), _values(nullptr) {
+			}
+
+			reference operator*() const noexcept {
+				return { *_key, _values[_key.index()] };
+			}
+			key_type key() const noexcept {
+				return *_key;
+			}
+			const mapped_type& value() const noexcept {
+				return _values[_key.index()];
+			}
+
+			const_iterator& operator++() noexcept {
+				++_key;
+				return *this;
+			}
+			const_iterator operator++(int) noexcept {
+				auto tmp = *this;
+				++(*this);
+				return tmp;
+			}
+
+			/**
+			 * @brief Position of the entry in the map, the rank of its key
+			*/
+			size_type index() const noexcept {
+				return _key.index();
+			}
+
+			bool operator==(const const_iterator& other) const noexcept {
+				return _key == other._key;
+			}
+
+		private:
+			const_iterator(typename key_set_type::const_iterator key, const mapped_type* values) noexcept
+				: _key(key), _values(values) {
+			}
+
+			typename key_set_type::const_iterator _key;
+			const mapped_type* _values;
+		};
+
+		using iterator = const_iterator;
+
+		packed_sorted_map() = default;
+
+		/**
+		 * @brief Compress the keys of a sorted_vector and copy its values in O(n)
+		*/
+		template< class Alloc, class SvSearch, class SvStats >
+		explicit packed_sorted_map(const sorted_vector<Key, Value, std::less<Key>, Alloc, SvSearch, SvStats>& sv)
+			: _keys(sorted_unique, sv.begin(), sv.end(), [](const auto& entry) -> const key_type& { return entry.key(); }), _values() {
+			_values.reserve(sv.size());
+			for (const auto& entry : sv)
+				_values.push_back(entry.value());
+		}
+
+		/**
+		 * @brief Compress a range of key/value pairs in any order, of the entries with equal keys the first one is kept
+		*/
+		template< class It >
+		packed_sorted_map(It first, It last)
+			: packed_sorted_map(sorted_vector<Key, Value>(first, last)) {
+		}
+		packed_sorted_map(std::initializer_list<std::pair<key_type, mapped_type>> ilist)
+			: packed_sorted_map(ilist.begin(), ilist.end()) {
+		}
+
+		bool empty() const noexcept {
+			return _keys.empty();
+		}
+		size_type size() const noexcept {
+			return _keys.size();
+		}
+
+		/**
+		 * @brief The compressed keys, in the order of the values
+		*/
+		const key_set_type& keys() const noexcept {
+			return _keys;
+		}
+
+		/**
+		 * @brief Bytes used by the packed keys, their block index and the values
+		*/
+		size_type memory_usage() const noexcept {
+			return _keys.memory_usage() + _values.capacity() * sizeof(mapped_type);
+		}
+
+		const_iterator begin() const noexcept {
+			return { _keys.begin(), _values.data() };
+		}
+		const_iterator cbegin() const noexcept {
+			return begin();
+		}
+		const_iterator end() const noexcept {
+			return { _keys.end(), _values.data() };
+		}
+		const_iterator cend() const noexcept {
+			return end();
+		}
+
+		const_iterator lower_bound(key_type key) const {
+			return { _keys.lower_bound(key), _values.data() };
+		}
+		const_iterator upper_bound(key_type key) const {
+			return { _keys.upper_bound(key), _values.data() };
+		}
+		std::pair<const_iterator, const_iterator> equal_range(key_type key) const {
+			auto [first, last] = _keys.equal_range(key);
+			return { { first, _values.data() }, { last, _values.data() } };
+		}
+
+		const_iterator find(key_type key) const {
+			return { _keys.find(key), _values.data() };
+		}
+		bool contains(key_type key) const {
+			return _keys.contains(key);
+		}
+		size_type count(key_type key) const {
+			return _keys.count(key);
+		}
+
+		/**
+		 * @brief Number of keys less than key
+		*/
+		size_type rank(key_type key) const {
+			return _keys.rank(key);
+		}
+
+		/**
+		 * @throw std::out_of_range if key is missing
+		*/
+		const mapped_type& at(key_type key) const {
+			auto it = _keys.find(key);
+			if (it == _keys.end())
+				throw std::out_of_range("invalid lux::packed_sorted_map<K, T> key");
+			return _values[it.index()];
+		}
+
+	private:
+		key_set_type _keys;
+		std::vector<mapped_type> _values;
+	};
+
+}
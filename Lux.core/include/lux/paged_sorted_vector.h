@@ -0,0 +1,790 @@
+#pragma once
+
+#include <lux/base_core.h>
+
+#include <lux/searching.h>
+#include <lux/sorted_vector.h>
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace lux
+{
+
+	/**
+	 * @brief sorted_vector split in small sorted pages, for very large tables with frequent writes
+	 *
+	 * The entries live in leaf pages of at most page_capacity entries, under a flat index that holds
+	 * the first key (the fence) of every page. An insert or erase moves the entries of one page only,
+	 * a full page is split in two and an underfull one is merged with a neighbour.
+	 * Iteration walks the pages in order, so scans stay sequential.
+	*/
+	template<
+		class Key, class Value = void,
+		class Compare = std::less<Key>,
+		class Alloc = std::allocator<sorted_vector_type<Key, Value>>,
+		class Search = lux::default_search
+	>
+	class paged_sorted_vector
+	{
+		static_assert(!_impls::_is_membership_filter<Search>, "lux::paged_sorted_vector indexes its fences with the search policy, a membership filter has no whole array to answer for");
+
+		using _this_type = sorted_vector_type<Key, Value>;
+
+		template< bool Const >
+		class _iterator;
+
+	public:
+		using key_type					= Key;
+		using mapped_type				= Value;
+		using value_type				= _this_type;
+		using key_compare				= Compare;
+		using search_type				= Search;
+		using is_mapped					= _this_type::is_mapped;
+		using page_type					= std::vector<value_type, Alloc>;
+		using allocator_type			= page_type::allocator_type;
+		using size_type					= page_type::size_type;
+		using difference_type			= page_type::difference_type;
+		using reference					= page_type::reference;
+		using const_reference			= page_type::const_reference;
+		using pointer					= page_type::pointer;
+		using const_pointer				= page_type::const_pointer;
+		using iterator					= _iterator<false>;
+		using const_iterator			= _iterator<true>;
+		using reverse_iterator			= std::reverse_iterator<iterator>;
+		using const_reverse_iterator	= std::reverse_iterator<const_iterator>;
+
+		// entries of a full page, about 4 KiB of them
+		static constexpr size_type page_capacity = std::max<size_type>(16, 4096 / sizeof(value_type));
+
+	private:
+		using _access_return_type = decltype(std::declval<value_type&>().value());
+		using _const_access_return_type = decltype(std::declval<const value_type&>().value());
+
+		using _pages_type = std::vector<page_type>;
+
+		// pages under this size are merged with a neighbour when they fit in one
+		static constexpr size_type _min_fill = page_capacity / 4;
+		// fill of the pages cut by a bulk insertion, the rest is left for the insertions to come
+		static constexpr size_type _bulk_fill = page_capacity * 3 / 4;
+
+		static inline const key_type& _key(const value_type& value) {
+			return value.key();
+		}
+
+		struct _key_projection
+		{
+			constexpr const key_type& operator()(const value_type& value) const noexcept {
+				return value.key();
+			}
+		};
+
+		// the search policy indexes the fences, the pages are searched by its window
+		constexpr void _fences_changed() noexcept {
+			_impls::_search_keys_changed(_search);
+		}
+
+		template< bool Const >
+		class _iterator
+		{
+			friend class paged_sorted_vector;
+
+			using _pages = std::conditional_t<Const, const _pages_type, _pages_type>;
+
+		public:
+			using iterator_category	= std::bidirectional_iterator_tag;
+			using value_type		= paged_sorted_vector::value_type;
+			using difference_type	= paged_sorted_vector::difference_type;
+			using reference			= std::conditional_t<Const, const value_type&, value_type&>;
+			using pointer			= std::conditional_t<Const, const value_type*, value_type*>;
+
+			constexpr _iterator() noexcept
+				: _data(nullptr), _page(0), _pos(0) {
+			}
+			constexpr operator _iterator<true>() const noexcept requires (!Const) {
+				return { _data, _page, _pos };
+			}
+
+			constexpr reference operator*() const noexcept {
+				return (*_data)[_page][_pos];
+			}
+			constexpr pointer operator->() const noexcept {
+				return std::addressof(**this);
+			}
+
+			constexpr _iterator& operator++() noexcept {
+				if (++_pos == (*_data)[_page].size())
+					_page++, _pos = 0;
+				return *this;
+			}
+			constexpr _iterator operator++(int) noexcept {
+				auto tmp = *this;
+				++(*this);
+				return tmp;
+			}
+			constexpr _iterator& operator--() noexcept {
+				if (_pos == 0)
+					_pos = (*_data)[--_page].size();
+				_pos--;
+				return *this;
+			}
+			constexpr _iterator operator--(int) noexcept {
+				auto tmp = *this;
+				--(*this);
+				return tmp;
+			}
+
+			constexpr bool operator==(const _iterator& other) const noexcept {
+				return _page == other._page && _pos == other._pos;
+			}
+
+			constexpr _iterator(_pages* data, size_type page, size_type pos) noexcept
+				: _data(data), _page(page), _pos(pos) {
+			}
+
+		private:
+			_pages* _data;
+			size_type _page;
+			size_type _pos;
+		};
+
+	public:
+		constexpr ~paged_sorted_vector() = default;
+
+		constexpr paged_sorted_vector(const key_compare& comp, const allocator_type& alloc = allocator_type())
+			: _pages(), _fences(), _size(0), _alloc(alloc), _comp(comp), _search() {
+		}
+
+		constexpr paged_sorted_vector()
+			: paged_sorted_vector(key_compare(), allocator_type()) {
+		}
+		explicit constexpr paged_sorted_vector(const allocator_type& alloc)
+			: paged_sorted_vector(key_compare(), alloc) {
+		}
+
+		template< class It >
+		constexpr paged_sorted_vector(It first, It last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+			: paged_sorted_vector(comp, alloc) {
+			insert(first, last);
+		}
+		constexpr paged_sorted_vector(std::initializer_list<value_type> ilist, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+			: paged_sorted_vector(ilist.begin(), ilist.end(), comp, alloc) {
+		}
+
+		constexpr paged_sorted_vector(const paged_sorted_vector& other) = default;
+		constexpr paged_sorted_vector(paged_sorted_vector&& other) = default;
+
+		constexpr paged_sorted_vector& operator=(const paged_sorted_vector& other) = default;
+		constexpr paged_sorted_vector& operator=(paged_sorted_vector&& other) = default;
+
+		constexpr allocator_type get_allocator() const noexcept {
+			return _alloc;
+		}
+		constexpr key_compare key_comp() const {
+			return _comp;
+		}
+
+		constexpr search_type& search_policy() noexcept {
+			return _search;
+		}
+		constexpr const search_type& search_policy() const noexcept {
+			return _search;
+		}
+
+		constexpr bool empty() const noexcept {
+			return _size == 0;
+		}
+		constexpr size_type size() const noexcept {
+			return _size;
+		}
+		/**
+		 * @brief Number of leaf pages
+		*/
+		constexpr size_type page_count() const noexcept {
+			return _pages.size();
+		}
+
+		constexpr iterator begin() noexcept {
+			return { &_pages, 0, 0 };
+		}
+		constexpr const_iterator begin() const noexcept {
+			return { &_pages, 0, 0 };
+		}
+		constexpr const_iterator cbegin() const noexcept {
+			return begin();
+		}
+
+		constexpr iterator end() noexcept {
+			return { &_pages, _pages.size(), 0 };
+		}
+		constexpr const_iterator end() const noexcept {
+			return { &_pages, _pages.size(), 0 };
+		}
+		constexpr const_iterator cend() const noexcept {
+			return end();
+		}
+
+		constexpr reverse_iterator rbegin() noexcept {
+			return reverse_iterator(end());
+		}
+		constexpr const_reverse_iterator rbegin() const noexcept {
+			return const_reverse_iterator(end());
+		}
+		constexpr const_reverse_iterator crbegin() const noexcept {
+			return rbegin();
+		}
+
+		constexpr reverse_iterator rend() noexcept {
+			return reverse_iterator(begin());
+		}
+		constexpr const_reverse_iterator rend() const noexcept {
+			return const_reverse_iterator(begin());
+		}
+		constexpr const_reverse_iterator crend() const noexcept {
+			return rend();
+		}
+
+		constexpr void clear() noexcept {
+			_pages.clear();
+			_fences.clear();
+			_size = 0;
+			_fences_changed();
+		}
+
+	private:
+		static constexpr bool _is_transparent = requires { typename key_compare::is_transparent; };
+
+		// page that holds key if it is present: the last one whose fence is not greater than key
+		template< class K >
+		constexpr size_type _page_of(const K& key) const {
+			if (_fences.size() < 2)
+				return 0;
+			return _search.upper_bound(_fences.data() + 1, _fences.size() - 1, key, _comp);
+		}
+
+		template< class K >
+		constexpr size_type _page_lower_bound(size_type page, const K& key) const {
+			const auto& entries = _pages[page];
+			return _impls::_window_search(_search).lower_bound(entries.data(), entries.size(), key, _comp, _key_projection{});
+		}
+		template< class K >
+		constexpr size_type _page_upper_bound(size_type page, const K& key) const {
+			const auto& entries = _pages[page];
+			return _impls::_window_search(_search).upper_bound(entries.data(), entries.size(), key, _comp, _key_projection{});
+		}
+
+		// the position past the end of a page is the start of the next one
+		constexpr std::pair<size_type, size_type> _normalize(size_type page, size_type pos) const noexcept {
+			if (page < _pages.size() && pos == _pages[page].size())
+				return { page + 1, 0 };
+			return { page, pos };
+		}
+
+		constexpr iterator _make(std::pair<size_type, size_type> at) noexcept {
+			return { &_pages, at.first, at.second };
+		}
+		constexpr const_iterator _make(std::pair<size_type, size_type> at) const noexcept {
+			return { &_pages, at.first, at.second };
+		}
+
+		// position of key, { page_count(), 0 } if it is missing
+		template< class K >
+		constexpr std::pair<size_type, size_type> _find(const K& key) const {
+			if (_pages.empty())
+				return { 0, 0 };
+
+			const auto page = _page_of(key);
+			const auto pos = _page_lower_bound(page, key);
+			if (pos < _pages[page].size() && !_comp(key, _key(_pages[page][pos])))
+				return { page, pos };
+			return { _pages.size(), 0 };
+		}
+
+		template< class K >
+		constexpr std::pair<size_type, size_type> _lower_bound(const K& key) const {
+			if (_pages.empty())
+				return { 0, 0 };
+			const auto page = _page_of(key);
+			return _normalize(page, _page_lower_bound(page, key));
+		}
+		template< class K >
+		constexpr std::pair<size_type, size_type> _upper_bound(const K& key) const {
+			if (_pages.empty())
+				return { 0, 0 };
+			const auto page = _page_of(key);
+			return _normalize(page, _page_upper_bound(page, key));
+		}
+
+		// inserts val at pos of page and splits the page when it overflows;
+		// everything that may allocate is done before an entry moves, a failed split leaves the page one entry over its capacity
+		constexpr iterator _insert_at(size_type page, size_type pos, value_type&& val) {
+			if (_pages.empty()) {
+				page_type first(_alloc);
+				first.reserve(page_capacity);
+				_fences.reserve(1);
+				_pages.reserve(1);
+				first.push_back(std::move(val));
+				_fences.push_back(_key(first.front()));
+				_pages.push_back(std::move(first));
+				_size++;
+				_fences_changed();
+				return _make({ 0, 0 });
+			}
+
+			page_type upper(_alloc);
+			if (_pages[page].size() == page_capacity) {
+				_fences.reserve(_fences.size() + 1);
+				_pages.reserve(_pages.size() + 1);
+				upper.reserve(page_capacity);
+			}
+			auto& entries = _pages[page];
+			std::optional<key_type> front;
+			if (pos == 0)
+				front.emplace(_key(val));
+
+			entries.emplace(entries.begin() + pos, std::move(val));
+			_size++;
+			if (front)
+				_fences[page] = std::move(*front), _fences_changed();
+
+			if (entries.size() <= page_capacity)
+				return _make({ page, pos });
+
+			// the upper half is copied to the new page unless it moves without throwing, the page and its fence are
+			// inserted into the reserved index, and only then is the half dropped from the full page
+			const auto half = entries.size() / 2;
+			for (auto i = half; i < entries.size(); i++)
+				upper.push_back(std::move_if_noexcept(entries[i]));
+			_fences.insert(_fences.begin() + (page + 1), _key(upper.front()));
+			_pages.insert(_pages.begin() + (page + 1), std::move(upper));
+			entries.erase(entries.begin() + half, entries.end());
+			_fences_changed();
+
+			return pos < half ? _make({ page, pos }) : _make({ page + 1, pos - half });
+		}
+
+		// erases the entry at pos of page, an underfull page is merged with a neighbour
+		constexpr iterator _erase_at(size_type page, size_type pos) {
+			auto& entries = _pages[page];
+			entries.erase(entries.begin() + pos);
+			_size--;
+			return _settle(page, pos);
+		}
+
+		// after an erasure from page, pos is the position of the entry that followed the erased ones:
+		// an empty page is dropped and an underfull one is merged with a neighbour
+		constexpr iterator _settle(size_type page, size_type pos) {
+			auto& entries = _pages[page];
+			if (entries.empty()) {
+				_pages.erase(_pages.begin() + page);
+				_fences.erase(_fences.begin() + page);
+				_fences_changed();
+				return _make({ page, 0 });
+			}
+			if (pos == 0)
+				_fences[page] = _key(entries.front()), _fences_changed();
+
+			if (entries.size() < _min_fill) {
+				if (page + 1 < _pages.size() && entries.size() + _pages[page + 1].size() <= page_capacity) {
+					auto& next = _pages[page + 1];
+					entries.insert(entries.end(), std::make_move_iterator(next.begin()), std::make_move_iterator(next.end()));
+					_pages.erase(_pages.begin() + (page + 1));
+					_fences.erase(_fences.begin() + (page + 1));
+					_fences_changed();
+				}
+				else if (page > 0 && entries.size() + _pages[page - 1].size() <= page_capacity) {
+					auto& prev = _pages[page - 1];
+					const auto offset = prev.size();
+					prev.insert(prev.end(), std::make_move_iterator(entries.begin()), std::make_move_iterator(entries.end()));
+					_pages.erase(_pages.begin() + page);
+					_fences.erase(_fences.begin() + page);
+					_fences_changed();
+					return _make(_normalize(page - 1, offset + pos));
+				}
+			}
+
+			return _make(_normalize(page, pos));
+		}
+
+		// merges the sorted unique range [first, last) into page, keeping the entries already present,
+		// and cuts the page in several when it overflows
+		template< class It >
+		constexpr void _merge_into(size_type page, It first, It last) {
+			// the entries of the page are moved only if that cannot throw, so the page is intact until the commit
+			auto& entries = _pages[page];
+			page_type merged(_alloc);
+			merged.reserve(std::max(page_capacity, entries.size() + static_cast<size_type>(last - first)));
+
+			size_type added = 0;
+			auto in = entries.begin();
+			for (; first != last; ++first) {
+				while (in != entries.end() && _comp(_key(*in), _key(*first)))
+					merged.push_back(std::move_if_noexcept(*in++));
+				if (in != entries.end() && !_comp(_key(*first), _key(*in)))
+					continue;
+				merged.push_back(std::move(*first));
+				added++;
+			}
+			for (; in != entries.end(); ++in)
+				merged.push_back(std::move_if_noexcept(*in));
+
+			// only the moves of the pages and of the keys follow the last allocation, the pages and _size are committed together
+			if (merged.size() <= page_capacity) {
+				auto fence = _key(merged.front());
+				_pages[page].swap(merged);
+				_fences[page] = std::move(fence);
+				_size += added;
+				return;
+			}
+
+			// the entries are spread evenly over the pages, each filled to about _bulk_fill
+			const auto parts = (merged.size() + _bulk_fill - 1) / _bulk_fill;
+			_pages_type cut;
+			std::vector<key_type> fences;
+			cut.reserve(parts - 1), fences.reserve(parts - 1);
+			for (size_type i = 1; i < parts; i++) {
+				const auto from = merged.begin() + merged.size() * i / parts, to = merged.begin() + merged.size() * (i + 1) / parts;
+				auto& part = cut.emplace_back(_alloc);
+				part.reserve(page_capacity);
+				part.insert(part.end(), std::make_move_iterator(from), std::make_move_iterator(to));
+				fences.push_back(_key(part.front()));
+			}
+			merged.erase(merged.begin() + merged.size() / parts, merged.end());
+
+			auto fence = _key(merged.front());
+			_pages.reserve(_pages.size() + cut.size());
+			_fences.reserve(_fences.size() + fences.size());
+
+			_pages[page].swap(merged);
+			_fences[page] = std::move(fence);
+			_pages.insert(_pages.begin() + (page + 1), std::make_move_iterator(cut.begin()), std::make_move_iterator(cut.end()));
+			_fences.insert(_fences.begin() + (page + 1), std::make_move_iterator(fences.begin()), std::make_move_iterator(fences.end()));
+			_size += added;
+		}
+
+		// true if key belongs right before the entry at pos of page
+		constexpr bool _fits_at(size_type page, size_type pos, const key_type& key) const {
+			const auto& entries = _pages[page];
+			if (pos < entries.size() && !_comp(key, _key(entries[pos])))
+				return false;
+			if (pos > 0)
+				return _comp(_key(entries[pos - 1]), key);
+			return page == 0 || _comp(_key(_pages[page - 1].back()), key);
+		}
+
+		template< class K, class Make >
+		constexpr std::pair<iterator, bool> _try_insert(const K& key, Make make) {
+			if (_pages.empty())
+				return { _insert_at(0, 0, make()), true };
+
+			const auto page = _page_of(key);
+			const auto pos = _page_lower_bound(page, key);
+			if (pos < _pages[page].size() && !_comp(key, _key(_pages[page][pos])))
+				return { _make({ page, pos }), false };
+			return { _insert_at(page, pos, make()), true };
+		}
+
+	public:
+		template< class... Args >
+		constexpr std::pair<iterator, bool> emplace(Args&&... args) {
+			value_type val{ std::forward<Args>(args)... };
+			const auto& key = _key(val);
+			return _try_insert(key, [&]() -> value_type&& { return std::move(val); });
+		}
+
+		/**
+		 * @brief Insert an entry if its key is missing, hint is the position the key is expected at
+		 *
+		 * A key that belongs right before hint costs two comparisons, any other key is searched.
+		 * @return The entry with the key, inserted or not
+		*/
+		template< class... Args >
+		constexpr iterator emplace_hint(const_iterator hint, Args&&... args) {
+			value_type val{ std::forward<Args>(args)... };
+			const auto& key = _key(val);
+
+			// the end is the position past the last page
+			auto page = hint._page, pos = hint._pos;
+			if (page == _pages.size() && page > 0)
+				page--, pos = _pages[page].size();
+			if (!_pages.empty() && _fits_at(page, pos, key))
+				return _insert_at(page, pos, std::move(val));
+			return _try_insert(key, [&]() -> value_type&& { return std::move(val); }).first;
+		}
+
+		constexpr std::pair<iterator, bool> insert(const value_type& value) {
+			return emplace(value);
+		}
+		constexpr std::pair<iterator, bool> insert(value_type&& value) {
+			return emplace(std::move(value));
+		}
+		constexpr iterator insert(const_iterator hint, const value_type& value) {
+			return emplace_hint(hint, value);
+		}
+		constexpr iterator insert(const_iterator hint, value_type&& value) {
+			return emplace_hint(hint, std::move(value));
+		}
+
+		/**
+		 * @brief Insert a range in O(m log m + p), p the entries of the pages it falls in
+		 *
+		 * The range is sorted and deduplicated, then merged page by page. Of the entries with equal keys
+		 * the one already present is kept, else the first one of the range.
+		*/
+		template< class It >
+		constexpr void insert(It first, It last) {
+			page_type incoming(_alloc);
+			for (; first != last; ++first)
+				incoming.emplace_back(*first);
+			if (incoming.empty())
+				return;
+
+			std::stable_sort(incoming.begin(), incoming.end(), [this](const value_type& left, const value_type& right) {
+				return _comp(_key(left), _key(right));
+			});
+			incoming.erase(std::unique(incoming.begin(), incoming.end(), [this](const value_type& left, const value_type& right) {
+				return !_comp(_key(left), _key(right));
+			}), incoming.end());
+
+			if (_pages.empty()) {
+				_pages.emplace_back(_alloc);
+				_fences.push_back(_key(incoming.front()));
+			}
+
+			// from the last page down, so the pages cut by a merge do not move the ones still to merge;
+			// the fences are searched directly, the index of the search policy is stale until the end
+			auto hi = incoming.end();
+			while (hi != incoming.begin()) {
+				const auto page = static_cast<size_type>(std::upper_bound(_fences.begin() + 1, _fences.end(), _key(*(hi - 1)), _comp) - (_fences.begin() + 1));
+				auto lo = incoming.begin();
+				if (page > 0) {
+					lo = std::lower_bound(incoming.begin(), hi, _fences[page], [this](const value_type& val, const key_type& key) {
+						return _comp(_key(val), key);
+					});
+				}
+				_merge_into(page, lo, hi);
+				hi = lo;
+			}
+			_fences_changed();
+		}
+		constexpr void insert(std::initializer_list<value_type> ilist) {
+			insert(ilist.begin(), ilist.end());
+		}
+
+		template< class K, class... Args >
+		constexpr std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+			static_assert(is_mapped::value, "mapped_value must be valid");
+
+			return _try_insert(key, [&]() {
+				return value_type(std::forward<K>(key), mapped_type(std::forward<Args>(args)...));
+			});
+		}
+
+		template< class K, class T >
+		constexpr std::pair<iterator, bool> insert_or_assign(K&& key, T&& val) {
+			static_assert(is_mapped::value, "mapped_value must be valid");
+
+			auto res = _try_insert(key, [&]() { return value_type(std::forward<K>(key), std::forward<T>(val)); });
+			if (!res.second)
+				res.first->value() = std::forward<T>(val);
+			return res;
+		}
+
+		constexpr iterator erase(const_iterator it) {
+			return _erase_at(it._page, it._pos);
+		}
+		/**
+		 * @brief Erase the entries of [first, last), the pages in between are dropped whole
+		*/
+		constexpr iterator erase(const_iterator first, const_iterator last) {
+			const auto page = first._page, pos = first._pos;
+			if (first == last)
+				return _make({ page, pos });
+			if (page == last._page) {
+				auto& entries = _pages[page];
+				entries.erase(entries.begin() + pos, entries.begin() + last._pos);
+				_size -= last._pos - pos;
+				return _settle(page, pos);
+			}
+
+			// the position of the first entry kept is found again by its key once the pages are settled
+			std::optional<key_type> next;
+			if (last._page < _pages.size())
+				next = _key(_pages[last._page][last._pos]);
+
+			if (next) {
+				auto& entries = _pages[last._page];
+				entries.erase(entries.begin(), entries.begin() + last._pos);
+				_size -= last._pos;
+			}
+			for (auto middle = page + 1; middle < last._page; middle++)
+				_size -= _pages[middle].size();
+			_pages.erase(_pages.begin() + (page + 1), _pages.begin() + last._page);
+			_fences.erase(_fences.begin() + (page + 1), _fences.begin() + last._page);
+			_fences_changed();
+
+			auto& entries = _pages[page];
+			_size -= entries.size() - pos;
+			entries.erase(entries.begin() + pos, entries.end());
+
+			// the page of last follows the page of first now, it is settled first so that the index of the page of first holds
+			if (next)
+				_settle(page + 1, 0);
+			_settle(page, pos);
+			return next ? _make(_lower_bound(*next)) : end();
+		}
+
+	private:
+		template< class K >
+		constexpr size_type _erase(const K& key) {
+			auto [page, pos] = _find(key);
+			if (page == _pages.size())
+				return 0;
+			_erase_at(page, pos);
+			return 1;
+		}
+
+	public:
+		constexpr size_type erase(const key_type& key) {
+			return _erase(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr size_type erase(const K& key) {
+			return _erase(key);
+		}
+
+		constexpr void swap(paged_sorted_vector& other) noexcept {
+			_pages.swap(other._pages);
+			_fences.swap(other._fences);
+			std::swap(_size, other._size);
+			if constexpr (std::allocator_traits<allocator_type>::propagate_on_container_swap::value)
+				std::swap(_alloc, other._alloc);
+			std::swap(_comp, other._comp);
+			std::swap(_search, other._search);
+			_fences_changed(), other._fences_changed();
+		}
+
+	private:
+		template< class K >
+		constexpr std::pair<size_type, size_type> _at(const K& key) const {
+			const auto at = _find(key);
+			if (at.first != _pages.size())
+				return at;
+
+			if constexpr (is_mapped::value)
+				throw std::out_of_range("invalid lux::paged_sorted_vector<K, T> key");
+			else
+				throw std::out_of_range("invalid lux::paged_sorted_vector<K> key");
+		}
+
+	public:
+		constexpr _access_return_type at(const key_type& key) {
+			return _make(_at(key))->value();
+		}
+		constexpr _const_access_return_type at(const key_type& key) const {
+			return _make(_at(key))->value();
+		}
+		template< class K > requires _is_transparent
+		constexpr _access_return_type at(const K& key) {
+			return _make(_at(key))->value();
+		}
+		template< class K > requires _is_transparent
+		constexpr _const_access_return_type at(const K& key) const {
+			return _make(_at(key))->value();
+		}
+
+		constexpr _access_return_type operator[](const key_type& key) {
+			if constexpr (is_mapped::value)
+				return try_emplace(key).first->value();
+			else
+				return emplace(key).first->value();
+		}
+
+		constexpr size_type count(const key_type& key) const {
+			return contains(key) ? 1 : 0;
+		}
+		template< class K > requires _is_transparent
+		constexpr size_type count(const K& key) const {
+			return contains(key) ? 1 : 0;
+		}
+		constexpr bool contains(const key_type& key) const {
+			return _find(key).first != _pages.size();
+		}
+		template< class K > requires _is_transparent
+		constexpr bool contains(const K& key) const {
+			return _find(key).first != _pages.size();
+		}
+
+		constexpr iterator find(const key_type& key) {
+			return _make(_find(key));
+		}
+		constexpr const_iterator find(const key_type& key) const {
+			return _make(_find(key));
+		}
+		template< class K > requires _is_transparent
+		constexpr iterator find(const K& key) {
+			return _make(_find(key));
+		}
+		template< class K > requires _is_transparent
+		constexpr const_iterator find(const K& key) const {
+			return _make(_find(key));
+		}
+
+		constexpr iterator lower_bound(const key_type& key) {
+			return _make(_lower_bound(key));
+		}
+		constexpr const_iterator lower_bound(const key_type& key) const {
+			return _make(_lower_bound(key));
+		}
+		template< class K > requires _is_transparent
+		constexpr iterator lower_bound(const K& key) {
+			return _make(_lower_bound(key));
+		}
+		template< class K > requires _is_transparent
+		constexpr const_iterator lower_bound(const K& key) const {
+			return _make(_lower_bound(key));
+		}
+
+		constexpr iterator upper_bound(const key_type& key) {
+			return _make(_upper_bound(key));
+		}
+		constexpr const_iterator upper_bound(const key_type& key) const {
+			return _make(_upper_bound(key));
+		}
+		template< class K > requires _is_transparent
+		constexpr iterator upper_bound(const K& key) {
+			return _make(_upper_bound(key));
+		}
+		template< class K > requires _is_transparent
+		constexpr const_iterator upper_bound(const K& key) const {
+			return _make(_upper_bound(key));
+		}
+
+		constexpr std::pair<iterator, iterator> equal_range(const key_type& key) {
+			return { lower_bound(key), upper_bound(key) };
+		}
+		constexpr std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+			return { lower_bound(key), upper_bound(key) };
+		}
+		template< class K > requires _is_transparent
+		constexpr std::pair<iterator, iterator> equal_range(const K& key) {
+			return { _make(_lower_bound(key)), _make(_upper_bound(key)) };
+		}
+		template< class K > requires _is_transparent
+		constexpr std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+			return { _make(_lower_bound(key)), _make(_upper_bound(key)) };
+		}
+
+	private:
+		_pages_type _pages;
+		std::vector<key_type> _fences;
+		size_type _size;
+		allocator_type _alloc;
+		key_compare _comp;
+		search_type _search;
+	};
+
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <lux/base_core.h>
+
+#include <lux/sorted_vector.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace lux
+{
+
+	/**
+	 * @brief Read-copy-update cell for read-mostly data shared across threads
+	 *
+	 * The current value is published through a plain atomic pointer. A reader announces the value it holds
+	 * in a hazard slot of its own cache line and checks that it is still current, so the readers write to
+	 * no shared counter and never take a lock; they are lock-free, a reader retries only when a writer
+	 * publishes between its load and its check. Writers copy the current value, modify the copy and publish
+	 * it; they are serialized among themselves and free the replaced values once no slot holds them.
+	 * A snapshot must not outlive the cell.
+	*/
+	template< class Ty >
+	class rcu
+	{
+	public:
+		using value_type		= Ty;
+		using size_type			= size_t;
+
+		// slots are added a block at a time once this many snapshots are held at once
+		static constexpr size_type slot_block_size = 64;
+
+	private:
+		struct alignas(64) _reader_slot
+		{
+			std::atomic<const value_type*> hazard = nullptr;
+		};
+
+		struct _slot_block
+		{
+			_reader_slot slots[slot_block_size];
+			std::atomic<_slot_block*> next = nullptr;
+		};
+
+	public:
+		/**
+		 * @brief The value current when it was taken, it stays valid and unchanged while the snapshot is held
+		*/
+		class snapshot_type
+		{
+			friend class rcu;
+
+		public:
+			snapshot_type() noexcept = default;
+			~snapshot_type() {
+				reset();
+			}
+
+			snapshot_type(const snapshot_type&) = delete;
+			snapshot_type& operator=(const snapshot_type&) = delete;
+
+			snapshot_type(snapshot_type&& other) noexcept
+				: _slot(std::exchange(other._slot, nullptr)), _value(std::exchange(other._value, nullptr)) {
+			}
+			snapshot_type& operator=(snapshot_type&& other) noexcept {
+				if (this != &other) {
+					reset();
+					_slot = std::exchange(other._slot, nullptr);
+					_value = std::exchange(other._value, nullptr);
+				}
+				return *this;
+			}
+
+			/**
+			 * @brief Release the value, the writers may free it afterwards
+			*/
+			void reset() noexcept {
+				if (_slot)
+					_slot->hazard.store(nullptr, std::memory_order_release);
+				_slot = nullptr;
+				_value = nullptr;
+			}
+
+			const value_type* get() const noexcept {
+				return _value;
+			}
+			const value_type& operator*() const noexcept {
+				return *_value;
+			}
+			const value_type* operator->() const noexcept {
+				return _value;
+			}
+			explicit operator bool() const noexcept {
+				return _value != nullptr;
+			}
+
+		private:
+			snapshot_type(_reader_slot* slot, const value_type* value) noexcept
+				: _slot(slot), _value(value) {
+			}
+
+			_reader_slot* _slot = nullptr;
+			const value_type* _value = nullptr;
+		};
+
+		~rcu() {
+			delete _current.load(std::memory_order_relaxed);
+			for (auto value : _retired)
+				delete value;
+			for (auto block = _slots.next.load(std::memory_order_relaxed); block;)
+				delete std::exchange(block, block->next.load(std::memory_order_relaxed));
+		}
+
+		rcu()
+			: _current(new value_type()) {
+		}
+		explicit rcu(value_type value)
+			: _current(new value_type(std::move(value))) {
+		}
+
+		rcu(const rcu&) = delete;
+		rcu& operator=(const rcu&) = delete;
+
+		/**
+		 * @brief The current value
+		 *
+		 * It allocates only when every slot is taken by a held snapshot.
+		*/
+		snapshot_type snapshot() const {
+			const auto start = _reader_index();
+			for (auto block = &_slots;; block = _next_block(*block)) {
+				for (size_type i = 0; i < slot_block_size; i++) {
+					auto& slot = block->slots[(start + i) % slot_block_size];
+					if (slot.hazard.load(std::memory_order_relaxed) != nullptr)
+						continue;
+
+					auto value = _current.load(std::memory_order_seq_cst);
+					const value_type* expected = nullptr;
+					if (!slot.hazard.compare_exchange_strong(expected, value, std::memory_order_seq_cst))
+						continue;
+
+					// a writer that replaced the value before it could see the hazard may free it, announce the new one
+					for (auto latest = _current.load(std::memory_order_seq_cst); latest != value; latest = _current.load(std::memory_order_seq_cst)) {
+						slot.hazard.store(latest, std::memory_order_seq_cst);
+						value = latest;
+					}
+					return { &slot, value };
+				}
+			}
+		}
+
+		/**
+		 * @brief Replace the value
+		*/
+		void publish(value_type value) {
+			auto next = std::make_unique<value_type>(std::move(value));
+			std::lock_guard lock(_writer);
+			_replace(std::move(next));
+		}
+
+		/**
+		 * @brief Apply fn to a copy of the current value and publish the copy
+		 *
+		 * Every mutation done by fn becomes visible at once, so a batch of changes costs one copy.
+		 * If fn throws nothing is published.
+		 * @return A copy of the result of fn, a reference into the value would outlive the value
+		*/
+		template< class Fn >
+		std::decay_t<std::invoke_result_t<Fn, value_type&>> update(Fn&& fn) {
+			std::lock_guard lock(_writer);
+			auto copy = std::make_unique<value_type>(*_current.load(std::memory_order_relaxed));
+
+			if constexpr (std::is_void_v<std::invoke_result_t<Fn, value_type&>>) {
+				std::forward<Fn>(fn)(*copy);
+				_replace(std::move(copy));
+			}
+			else {
+				std::decay_t<std::invoke_result_t<Fn, value_type&>> res = std::forward<Fn>(fn)(*copy);
+				_replace(std::move(copy));
+				return res;
+			}
+		}
+
+	private:
+		// threads start probing at different slots, so that concurrent readers do not share a cache line
+		static size_type _reader_index() noexcept {
+			static std::atomic<size_type> next_index = 0;
+			static thread_local const size_type index = next_index.fetch_add(1, std::memory_order_relaxed);
+			return index;
+		}
+
+		static _slot_block* _next_block(_slot_block& block) {
+			if (auto next = block.next.load(std::memory_order_acquire))
+				return next;
+
+			auto fresh = std::make_unique<_slot_block>();
+			_slot_block* expected = nullptr;
+			if (block.next.compare_exchange_strong(expected, fresh.get(), std::memory_order_acq_rel))
+				return fresh.release();
+			return expected;
+		}
+
+		bool _held(const value_type* value) const noexcept {
+			for (auto block = &_slots; block; block = block->next.load(std::memory_order_acquire)) {
+				for (auto& slot : block->slots) {
+					if (slot.hazard.load(std::memory_order_seq_cst) == value)
+						return true;
+				}
+			}
+			return false;
+		}
+
+		// the writer lock is held
+		void _replace(std::unique_ptr<value_type> next) {
+			_retired.reserve(_retired.size() + 1);
+			_retired.push_back(_current.exchange(next.release(), std::memory_order_seq_cst));
+
+			std::erase_if(_retired, [this](const value_type* value) {
+				if (_held(value))
+					return false;
+				delete value;
+				return true;
+			});
+		}
+
+		std::atomic<const value_type*> _current;
+		mutable _slot_block _slots;
+		std::mutex _writer;
+		// replaced values that a snapshot may still hold
+		std::vector<const value_type*> _retired;
+	};
+
+	template<
+		class Key, class Value = void,
+		class Compare = std::less<Key>,
+		class Alloc = std::allocator<sorted_vector_type<Key, Value>>,
+		class Search = lux::default_search,
+		class Stats = lux::no_stats
+	>
+	using rcu_sorted_vector = rcu<sorted_vector<Key, Value, Compare, Alloc, Search, Stats>>;
+
+}
@@ -0,0 +1,1161 @@
+#pragma once
+
+#include <lux/base_core.h>
+
+#include <lux/math.h>
+#include <lux/memory.h>
+#include <lux/simd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lux
+{
+
+	/*
+	*	Search policies
+	*
+	*	A search policy finds the bounds of a key inside a sorted array.
+	*	The array is given as (first, count) and every element is mapped to its key through proj.
+	*	The results are offsets from first, in the range [0, count].
+	*	A policy that reads keys without proj, with a vector load, reports them through proj.read(count) when proj has it.
+	*/
+
+	/**
+	 * @brief Classic binary search, one comparison and one branch per step
+	*/
+	struct binary_search
+	{
+		constexpr ~binary_search() = default;
+		constexpr binary_search() = default;
+
+		template< class Ty, class Key, class Comp, class Proj = std::identity >
+		constexpr size_t lower_bound(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj proj = {}) const {
+			size_t left = 0, right = count;
+			while (left < right) {
+				auto mid = left + (right - left) / 2;
+				if (comp(proj(first[mid]), key))
+					left = mid + 1;
+				else
+					right = mid;
+			}
+
+			return left;
+		}
+
+		template< class Ty, class Key, class Comp, class Proj = std::identity >
+		constexpr size_t upper_bound(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj proj = {}) const {
+			size_t left = 0, right = count;
+			while (left < right) {
+				auto mid = left + (right - left) / 2;
+				if (comp(key, proj(first[mid])))
+					right = mid;
+				else
+					left = mid + 1;
+			}
+
+			return left;
+		}
+	};
+
+	/**
+	 * @brief Binary search without data dependent branches
+	 *
+	 * The range is halved with a conditional move, so the loop runs exactly log2(count) steps
+	 * and never mispredicts. Both candidates of the next step are prefetched.
+	*/
+	struct branchless_search
+	{
+		constexpr ~branchless_search() = default;
+		constexpr branchless_search() = default;
+
+		template< class Ty, class Key, class Comp, class Proj = std::identity >
+		constexpr size_t lower_bound(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj proj = {}) const {
+			if (count == 0)
+				return 0;
+
+			auto base = first;
+			while (count > 1) {
+				auto half = count / 2;
+				lux::prefetch(base + (count - half) / 2);
+				lux::prefetch(base + half + (count - half) / 2);
+				base = comp(proj(base[half]), key) ? base + half : base;
+				count -= half;
+			}
+
+			return static_cast<size_t>(base - first) + (comp(proj(*base), key) ? 1 : 0);
+		}
+
+		template< class Ty, class Key, class Comp, class Proj = std::identity >
+		constexpr size_t upper_bound(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj proj = {}) const {
+			if (count == 0)
+				return 0;
+
+			auto base = first;
+			while (count > 1) {
+				auto half = count / 2;
+				lux::prefetch(base + (count - half) / 2);
+				lux::prefetch(base + half + (count - half) / 2);
+				base = comp(key, proj(base[half])) ? base : base + half;
+				count -= half;
+			}
+
+			return static_cast<size_t>(base - first) + (comp(key, proj(*base)) ? 0 : 1);
+		}
+
+		/**
+		 * @brief lower_bound of n keys, key_of(i) is the key i and out(i, pos) receives its bound
+		 *
+		 * Searches over the same count take the same steps, so a group of keys runs in lockstep
+		 * and the cache misses of its searches overlap.
+		*/
+		template< class Ty, class KeyOf, class Comp, class Out, class Proj = std::identity >
+		constexpr void lower_bound_many(const Ty* first, size_t count, size_t n, KeyOf key_of, const Comp& comp, Out out, Proj proj = {}) const {
+			constexpr size_t group_size = 8;
+
+			for (size_t i = 0; i < n; i += group_size) {
+				const auto group = std::min(group_size, n - i);
+				if (count == 0) {
+					for (size_t j = 0; j < group; j++)
+						out(i + j, size_t(0));
+					continue;
+				}
+
+				const Ty* base[group_size];
+				for (size_t j = 0; j < group; j++)
+					base[j] = first;
+
+				for (auto left = count; left > 1;) {
+					const auto half = left / 2;
+					const auto next = (left - half) / 2;
+					for (size_t j = 0; j < group; j++) {
+						base[j] = comp(proj(base[j][half]), key_of(i + j)) ? base[j] + half : base[j];
+						lux::prefetch(base[j] + next);
+					}
+					left -= half;
+				}
+
+				for (size_t j = 0; j < group; j++)
+					out(i + j, static_cast<size_t>(base[j] - first) + (comp(proj(*base[j]), key_of(i + j)) ? 1 : 0));
+			}
+		}
+	};
+
+	/**
+	 * @brief Static k-ary index of the keys searched with vector compares, for 32 bit keys ordered by std::less
+	 *
+	 * The keys are copied once into a B+ tree of 64 byte nodes (16 keys) stored level by level. A lookup
+	 * compares the key with a whole node at once, two AVX2 or four SSE4.2 compares, and descends to the child
+	 * given by the count of smaller keys: it reads one cache line per level instead of the log2(n) dependent loads of a
+	 * halving search. The entries need not be contiguous, so the keys of a map are indexed too. The result is checked
+	 * against the array, a stale index costs a Fallback search but never a wrong result.
+	 *
+	 * The index is built lazily like the learned_search model, once the lookups since the last change would have paid
+	 * for it; the containers call invalidate() when their keys change, and the subranges go to window(). The instruction
+	 * set is chosen at runtime. Other key types (64 bit keys too) and comparators, short arrays and cpus without SSE4.2
+	 * go to Fallback.
+	*/
+	template< class Fallback = branchless_search >
+	class simd_index_search
+	{
+	public:
+		~simd_index_search() = default;
+		simd_index_search() = default;
+
+		// the index belongs to the array of the source, a copy builds its own
+		simd_index_search(const simd_index_search& other) noexcept
+			: _fallback(other._fallback) {
+		}
+		simd_index_search& operator=(const simd_index_search& other) noexcept {
+			_fallback = other._fallback;
+			invalidate();
+			return *this;
+		}
+
+		/**
+		 * @brief Drop the index, the keys of the array have changed
+		 *
+		 * Called by the writer of the container, without concurrent lookups.
+		*/
+		void invalidate() noexcept {
+			_current.store(nullptr, std::memory_order_relaxed);
+			_indexes.clear();
+			_lookups.store(0, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief The policy for the subranges of the array, they must not build the index of the whole array
+		*/
+		constexpr const Fallback& window() const noexcept {
+			return _fallback;
+		}
+
+		bool indexed() const noexcept {
+			return _current.load(std::memory_order_acquire) != nullptr;
+		}
+		/**
+		 * @brief Number of entries of the array the index was built on, 0 without an index
+		*/
+		size_t index_size() const noexcept {
+			const auto index = _current.load(std::memory_order_acquire);
+			return index ? index->count : 0;
+		}
+
+	private:
+		// arrays this short are left to the fallback
+		static constexpr size_t _min_count = 512;
+		// the index is built after count / _amortize lookups since the last change
+		static constexpr size_t _amortize = 16;
+		// one lookup in this many of each thread is counted toward the build, the others write nothing shared
+		static constexpr uint32_t _sample = 16;
+		// indexes built without a change of the keys, the array keeps moving past this many
+		static constexpr size_t _max_indexes = 4;
+		// a node fills a cache line
+		static constexpr size_t _node_bytes = 64;
+		// levels of the tree, enough for any array
+		static constexpr size_t _max_depth = 16;
+
+		struct alignas(_node_bytes) _node
+		{
+			std::byte keys[_node_bytes];
+		};
+
+		// a published index is immutable, the lookups read it without a lock
+		struct _index
+		{
+			std::unique_ptr<_node[]> nodes;
+			// first node of every level, the leaves first
+			size_t levels[_max_depth] = {};
+			size_t depth = 0;
+			const void* first = nullptr;
+			size_t count = 0;
+			_impls::_simd_kind kind = _impls::_simd_kind::none;
+
+			template< class Key >
+			Key* keys(size_t level) const noexcept {
+				return reinterpret_cast<Key*>(nodes[levels[level]].keys);
+			}
+		};
+
+		template< class Key >
+		static constexpr size_t _node_keys = _node_bytes / sizeof(Key);
+
+		template< class Ty, class Key, class Comp, class Proj >
+		static constexpr bool _use_index() noexcept {
+			using proj_key = std::remove_cvref_t<std::invoke_result_t<Proj&, const Ty&>>;
+			// a node of 8 byte keys holds half the keys for as many compares, it was measured no faster than Fallback
+			return std::is_same_v<proj_key, Key> && _impls::_is_simd_key_v<Key> && sizeof(Key) == 4
+				&& (std::is_same_v<Comp, std::less<Key>> || std::is_same_v<Comp, std::less<>>);
+		}
+
+		static bool _vectorized() noexcept {
+#ifdef LUX_SIMD_X86
+			return cpu().sse42;
+#else
+			return false;
+#endif // LUX_SIMD_X86
+		}
+
+		// fills the nodes past the last key, it is not less than any key
+		template< class Key >
+		static constexpr Key _padding() noexcept {
+			if constexpr (std::is_floating_point_v<Key>)
+				return std::numeric_limits<Key>::infinity();
+			else
+				return std::numeric_limits<Key>::max();
+		}
+
+		template< class Key, class Ty, class Proj >
+		static void _build(_index& index, const Ty* first, size_t count, Proj& proj) {
+			constexpr size_t keys = _node_keys<Key>, fanout = keys + 1;
+
+			// a level has a node for every fanout nodes of the level below
+			const size_t leaves = (count + keys - 1) / keys;
+			size_t total = 0;
+			for (size_t nodes = leaves;; nodes = (nodes + fanout - 1) / fanout) {
+				index.levels[index.depth++] = total;
+				total += nodes;
+				if (nodes == 1)
+					break;
+			}
+			index.nodes.reset(new _node[total]);
+
+			// the leaves hold the keys in order
+			const auto leaf_keys = index.template keys<Key>(0);
+			for (size_t i = 0; i < leaves * keys; i++)
+				leaf_keys[i] = i < count ? static_cast<Key>(proj(first[i])) : _padding<Key>();
+
+			// the separator j of a node is the first key of its child j + 1, the missing children are padding
+			for (size_t level = 1, span = 1; level < index.depth; level++, span *= fanout) {
+				const auto below = index.levels[level] - index.levels[level - 1];
+				const auto nodes = (level + 1 < index.depth ? index.levels[level + 1] : total) - index.levels[level];
+				const auto separators = index.template keys<Key>(level);
+				for (size_t k = 0; k < nodes; k++) {
+					for (size_t j = 0; j < keys; j++) {
+						const auto child = k * fanout + j + 1;
+						separators[k * keys + j] = child < below ? leaf_keys[child * span * keys] : _padding<Key>();
+					}
+				}
+			}
+
+			index.first = first, index.count = count, index.kind = _impls::_simd_kind_of<Key>();
+		}
+
+		template< class Key >
+		static bool _matches(const _index* index, const void* first, size_t count) noexcept {
+			return index && index->first == first && index->count == count && index->kind == _impls::_simd_kind_of<Key>();
+		}
+
+		// true for the lookups that are counted, the tick is per thread so that it is not shared either
+		static bool _sampled() noexcept {
+			static thread_local uint32_t tick = 0;
+			return ++tick % _sample == 0;
+		}
+
+		// the index of the array, built when the lookups since the last change have paid for it
+		template< class Key, class Ty, class Proj >
+		const _index* _ready(const Ty* first, size_t count, Proj& proj) const {
+			const auto index = _current.load(std::memory_order_acquire);
+			if (_matches<Key>(index, first, count))
+				return index;
+			if (count < _min_count || !_sampled() || _lookups.fetch_add(1, std::memory_order_relaxed) < count / (_amortize * _sample))
+				return nullptr;
+
+			std::lock_guard lock(_building);
+			if (const auto current = _current.load(std::memory_order_relaxed); _matches<Key>(current, first, count))
+				return current;
+			// the replaced indexes stay alive for the concurrent lookups until the next invalidate()
+			if (_indexes.size() >= _max_indexes)
+				return nullptr;
+
+			// the lookups are noexcept, without memory they go on without the index
+			try {
+				_indexes.reserve(_max_indexes);
+				auto built = std::make_unique<_index>();
+				_build<Key>(*built, first, count, proj);
+				_indexes.push_back(std::move(built));
+			}
+			catch (const std::bad_alloc&) {
+				_lookups.store(0, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			_lookups.store(0, std::memory_order_relaxed);
+			_current.store(_indexes.back().get(), std::memory_order_release);
+			return _indexes.back().get();
+		}
+
+#ifdef LUX_SIMD_X86
+		// lower_bound when Upper is false, upper_bound otherwise; a node of 16 keys is two vectors, its rank
+		// is the count of its keys on the left side of key. The descent is written for each instruction set,
+		// so that it is compiled for it and its compares are inlined
+		template< bool Upper, class Key >
+		LUX_TARGET("avx2") static size_t _avx2_descend(const _index& index, Key key) noexcept {
+			using isa = _impls::_avx2;
+			constexpr size_t keys = _node_keys<Key>;
+
+			size_t k = 0;
+			for (size_t level = index.depth - 1; level > 0; level--) {
+				const auto node = index.template keys<Key>(level) + k * keys;
+				k = k * (keys + 1) + isa::count<Upper>(node, key) + isa::count<Upper>(node + 8, key);
+			}
+			const auto leaf = index.template keys<Key>(0) + k * keys;
+			return k * keys + isa::count<Upper>(leaf, key) + isa::count<Upper>(leaf + 8, key);
+		}
+		// four vectors per node
+		template< bool Upper, class Key >
+		LUX_TARGET("sse4.2") static size_t _sse42_descend(const _index& index, Key key) noexcept {
+			using isa = _impls::_sse42;
+			constexpr size_t keys = _node_keys<Key>;
+
+			size_t k = 0;
+			for (size_t level = index.depth - 1; level > 0; level--) {
+				const auto node = index.template keys<Key>(level) + k * keys;
+				k = k * (keys + 1) + isa::count<Upper>(node, key) + isa::count<Upper>(node + 4, key)
+					+ isa::count<Upper>(node + 8, key) + isa::count<Upper>(node + 12, key);
+			}
+			const auto leaf = index.template keys<Key>(0) + k * keys;
+			return k * keys + isa::count<Upper>(leaf, key) + isa::count<Upper>(leaf + 4, key)
+				+ isa::count<Upper>(leaf + 8, key) + isa::count<Upper>(leaf + 12, key);
+		}
+#endif // LUX_SIMD_X86
+
+		template< bool Upper, class Key >
+		static size_t _dispatch(const _index& index, Key key) noexcept {
+#ifdef LUX_SIMD_X86
+			if (cpu().avx2)
+				return _avx2_descend<Upper>(index, key);
+			return _sse42_descend<Upper>(index, key);
+#else
+			return 0;
+#endif // LUX_SIMD_X86
+		}
+
+		// lower_bound when Upper is false, upper_bound otherwise
+		template< bool Upper, class Ty, class Key, class Comp, class Proj >
+		size_t _search(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj& proj) const {
+			auto before = [&](size_t pos) -> bool {
+				if constexpr (Upper)
+					return !comp(key, proj(first[pos]));
+				else
+					return comp(proj(first[pos]), key);
+			};
+			auto fallback = [&]() -> size_t {
+				if constexpr (Upper)
+					return _fallback.upper_bound(first, count, key, comp, proj);
+				else
+					return _fallback.lower_bound(first, count, key, comp, proj);
+			};
+
+			// the upper bound of a key not less than the padding would count the padding
+			if (!_vectorized() || (Upper && !(key < _padding<Key>())))
+				return fallback();
+			const auto index = _ready<Key>(first, count, proj);
+			if (!index)
+				return fallback();
+
+			const auto res = _dispatch<Upper>(*index, key);
+			if constexpr (requires { proj.read(index->depth); })
+				proj.read(index->depth);
+			// the index may be stale, its result is checked against the array
+			if ((res == 0 || before(res - 1)) && (res == count || !before(res)))
+				return res;
+			return fallback();
+		}
+
+	public:
+		template< class Ty, class Key, class Comp, class Proj = std::identity >
+		constexpr size_t lower_bound(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj proj = {}) const {
+			if constexpr (_use_index<Ty, Key, Comp, Proj>()) {
+				if (!std::is_constant_evaluated())
+					return _search<false>(first, count, key, comp, proj);
+			}
+			return _fallback.lower_bound(first, count, key, comp, proj);
+		}
+
+		template< class Ty, class Key, class Comp, class Proj = std::identity >
+		constexpr size_t upper_bound(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj proj = {}) const {
+			if constexpr (_use_index<Ty, Key, Comp, Proj>()) {
+				if (!std::is_constant_evaluated())
+					return _search<true>(first, count, key, comp, proj);
+			}
+			return _fallback.upper_bound(first, count, key, comp, proj);
+		}
+
+	private:
+		LUX_NO_UNIQUE_ADDRESS Fallback _fallback;
+
+		mutable std::vector<std::unique_ptr<_index>> _indexes;
+		mutable std::atomic<const _index*> _current = nullptr;
+		mutable std::atomic<size_t> _lookups = 0;
+		mutable std::mutex _building;
+	};
+
+	// once built the index was measured 1.1 to 1.9 times faster than branchless_search on sets and maps of 32 bit keys,
+	// from 512 entries up; the other keys and the arrays that change between lookups go to branchless_search
+	using default_search = simd_index_search<branchless_search>;
+
+	/**
+	 * @brief Interpolation search for near-uniform arithmetic keys ordered by std::less
+	 *
+	 * The position of the key is estimated from the values at the range ends, which takes O(log log n) probes
+	 * on uniform data. A lookup that runs out of its probe budget counts as skewed; when too many lookups of a
+	 * window are skewed the policy switches to exponential search around the first estimate, and it goes back
+	 * to plain interpolation after a while to measure again. The final narrow range is searched with Fallback.
+	 * Only a sample of the lookups of each thread updates the shared statistic, so concurrent readers do not
+	 * keep writing to the same cache line.
+	*/
+	template< class Fallback = branchless_search >
+	class interpolation_search
+	{
+	public:
+		constexpr ~interpolation_search() = default;
+		constexpr interpolation_search() = default;
+
+		interpolation_search(const interpolation_search& other)
+			: _fallback(other._fallback) {
+		}
+		interpolation_search& operator=(const interpolation_search& other) {
+			_fallback = other._fallback;
+			return *this;
+		}
+
+		/**
+		 * @brief True when the keys looked skewed and the exponential strategy is in use
+		*/
+		bool skewed() const noexcept {
+			return _exponential.load(std::memory_order_relaxed);
+		}
+
+	private:
+		// one lookup in this many of each thread is recorded, the others write nothing shared
+		static constexpr uint32_t _sample = 16;
+		// recorded lookups of a statistic window
+		static constexpr uint32_t _window = 64;
+		// skewed lookups of a window that switch to the exponential strategy
+		static constexpr uint32_t _skew_limit = 16;
+		// recorded lookups with the exponential strategy before interpolation is measured again
+		static constexpr uint32_t _retry = 64;
+		// ranges this short are left to the fallback
+		static constexpr size_t _short_range = 16;
+
+		template< class Ty, class Key, class Comp, class Proj >
+		static constexpr bool _use_interpolation() noexcept {
+			using proj_key = std::remove_cvref_t<std::invoke_result_t<Proj&, const Ty&>>;
+			return std::is_same_v<proj_key, Key>
+				&& std::is_arithmetic_v<Key> && !std::is_same_v<Key, bool>
+				&& (std::is_same_v<Comp, std::less<Key>> || std::is_same_v<Comp, std::less<>>);
+		}
+
+		// estimated position of key inside [lo, hi], the values at the ends are low and high
+		template< class Key >
+		static size_t _estimate(size_t lo, size_t hi, const Key& low, const Key& high, const Key& key) noexcept {
+			const auto span = static_cast<double>(high) - static_cast<double>(low);
+			if (!(span > 0))
+				return lo;
+
+			const auto off = (static_cast<double>(key) - static_cast<double>(low)) / span * static_cast<double>(hi - lo);
+			if (!(off > 0))
+				return lo;
+			if (off >= static_cast<double>(hi - lo))
+				return hi;
+			return lo + static_cast<size_t>(off);
+		}
+
+		// true for the lookups that are recorded, the tick is per thread so that it is not shared either
+		static bool _sampled() noexcept {
+			static thread_local uint32_t tick = 0;
+			return ++tick % _sample == 0;
+		}
+
+		void _record(bool skewed) const noexcept {
+			if (!_sampled())
+				return;
+
+			auto lookups = _lookups.fetch_add(1, std::memory_order_relaxed) + 1;
+			if (skewed)
+				_skewed.fetch_add(1, std::memory_order_relaxed);
+
+			if (_exponential.load(std::memory_order_relaxed)) {
+				if (lookups >= _retry) {
+					_exponential.store(false, std::memory_order_relaxed);
+					_lookups.store(0, std::memory_order_relaxed), _skewed.store(0, std::memory_order_relaxed);
+				}
+			}
+			else if (lookups >= _window) {
+				_exponential.store(_skewed.load(std::memory_order_relaxed) >= _skew_limit, std::memory_order_relaxed);
+				_lookups.store(0, std::memory_order_relaxed), _skewed.store(0, std::memory_order_relaxed);
+			}
+		}
+
+		// lower_bound when Upper is false, upper_bound otherwise
+		template< bool Upper, class Ty, class Key, class Comp, class Proj >
+		size_t _search(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj& proj) const {
+			// true for the entries on the left side of the result
+			auto before = [&](const Ty& el) -> bool {
+				if constexpr (Upper)
+					return !comp(key, proj(el));
+				else
+					return comp(proj(el), key);
+			};
+			auto finish = [&](size_t lo, size_t hi) -> size_t {
+				if constexpr (Upper)
+					return lo + _fallback.upper_bound(first + lo, hi - lo, key, comp, proj);
+				else
+					return lo + _fallback.lower_bound(first + lo, hi - lo, key, comp, proj);
+			};
+
+			if (count <= _short_range)
+				return finish(0, count);
+			if (!before(first[0]))
+				return 0;
+			if (before(first[count - 1]))
+				return count;
+
+			if (_exponential.load(std::memory_order_relaxed)) {
+				_record(false);
+
+				auto guess = _estimate(0, count - 1, proj(first[0]), proj(first[count - 1]), key);
+				size_t bound = 1;
+				if (before(first[guess])) {
+					// the result is on the right of guess
+					auto lo = guess + 1;
+					while (lo + bound <= count && before(first[lo + bound - 1]))
+						lo += bound, bound *= 2;
+					return finish(lo, std::min(lo + bound - 1, count));
+				}
+				else {
+					// the result is guess or on its left
+					auto hi = guess;
+					while (hi >= bound && !before(first[hi - bound]))
+						hi -= bound, bound *= 2;
+					return finish(hi >= bound ? hi - bound + 1 : 0, hi);
+				}
+			}
+
+			// before(first[lo - 1]) and !before(first[hi]) hold at every step
+			size_t lo = 1, hi = count - 1;
+			size_t budget = std::bit_width(std::bit_width(count)) + 2;
+			while (hi - lo > _short_range && budget > 0) {
+				--budget;
+				auto pos = _estimate(lo, hi - 1, proj(first[lo - 1]), proj(first[hi]), key);
+				if (before(first[pos]))
+					lo = pos + 1;
+				else
+					hi = pos;
+			}
+
+			_record(budget == 0);
+			return finish(lo, hi);
+		}
+
+	public:
+		template< class Ty, class Key, class Comp, class Proj = std::identity >
+		constexpr size_t lower_bound(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj proj = {}) const {
+			if constexpr (_use_interpolation<Ty, Key, Comp, Proj>()) {
+				if (!std::is_constant_evaluated())
+					return _search<false>(first, count, key, comp, proj);
+			}
+			return _fallback.lower_bound(first, count, key, comp, proj);
+		}
+
+		template< class Ty, class Key, class Comp, class Proj = std::identity >
+		constexpr size_t upper_bound(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj proj = {}) const {
+			if constexpr (_use_interpolation<Ty, Key, Comp, Proj>()) {
+				if (!std::is_constant_evaluated())
+					return _search<true>(first, count, key, comp, proj);
+			}
+			return _fallback.upper_bound(first, count, key, comp, proj);
+		}
+
+	private:
+		LUX_NO_UNIQUE_ADDRESS Fallback _fallback;
+
+		mutable std::atomic<uint32_t> _lookups = 0;
+		mutable std::atomic<uint32_t> _skewed = 0;
+		mutable std::atomic<bool> _exponential = false;
+	};
+
+	/**
+	 * @brief Learned index for large static tables of arithmetic keys ordered by std::less
+	 *
+	 * A piecewise linear model of the key -> position function, built in one pass: every segment predicts
+	 * the position of its keys within Epsilon, so a lookup searches the segment start keys, then only a
+	 * window of 2 * Epsilon entries with Fallback. The windows are checked against the array and widened
+	 * if needed, which keeps the results exact even if the model is stale.
+	 *
+	 * The model is trained lazily, once the lookups since the last change would have paid for it;
+	 * the containers call invalidate() when their keys change. It belongs to the whole array of its container:
+	 * the searches of subranges (galloping, hints, pages) go to window(), and a lookup over another array
+	 * trains a new model once it has paid for it.
+	*/
+	template< size_t Epsilon = 32, class Fallback = branchless_search >
+	class learned_search
+	{
+	public:
+		static constexpr size_t epsilon = Epsilon;
+
+		~learned_search() = default;
+		learned_search() = default;
+
+		// the model belongs to the array of the source, a copy trains again
+		learned_search(const learned_search& other)
+			: _fallback(other._fallback) {
+		}
+		learned_search& operator=(const learned_search& other) {
+			_fallback = other._fallback;
+			invalidate();
+			return *this;
+		}
+
+		/**
+		 * @brief Drop the model, the keys of the array have changed
+		 *
+		 * Called by the writer of the container, without concurrent lookups.
+		*/
+		void invalidate() noexcept {
+			_current.store(nullptr, std::memory_order_relaxed);
+			_models.clear();
+			_lookups.store(0, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief The policy for the subranges of the array, they must not train the model of the whole array
+		*/
+		constexpr const Fallback& window() const noexcept {
+			return _fallback;
+		}
+
+		bool trained() const noexcept {
+			return _current.load(std::memory_order_acquire) != nullptr;
+		}
+		size_t segments() const noexcept {
+			const auto model = _current.load(std::memory_order_acquire);
+			return model ? model->segments.size() : 0;
+		}
+		/**
+		 * @brief Number of entries of the array the model was trained on, 0 without a model
+		*/
+		size_t model_size() const noexcept {
+			const auto model = _current.load(std::memory_order_acquire);
+			return model ? model->count : 0;
+		}
+
+	private:
+		// arrays this short are left to the fallback
+		static constexpr size_t _min_count = 256;
+		// the model is trained after count / _amortize lookups since the last change
+		static constexpr size_t _amortize = 32;
+		// models trained without a change of the keys, the array keeps moving past this many
+		static constexpr size_t _max_models = 4;
+
+		struct _segment
+		{
+			double slope;
+			size_t pos;
+		};
+
+		// a published model is immutable, the lookups read it without a lock
+		struct _model
+		{
+			std::vector<_segment> segments;
+			std::vector<double> starts;
+			const void* first = nullptr;
+			size_t count = 0;
+		};
+
+		template< class Ty, class Key, class Comp, class Proj >
+		static constexpr bool _use_model() noexcept {
+			using proj_key = std::remove_cvref_t<std::invoke_result_t<Proj&, const Ty&>>;
+			return std::is_same_v<proj_key, Key>
+				&& std::is_arithmetic_v<Key> && !std::is_same_v<Key, bool>
+				&& (std::is_same_v<Comp, std::less<Key>> || std::is_same_v<Comp, std::less<>>);
+		}
+
+		// key - base without overflow, key >= base
+		template< class Key >
+		static double _distance(const Key& key, const Key& base) noexcept {
+			if constexpr (std::is_integral_v<Key>) {
+				using unsigned_key = std::make_unsigned_t<Key>;
+				return static_cast<double>(static_cast<unsigned_key>(static_cast<unsigned_key>(key) - static_cast<unsigned_key>(base)));
+			}
+			else
+				return static_cast<double>(key) - static_cast<double>(base);
+		}
+
+		// shrinking cone: a segment grows while one slope keeps every point within epsilon
+		template< class Ty, class Proj >
+		static void _train(_model& model, const Ty* first, size_t count, Proj& proj) {
+			using key_type = std::remove_cvref_t<std::invoke_result_t<Proj&, const Ty&>>;
+			constexpr auto eps = static_cast<double>(Epsilon);
+
+			size_t base = 0;
+			double low = 0, high = std::numeric_limits<double>::infinity();
+			auto close = [&]() {
+				const double slope = std::isinf(high) ? 0 : (low + high) / 2;
+				model.segments.push_back({ slope, base });
+				model.starts.push_back(static_cast<double>(proj(first[base])));
+			};
+
+			for (size_t i = 1; i < count; i++) {
+				const key_type& base_key = proj(first[base]);
+				const key_type& key = proj(first[i]);
+				// the equal keys share the position of the first one
+				if (!(proj(first[i - 1]) < key))
+					continue;
+
+				const auto dx = _distance(key, base_key);
+				const auto dy = static_cast<double>(i - base);
+				const auto lo = std::max(low, (dy - eps) / dx), hi = std::min(high, (dy + eps) / dx);
+				if (lo <= hi)
+					low = lo, high = hi;
+				else {
+					close();
+					base = i, low = 0, high = std::numeric_limits<double>::infinity();
+				}
+			}
+			close();
+
+			model.first = first, model.count = count;
+		}
+
+		// lower_bound when Upper is false, upper_bound otherwise
+		template< bool Upper, class Ty, class Key, class Comp, class Proj >
+		size_t _search(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj& proj) const {
+			auto before = [&](size_t pos) -> bool {
+				if constexpr (Upper)
+					return !comp(key, proj(first[pos]));
+				else
+					return comp(proj(first[pos]), key);
+			};
+			auto finish = [&](size_t lo, size_t hi) -> size_t {
+				if constexpr (Upper)
+					return lo + _fallback.upper_bound(first + lo, hi - lo, key, comp, proj);
+				else
+					return lo + _fallback.lower_bound(first + lo, hi - lo, key, comp, proj);
+			};
+
+			const auto model = _ready(first, count, proj);
+			if (!model)
+				return finish(0, count);
+
+			const auto& starts = model->starts;
+			const auto ub = _fallback.upper_bound(starts.data(), starts.size(), static_cast<double>(key), std::less<double>());
+			const auto& seg = model->segments[ub > 0 ? ub - 1 : 0];
+			const auto& base_key = proj(first[seg.pos]);
+
+			size_t guess = seg.pos;
+			if (base_key < key) {
+				const auto off = seg.slope * _distance(key, base_key);
+				guess = off >= static_cast<double>(count - seg.pos) ? count : seg.pos + static_cast<size_t>(off);
+			}
+
+			// the result lies in [lo, hi] once before(lo - 1) and !before(hi) hold
+			size_t lo = guess > Epsilon ? guess - Epsilon : 0;
+			size_t hi = std::min(count, guess + Epsilon + 1);
+			for (size_t step = Epsilon + 1; lo > 0 && !before(lo - 1); step *= 2)
+				hi = lo, lo = lo > step ? lo - step : 0;
+			for (size_t step = Epsilon + 1; hi < count && before(hi); step *= 2)
+				lo = hi + 1, hi = std::min(count, hi + step);
+
+			return finish(lo, hi);
+		}
+
+		static bool _matches(const _model* model, const void* first, size_t count) noexcept {
+			return model && model->first == first && model->count == count;
+		}
+
+		// the model of the array, trained when the lookups since the last change have paid for it
+		template< class Ty, class Proj >
+		const _model* _ready(const Ty* first, size_t count, Proj& proj) const {
+			const auto model = _current.load(std::memory_order_acquire);
+			if (_matches(model, first, count))
+				return model;
+			if (count < _min_count || _lookups.fetch_add(1, std::memory_order_relaxed) < count / _amortize)
+				return nullptr;
+
+			std::lock_guard lock(_training);
+			if (const auto current = _current.load(std::memory_order_relaxed); _matches(current, first, count))
+				return current;
+			// the replaced models stay alive for the concurrent lookups until the next invalidate()
+			if (_models.size() >= _max_models)
+				return nullptr;
+
+			// the lookups are noexcept, without memory they go on without the model
+			try {
+				_models.reserve(_max_models);
+				auto trained = std::make_unique<_model>();
+				_train(*trained, first, count, proj);
+				_models.push_back(std::move(trained));
+			}
+			catch (const std::bad_alloc&) {
+				_lookups.store(0, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			_lookups.store(0, std::memory_order_relaxed);
+			_current.store(_models.back().get(), std::memory_order_release);
+			return _models.back().get();
+		}
+
+	public:
+		template< class Ty, class Key, class Comp, class Proj = std::identity >
+		constexpr size_t lower_bound(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj proj = {}) const {
+			if constexpr (_use_model<Ty, Key, Comp, Proj>()) {
+				if (!std::is_constant_evaluated())
+					return _search<false>(first, count, key, comp, proj);
+			}
+			return _fallback.lower_bound(first, count, key, comp, proj);
+		}
+
+		template< class Ty, class Key, class Comp, class Proj = std::identity >
+		constexpr size_t upper_bound(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj proj = {}) const {
+			if constexpr (_use_model<Ty, Key, Comp, Proj>()) {
+				if (!std::is_constant_evaluated())
+					return _search<true>(first, count, key, comp, proj);
+			}
+			return _fallback.upper_bound(first, count, key, comp, proj);
+		}
+
+	private:
+		LUX_NO_UNIQUE_ADDRESS Fallback _fallback;
+
+		mutable std::vector<std::unique_ptr<_model>> _models;
+		mutable std::atomic<const _model*> _current = nullptr;
+		mutable std::atomic<size_t> _lookups = 0;
+		mutable std::mutex _training;
+	};
+
+	/**
+	 * @brief Search policy with a blocked Bloom filter that rejects the missing keys of find, contains and count
+	 *
+	 * Every key sets one bit in each of the 8 words of a 64 byte block, so a miss is rejected after reading a single
+	 * cache line, with about 1% of false positives at 10 bits per key. The bounds are searched by Fallback.
+	 * The filter is built lazily like the learned_search model; the new keys are added to it as they are inserted,
+	 * the other changes drop it. Used with std::less over keys that std::hash supports, every other lookup passes.
+	*/
+	template< size_t BitsPerKey = 10, class Fallback = default_search >
+	class bloom_search
+	{
+		static_assert(BitsPerKey > 0, "lux::bloom_search needs at least one bit per key");
+
+	public:
+		static constexpr size_t bits_per_key = BitsPerKey;
+
+		~bloom_search() = default;
+		bloom_search() = default;
+
+		// the filter belongs to the keys of the source, a copy builds its own
+		bloom_search(const bloom_search& other)
+			: _fallback(other._fallback) {
+		}
+		bloom_search& operator=(const bloom_search& other) {
+			_fallback = other._fallback;
+			invalidate();
+			return *this;
+		}
+
+		/**
+		 * @brief Drop the filter, the keys of the array have changed
+		*/
+		void invalidate() noexcept {
+			_built.store(false, std::memory_order_relaxed);
+			_lookups.store(0, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Add a new key to the filter, the filter is dropped once it holds more keys than it was sized for
+		*/
+		template< class Key >
+		void on_insert(const Key& key) {
+			if constexpr (_hashable<Key>) {
+				if (!_built.load(std::memory_order_relaxed))
+					return;
+				if (_keys >= _capacity)
+					invalidate();
+				else
+					_add(_blocks, _hash(key)), _keys++;
+			}
+			else
+				invalidate();
+		}
+
+		bool built() const noexcept {
+			return _built.load(std::memory_order_acquire);
+		}
+
+		/**
+		 * @brief Bytes used by the filter
+		*/
+		size_t memory_usage() const noexcept {
+			return _blocks.capacity() * sizeof(_block);
+		}
+
+		/**
+		 * @brief Expected rate of false positives for the keys the filter holds, 1 without a filter
+		*/
+		double false_positive_rate() const noexcept {
+			if (!built())
+				return 1;
+
+			// the keys of a block follow a Poisson law, a miss passes if it finds its bit set in all 8 words
+			const auto lambda = static_cast<double>(_keys) / static_cast<double>(_blocks.size());
+			const auto last = static_cast<size_t>(lambda + 10 * std::sqrt(lambda) + 20);
+			double res = 0, p = std::exp(-lambda);
+			for (size_t k = 0; k <= last; k++) {
+				res += p * std::pow(1 - std::pow(63.0 / 64.0, static_cast<double>(k)), 8);
+				p *= lambda / static_cast<double>(k + 1);
+			}
+			return res;
+		}
+
+	private:
+		// arrays this short are left to the search
+		static constexpr size_t _min_count = 256;
+		// the filter is built after count / _amortize lookups since the last change
+		static constexpr size_t _amortize = 32;
+
+		struct alignas(64) _block
+		{
+			uint64_t words[8];
+		};
+
+		template< class Key >
+		static constexpr bool _hashable = requires(const Key& key) { { std::hash<Key>()(key) } -> std::convertible_to<size_t>; };
+
+		template< class Ty, class Key, class Comp, class Proj >
+		static constexpr bool _use_filter() noexcept {
+			using proj_key = std::remove_cvref_t<std::invoke_result_t<Proj&, const Ty&>>;
+			return std::is_same_v<proj_key, Key> && _hashable<Key>
+				&& (std::is_same_v<Comp, std::less<Key>> || std::is_same_v<Comp, std::less<>>);
+		}
+
+		template< class Key >
+		static uint64_t _hash(const Key& key) noexcept {
+			return mix64(static_cast<uint64_t>(std::hash<Key>()(key)));
+		}
+
+		// the high half of the hash picks the block, the low half times an odd salt picks the bit of each word
+		static constexpr uint32_t _salts[8] = {
+			0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du, 0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u
+		};
+
+		static void _add(std::vector<_block>& blocks, uint64_t h) noexcept {
+			auto& block = blocks[static_cast<size_t>(((h >> 32) * blocks.size()) >> 32)];
+			for (size_t i = 0; i < 8; i++)
+				block.words[i] |= uint64_t(1) << ((static_cast<uint32_t>(h) * _salts[i]) >> 26);
+		}
+		bool _test(uint64_t h) const noexcept {
+			const auto& block = _blocks[static_cast<size_t>(((h >> 32) * _blocks.size()) >> 32)];
+			for (size_t i = 0; i < 8; i++) {
+				if ((block.words[i] & (uint64_t(1) << ((static_cast<uint32_t>(h) * _salts[i]) >> 26))) == 0)
+					return false;
+			}
+			return true;
+		}
+
+		template< class Ty, class Proj >
+		void _build(const Ty* first, size_t count, Proj& proj) const {
+			// a quarter of room for the keys inserted later
+			_capacity = count + count / 4;
+			const auto blocks = std::max<size_t>(1, (_capacity * BitsPerKey + 511) / 512);
+			_blocks.assign(blocks, _block{});
+			for (size_t i = 0; i < count; i++)
+				_add(_blocks, _hash(proj(first[i])));
+			_keys = count;
+		}
+
+		// true if the filter holds exactly the keys of the array, builds it when the lookups have paid for it
+		template< class Ty, class Proj >
+		bool _ready(const Ty* first, size_t count, Proj& proj) const {
+			if (_built.load(std::memory_order_acquire))
+				return _keys == count;
+			if (count < _min_count || _lookups.fetch_add(1, std::memory_order_relaxed) < count / _amortize)
+				return false;
+
+			std::lock_guard lock(_building);
+			if (!_built.load(std::memory_order_relaxed)) {
+				// the lookups are noexcept, without memory they go on without the filter
+				try {
+					_build(first, count, proj);
+				}
+				catch (const std::bad_alloc&) {
+					_lookups.store(0, std::memory_order_relaxed);
+					return false;
+				}
+				_built.store(true, std::memory_order_release);
+			}
+			return _keys == count;
+		}
+
+	public:
+		/**
+		 * @brief False if key is certainly not in the array, true if it may be
+		*/
+		template< class Ty, class Key, class Comp, class Proj = std::identity >
+		bool may_contain(const Ty* first, size_t count, const Key& key, const Comp&, Proj proj = {}) const {
+			if constexpr (_use_filter<Ty, Key, Comp, Proj>()) {
+				if (_ready(first, count, proj))
+					return _test(_hash(key));
+			}
+			return true;
+		}
+
+		template< class Ty, class Key, class Comp, class Proj = std::identity >
+		constexpr size_t lower_bound(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj proj = {}) const {
+			return _fallback.lower_bound(first, count, key, comp, proj);
+		}
+
+		template< class Ty, class Key, class Comp, class Proj = std::identity >
+		constexpr size_t upper_bound(const Ty* first, size_t count, const Key& key, const Comp& comp, Proj proj = {}) const {
+			return _fallback.upper_bound(first, count, key, comp, proj);
+		}
+
+	private:
+		LUX_NO_UNIQUE_ADDRESS Fallback _fallback;
+
+		mutable std::vector<_block> _blocks;
+		mutable size_t _keys = 0;
+		mutable size_t _capacity = 0;
+
+		mutable std::atomic<bool> _built = false;
+		mutable std::atomic<size_t> _lookups = 0;
+		mutable std::mutex _building;
+	};
+	namespace _impls
+	{
+
+		// a policy that answers membership for the whole array it was built from
+		template< class Search >
+		inline constexpr bool _is_membership_filter = false;
+		template< size_t BitsPerKey, class Fallback >
+		inline constexpr bool _is_membership_filter<bloom_search<BitsPerKey, Fallback>> = true;
+
+		// the policy for the subranges of an array, a policy with state about the whole array hands out its fallback
+		template< class Search >
+		constexpr const auto& _window_search(const Search& search) noexcept {
+			if constexpr (requires { search.window(); })
+				return search.window();
+			else
+				return search;
+		}
+
+		// a stateful search policy drops what it derived from the keys of its container
+		template< class Search >
+		constexpr void _search_keys_changed(Search& search) noexcept {
+			if constexpr (requires { search.invalidate(); })
+				search.invalidate();
+		}
+		// a single new key, a policy that can absorb it keeps its state
+		template< class Search, class Key >
+		constexpr void _search_key_inserted(Search& search, const Key& key) {
+			if constexpr (requires { search.on_insert(key); })
+				search.on_insert(key);
+			else
+				_search_keys_changed(search);
+		}
+
+		// false if a search policy with a membership filter proves that key is not in the array
+		template< class Search, class Ty, class Key, class Comp, class Proj >
+		constexpr bool _search_may_contain(const Search& search, const Ty* first, size_t count, const Key& key, const Comp& comp, Proj proj) {
+			if constexpr (requires { search.may_contain(first, count, key, comp, proj); })
+				return search.may_contain(first, count, key, comp, proj);
+			else
+				return true;
+		}
+
+		// lower_bound of n keys given by key_of(i), out(i, pos) receives the bounds in any order;
+		// a policy without a batched search runs its searches one after the other
+		template< class Search, class Ty, class KeyOf, class Comp, class Out, class Proj >
+		constexpr void _search_lower_bound_many(const Search& search, const Ty* first, size_t count, size_t n, KeyOf key_of, const Comp& comp, Out out, Proj proj) {
+			if constexpr (requires { search.lower_bound_many(first, count, n, key_of, comp, out, proj); })
+				search.lower_bound_many(first, count, n, key_of, comp, out, proj);
+			else {
+				for (size_t i = 0; i < n; i++)
+					out(i, search.lower_bound(first, count, key_of(i), comp, proj));
+			}
+		}
+
+		// lower bound of key in [from, count), the window is found by doubling steps from from and searched by search,
+		// so a walk over sorted keys costs O(log gap) per key
+		template< class Ty, class Key, class Comp, class Proj, class Search >
+		constexpr size_t _gallop_lower_bound(const Ty* first, size_t count, size_t from, const Key& key, const Comp& comp, Proj proj, const Search& search) {
+			if (from >= count || !comp(proj(first[from]), key))
+				return from;
+
+			size_t lo = from + 1, bound = 1;
+			while (lo + bound <= count && comp(proj(first[lo + bound - 1]), key))
+				lo += bound, bound *= 2;
+			const auto hi = std::min(lo + bound - 1, count);
+			return lo + _window_search(search).lower_bound(first + lo, hi - lo, key, comp, proj);
+		}
+
+	}
+
+}
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <lux/base_core.h>
+
+#include <lux/sorted_vector.h>
+#include <lux/sorted_algorithm.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace lux
+{
+
+	/**
+	 * @brief Ordered container shared by many writer threads
+	 *
+	 * The keys are spread by hash over independently locked sorted_vector shards, the point operations
+	 * lock a single shard: shared for the lookups, exclusive for the modifiers. Since no reference can outlive
+	 * the lock, the lookups return copies. The ordered traversal goes through ordered(), a merge of all the shards.
+	*/
+	template<
+		class Key, class Value = void,
+		class Compare = std::less<Key>,
+		class Hash = std::hash<Key>,
+		class Alloc = std::allocator<sorted_vector_type<Key, Value>>,
+		class Search = lux::default_search
+	>
+	class sharded_sorted_vector
+	{
+	public:
+		using shard_type				= sorted_vector<Key, Value, Compare, Alloc, Search>;
+		using key_type					= Key;
+		using mapped_type				= Value;
+		using value_type				= shard_type::value_type;
+		using key_compare				= Compare;
+		using hasher					= Hash;
+		using is_mapped					= shard_type::is_mapped;
+		using size_type					= shard_type::size_type;
+
+		static constexpr size_type default_shard_count = 16;
+
+	private:
+		struct alignas(64) _shard
+		{
+			mutable std::shared_mutex mutex;
+			shard_type data;
+		};
+
+		using _shared_lock = std::shared_lock<std::shared_mutex>;
+		using _unique_lock = std::unique_lock<std::shared_mutex>;
+
+	public:
+		/**
+		 * @brief Every shard locked for reading and the merge of their entries in key order
+		 *
+		 * The writers are blocked while the view lives, the traversal is single pass.
+		*/
+		class ordered_view
+		{
+			friend class sharded_sorted_vector;
+
+		public:
+			class iterator
+			{
+				friend class ordered_view;
+
+			public:
+				using iterator_concept	= std::input_iterator_tag;
+				using value_type		= sharded_sorted_vector::value_type;
+				using difference_type	= ptrdiff_t;
+				using reference			= const value_type&;
+				using pointer			= const value_type*;
+
+				iterator() = default;
+
+				reference operator*() const {
+					return _view->_tree.top();
+				}
+				pointer operator->() const {
+					return &_view->_tree.top();
+				}
+
+				iterator& operator++() {
+					_view->_tree.pop();
+					return *this;
+				}
+				void operator++(int) {
+					++*this;
+				}
+
+				friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept {
+					return it._done();
+				}
+
+			private:
+				bool _done() const noexcept {
+					return _view->_tree.empty();
+				}
+
+				explicit iterator(ordered_view* view) noexcept
+					: _view(view) {
+				}
+
+				ordered_view* _view = nullptr;
+			};
+
+			ordered_view(const ordered_view&) = delete;
+			ordered_view& operator=(const ordered_view&) = delete;
+
+			iterator begin() noexcept {
+				return iterator(this);
+			}
+			std::default_sentinel_t end() const noexcept {
+				return std::default_sentinel;
+			}
+
+			/**
+			 * @brief Total number of entries, stable while the view lives
+			*/
+			size_type size() const noexcept {
+				return _size;
+			}
+
+		private:
+			ordered_view(std::vector<_shared_lock> locks, std::vector<const shard_type*> shards, size_type size)
+				: _locks(std::move(locks)), _size(size), _tree(std::move(shards)) {
+			}
+
+			std::vector<_shared_lock> _locks;
+			size_type _size;
+			_impls::_loser_tree<shard_type> _tree;
+		};
+
+		~sharded_sorted_vector() = default;
+
+		explicit sharded_sorted_vector(size_type shard_count = default_shard_count, const key_compare& comp = key_compare(), const hasher& hash = hasher())
+			: _shards(), _count(shard_count), _comp(comp), _hash(hash) {
+			if (shard_count == 0)
+				throw std::invalid_argument("lux::sharded_sorted_vector needs at least one shard");
+
+			_shards = std::make_unique<_shard[]>(_count);
+			for (size_type i = 0; i < _count; i++)
+				_shards[i].data = shard_type(comp);
+		}
+
+		sharded_sorted_vector(const sharded_sorted_vector&) = delete;
+		sharded_sorted_vector& operator=(const sharded_sorted_vector&) = delete;
+
+		size_type shard_count() const noexcept {
+			return _count;
+		}
+		key_compare key_comp() const {
+			return _comp;
+		}
+
+		/**
+		 * @brief Sum of the shard sizes, each one read under its lock
+		*/
+		size_type size() const {
+			size_type res = 0;
+			for (size_type i = 0; i < _count; i++) {
+				_shared_lock lock(_shards[i].mutex);
+				res += _shards[i].data.size();
+			}
+			return res;
+		}
+		bool empty() const {
+			return size() == 0;
+		}
+
+		void clear() {
+			for (size_type i = 0; i < _count; i++) {
+				_unique_lock lock(_shards[i].mutex);
+				_shards[i].data.clear();
+			}
+		}
+
+	private:
+		_shard& _shard_of(const key_type& key) const {
+			// the hash is mixed, std::hash of an integer may be the identity
+			const auto h = static_cast<uint64_t>(_hash(key)) * 0x9e3779b97f4a7c15ull;
+			return _shards[static_cast<size_type>(h >> 32) % _count];
+		}
+
+		static const key_type& _key(const value_type& value) {
+			return value.key();
+		}
+
+	public:
+		template< class... Args >
+		bool emplace(Args&&... args) {
+			value_type val{ std::forward<Args>(args)... };
+			auto& shard = _shard_of(_key(val));
+			_unique_lock lock(shard.mutex);
+			return shard.data.emplace(std::move(val)).second;
+		}
+
+		bool insert(const value_type& value) {
+			return emplace(value);
+		}
+		bool insert(value_type&& value) {
+			return emplace(std::move(value));
+		}
+
+		template< class... Args >
+		bool try_emplace(const key_type& key, Args&&... args) requires is_mapped::value {
+			auto& shard = _shard_of(key);
+			_unique_lock lock(shard.mutex);
+			return shard.data.try_emplace(key, std::forward<Args>(args)...).second;
+		}
+
+		template< class M >
+		bool insert_or_assign(const key_type& key, M&& obj) requires is_mapped::value {
+			auto& shard = _shard_of(key);
+			_unique_lock lock(shard.mutex);
+			return shard.data.insert_or_assign(key, std::forward<M>(obj)).second;
+		}
+
+		size_type erase(const key_type& key) {
+			auto& shard = _shard_of(key);
+			_unique_lock lock(shard.mutex);
+			return shard.data.erase(key);
+		}
+
+		/**
+		 * @brief Call fn(entry) under the exclusive lock of the shard if the key is present, fn must not change the key
+		 * @return True if the key was found
+		*/
+		template< class Fn >
+		bool visit(const key_type& key, Fn&& fn) {
+			auto& shard = _shard_of(key);
+			_unique_lock lock(shard.mutex);
+			auto it = shard.data.find(key);
+			if (it == shard.data.end())
+				return false;
+			std::forward<Fn>(fn)(*it);
+			return true;
+		}
+
+		bool contains(const key_type& key) const {
+			auto& shard = _shard_of(key);
+			_shared_lock lock(shard.mutex);
+			return shard.data.contains(key);
+		}
+		size_type count(const key_type& key) const {
+			return contains(key) ? 1 : 0;
+		}
+
+		/**
+		 * @brief A copy of the entry, if present
+		*/
+		std::optional<value_type> find(const key_type& key) const {
+			auto& shard = _shard_of(key);
+			_shared_lock lock(shard.mutex);
+			auto it = shard.data.find(key);
+			if (it == shard.data.end())
+				return std::nullopt;
+			return *it;
+		}
+
+		mapped_type at(const key_type& key) const requires is_mapped::value {
+			auto& shard = _shard_of(key);
+			_shared_lock lock(shard.mutex);
+			auto it = shard.data.find(key);
+			if (it == shard.data.end())
+				throw std::out_of_range("invalid lux::sharded_sorted_vector<K, T> key");
+			return it->value();
+		}
+
+		/**
+		 * @brief Lock every shard for reading and merge them in key order
+		 *
+		 * The shards are locked in index order, the writers only ever hold one lock so they cannot deadlock with the view.
+		*/
+		ordered_view ordered() const {
+			std::vector<_shared_lock> locks;
+			std::vector<const shard_type*> shards;
+			size_type size = 0;
+			locks.reserve(_count), shards.reserve(_count);
+			for (size_type i = 0; i < _count; i++) {
+				locks.emplace_back(_shards[i].mutex);
+				shards.push_back(&_shards[i].data);
+				size += _shards[i].data.size();
+			}
+			return ordered_view(std::move(locks), std::move(shards), size);
+		}
+
+		/**
+		 * @brief A consistent copy of the whole content as a single sorted_vector
+		*/
+		shard_type snapshot() const {
+			auto view = ordered();
+			typename shard_type::vector_type res;
+			res.reserve(view.size());
+			for (auto& entry : view)
+				res.push_back(entry);
+			return shard_type(sorted_unique, std::move(res), _comp);
+		}
+
+	private:
+		std::unique_ptr<_shard[]> _shards;
+		size_type _count;
+		key_compare _comp;
+		hasher _hash;
+	};
+
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <lux/base_core.h>
+
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define LUX_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LUX_TARGET(isa) __attribute__((target(isa)))
+#else
+#define LUX_TARGET(isa)
+#endif
+
+namespace lux
+{
+
+	/**
+	 * @brief Instruction set extensions available on the running cpu
+	*/
+	struct cpu_features
+	{
+		bool sse42 = false;
+		bool avx2 = false;
+	};
+
+	namespace _impls
+	{
+
+		inline cpu_features _detect_cpu_features() noexcept {
+			cpu_features res;
+#if defined(LUX_SIMD_X86) && defined(_MSC_VER)
+			int regs[4];
+			__cpuid(regs, 0);
+			const int max_leaf = regs[0];
+
+			__cpuid(regs, 1);
+			res.sse42 = (regs[2] & (1 << 20)) != 0;
+			const bool osxsave = (regs[2] & (1 << 27)) != 0;
+			const bool avx = (regs[2] & (1 << 28)) != 0;
+
+			// the os must save the ymm registers too
+			if (max_leaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+				__cpuidex(regs, 7, 0);
+				res.avx2 = (regs[1] & (1 << 5)) != 0;
+			}
+#elif defined(LUX_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+			__builtin_cpu_init();
+			res.sse42 = __builtin_cpu_supports("sse4.2");
+			res.avx2 = __builtin_cpu_supports("avx2");
+#endif
+			return res;
+		}
+
+	}
+
+	/**
+	 * @brief Features of the running cpu, detected once
+	*/
+	inline const cpu_features& cpu() noexcept {
+		static const cpu_features features = _impls::_detect_cpu_features();
+		return features;
+	}
+
+	namespace _impls
+	{
+
+		enum class _simd_kind
+		{
+			none, i32, u32, i64, u64, f32, f64
+		};
+
+		template< class Ty >
+		constexpr _simd_kind _simd_kind_of() noexcept {
+			if constexpr (std::is_same_v<Ty, float>)
+				return _simd_kind::f32;
+			else if constexpr (std::is_same_v<Ty, double>)
+				return _simd_kind::f64;
+			else if constexpr (!std::is_integral_v<Ty> || std::is_same_v<Ty, bool>)
+				return _simd_kind::none;
+			else if constexpr (sizeof(Ty) == 4)
+				return std::is_signed_v<Ty> ? _simd_kind::i32 : _simd_kind::u32;
+			else if constexpr (sizeof(Ty) == 8)
+				return std::is_signed_v<Ty> ? _simd_kind::i64 : _simd_kind::u64;
+			else
+				return _simd_kind::none;
+		}
+
+		template< class Ty >
+		_INLINE_VAR constexpr bool _is_simd_key_v = _simd_kind_of<Ty>() != _simd_kind::none;
+
+#ifdef LUX_SIMD_X86
+
+		/*
+		*	Every kernel counts the lanes of v that are less (or less or equal) than key.
+		*	v is not required to be aligned.
+		*/
+
+		struct _sse42
+		{
+			template< class Ty >
+			static constexpr size_t lanes = 16 / sizeof(Ty);
+
+			template< bool Equal, class Ty >
+			LUX_TARGET("sse4.2") static unsigned count(const Ty* v, Ty key) noexcept {
+				constexpr auto kind = _simd_kind_of<Ty>();
+
+				if constexpr (kind == _simd_kind::f32) {
+					auto x = _mm_loadu_ps(v), k = _mm_set1_ps(key);
+					return std::popcount(unsigned(_mm_movemask_ps(Equal ? _mm_cmple_ps(x, k) : _mm_cmplt_ps(x, k))));
+				}
+				else if constexpr (kind == _simd_kind::f64) {
+					auto x = _mm_loadu_pd(v), k = _mm_set1_pd(key);
+					return std::popcount(unsigned(_mm_movemask_pd(Equal ? _mm_cmple_pd(x, k) : _mm_cmplt_pd(x, k))));
+				}
+				else if constexpr (kind == _simd_kind::i32 || kind == _simd_kind::u32) {
+					auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+					auto k = _mm_set1_epi32(static_cast<int>(key));
+					if constexpr (kind == _simd_kind::u32) {
+						// flip the sign bit to compare unsigned values as signed
+						auto sign = _mm_set1_epi32(INT32_MIN);
+						x = _mm_xor_si128(x, sign), k = _mm_xor_si128(k, sign);
+					}
+					// x <= k is !(x > k), x < k is k > x
+					auto mask = unsigned(_mm_movemask_ps(_mm_castsi128_ps(Equal ? _mm_cmpgt_epi32(x, k) : _mm_cmpgt_epi32(k, x))));
+					return Equal ? lanes<Ty> - std::popcount(mask) : std::popcount(mask);
+				}
+				else {
+					auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+					auto k = _mm_set1_epi64x(static_cast<long long>(key));
+					if constexpr (kind == _simd_kind::u64) {
+						auto sign = _mm_set1_epi64x(INT64_MIN);
+						x = _mm_xor_si128(x, sign), k = _mm_xor_si128(k, sign);
+					}
+					auto mask = unsigned(_mm_movemask_pd(_mm_castsi128_pd(Equal ? _mm_cmpgt_epi64(x, k) : _mm_cmpgt_epi64(k, x))));
+					return Equal ? lanes<Ty> - std::popcount(mask) : std::popcount(mask);
+				}
+			}
+
+			// bit i is set when v[i] == key
+			template< class Ty >
+			LUX_TARGET("sse4.2") static unsigned equal_mask(const Ty* v, Ty key) noexcept {
+				constexpr auto kind = _simd_kind_of<Ty>();
+
+				if constexpr (kind == _simd_kind::f32)
+					return unsigned(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(v), _mm_set1_ps(key))));
+				else if constexpr (kind == _simd_kind::f64)
+					return unsigned(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(v), _mm_set1_pd(key))));
+				else if constexpr (kind == _simd_kind::i32 || kind == _simd_kind::u32) {
+					auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+					return unsigned(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, _mm_set1_epi32(static_cast<int>(key))))));
+				}
+				else {
+					auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+					return unsigned(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(x, _mm_set1_epi64x(static_cast<long long>(key))))));
+				}
+			}
+		};
+
+		struct _avx2
+		{
+			template< class Ty >
+			static constexpr size_t lanes = 32 / sizeof(Ty);
+
+			template< bool Equal, class Ty >
+			LUX_TARGET("avx2") static unsigned count(const Ty* v, Ty key) noexcept {
+				constexpr auto kind = _simd_kind_of<Ty>();
+
+				if constexpr (kind == _simd_kind::f32) {
+					auto x = _mm256_loadu_ps(v), k = _mm256_set1_ps(key);
+					return std::popcount(unsigned(_mm256_movemask_ps(_mm256_cmp_ps(x, k, Equal ? _CMP_LE_OQ : _CMP_LT_OQ))));
+				}
+				else if constexpr (kind == _simd_kind::f64) {
+					auto x = _mm256_loadu_pd(v), k = _mm256_set1_pd(key);
+					return std::popcount(unsigned(_mm256_movemask_pd(_mm256_cmp_pd(x, k, Equal ? _CMP_LE_OQ : _CMP_LT_OQ))));
+				}
+				else if constexpr (kind == _simd_kind::i32 || kind == _simd_kind::u32) {
+					auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v));
+					auto k = _mm256_set1_epi32(static_cast<int>(key));
+					if constexpr (kind == _simd_kind::u32) {
+						auto sign = _mm256_set1_epi32(INT32_MIN);
+						x = _mm256_xor_si256(x, sign), k = _mm256_xor_si256(k, sign);
+					}
+					auto mask = unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(Equal ? _mm256_cmpgt_epi32(x, k) : _mm256_cmpgt_epi32(k, x))));
+					return Equal ? lanes<Ty> - std::popcount(mask) : std::popcount(mask);
+				}
+				else {
+					auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v));
+					auto k = _mm256_set1_epi64x(static_cast<long long>(key));
+					if constexpr (kind == _simd_kind::u64) {
+						auto sign = _mm256_set1_epi64x(INT64_MIN);
+						x = _mm256_xor_si256(x, sign), k = _mm256_xor_si256(k, sign);
+					}
+					auto mask = unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(Equal ? _mm256_cmpgt_epi64(x, k) : _mm256_cmpgt_epi64(k, x))));
+					return Equal ? lanes<Ty> - std::popcount(mask) : std::popcount(mask);
+				}
+			}
+
+			template< class Ty >
+			LUX_TARGET("avx2") static unsigned equal_mask(const Ty* v, Ty key) noexcept {
+				constexpr auto kind = _simd_kind_of<Ty>();
+
+				if constexpr (kind == _simd_kind::f32)
+					return unsigned(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(v), _mm256_set1_ps(key), _CMP_EQ_OQ)));
+				else if constexpr (kind == _simd_kind::f64)
+					return unsigned(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(v), _mm256_set1_pd(key), _CMP_EQ_OQ)));
+				else if constexpr (kind == _simd_kind::i32 || kind == _simd_kind::u32) {
+					auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v));
+					return unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, _mm256_set1_epi32(static_cast<int>(key))))));
+				}
+				else {
+					auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v));
+					return unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x, _mm256_set1_epi64x(static_cast<long long>(key))))));
+				}
+			}
+		};
+
+		template< class Isa, class Ty >
+		size_t _simd_find_equal(const Ty* first, size_t count, Ty key) noexcept {
+			constexpr size_t lanes = Isa::template lanes<Ty>;
+
+			size_t i = 0;
+			for (; i + lanes <= count; i += lanes) {
+				if (auto mask = Isa::equal_mask(first + i, key))
+					return i + std::countr_zero(mask);
+			}
+			for (; i < count; i++) {
+				if (first[i] == key)
+					return i;
+			}
+
+			return count;
+		}
+
+#endif // LUX_SIMD_X86
+
+		/**
+		 * @brief Position of the first element equal to key, count if there is none
+		*/
+		template< class Ty >
+		size_t _find_equal(const Ty* first, size_t count, Ty key) noexcept {
+#ifdef LUX_SIMD_X86
+			if constexpr (_is_simd_key_v<Ty>) {
+				if (cpu().avx2)
+					return _simd_find_equal<_avx2>(first, count, key);
+				if (cpu().sse42)
+					return _simd_find_equal<_sse42>(first, count, key);
+			}
+#endif // LUX_SIMD_X86
+			for (size_t i = 0; i < count; i++) {
+				if (first[i] == key)
+					return i;
+			}
+
+			return count;
+		}
+
+	}
+
+}
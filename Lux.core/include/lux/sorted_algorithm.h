@@ -0,0 +1,306 @@
+#pragma once
+
+#include <lux/base_core.h>
+
+#include <lux/sorted_vector.h>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace lux
+{
+
+	namespace _impls
+	{
+
+		template< class Ty >
+		struct _is_sorted_vector : std::false_type { };
+		template< class Key, class Value, class Compare, class Alloc, class Search, class Stats >
+		struct _is_sorted_vector<sorted_vector<Key, Value, Compare, Alloc, Search, Stats>> : std::true_type { };
+
+		template< class Ty >
+		_INLINE_VAR constexpr bool _is_sorted_vector_v = _is_sorted_vector<Ty>::value;
+
+		// the walks gallop when one side is this many times longer than the other
+		_INLINE_VAR constexpr size_t _gallop_ratio = 8;
+
+		// lower bound of key in [from, sv.size()) by galloping from from
+		template< class Sv >
+		size_t _gallop(const Sv& sv, size_t from, const typename Sv::key_type& key) {
+			auto proj = [](const typename Sv::value_type& val) -> const typename Sv::key_type& { return val.key(); };
+			return _gallop_lower_bound(sv.vector().data(), sv.size(), from, key, sv.key_comp(), proj, sv.search_policy());
+		}
+
+		/**
+		 * @brief Merge walk over two sorted_vectors
+		 *
+		 * only_left(first, last) and only_right(first, last) receive the runs of positions whose keys
+		 * are missing from the other side, both(i, j) the pairs of equal keys. The runs are found
+		 * one step at a time when the sizes are close, by galloping when they are unbalanced.
+		*/
+		template< class Sv, class OnlyLeft, class OnlyRight, class Both >
+		void _sorted_walk(const Sv& left, const Sv& right, OnlyLeft only_left, OnlyRight only_right, Both both) {
+			const auto n = left.size(), m = right.size();
+			const auto& ld = left.vector();
+			const auto& rd = right.vector();
+			const auto comp = left.key_comp();
+			const bool gallop = n > m * _gallop_ratio || m > n * _gallop_ratio;
+
+			size_t i = 0, j = 0;
+			while (i < n && j < m) {
+				if (comp(ld[i].key(), rd[j].key())) {
+					const auto next = gallop ? _gallop(left, i + 1, rd[j].key()) : i + 1;
+					only_left(i, next);
+					i = next;
+				}
+				else if (comp(rd[j].key(), ld[i].key())) {
+					const auto next = gallop ? _gallop(right, j + 1, ld[i].key()) : j + 1;
+					only_right(j, next);
+					j = next;
+				}
+				else
+					both(i++, j++);
+			}
+			if (i < n)
+				only_left(i, n);
+			if (j < m)
+				only_right(j, m);
+		}
+
+		template< class Sv >
+		Sv _adopt(const Sv& left, typename Sv::vector_type&& data) {
+			return Sv(sorted_unique, std::move(data), left.key_comp());
+		}
+
+	}
+
+	/*
+	*	Set algebra between sorted_vectors, every function is a single linear merge
+	*	that gallops over the longer side when the sizes are unbalanced.
+	*	On equal keys the entry of left is kept.
+	*/
+
+	template< class Sv > requires _impls::_is_sorted_vector_v<Sv>
+	Sv set_union(const Sv& left, const Sv& right) {
+		typename Sv::vector_type res(left.get_allocator());
+		res.reserve(left.size() + right.size());
+
+		const auto& ld = left.vector();
+		const auto& rd = right.vector();
+		_impls::_sorted_walk(left, right,
+			[&](size_t first, size_t last) { res.insert(res.end(), ld.begin() + first, ld.begin() + last); },
+			[&](size_t first, size_t last) { res.insert(res.end(), rd.begin() + first, rd.begin() + last); },
+			[&](size_t i, size_t) { res.push_back(ld[i]); });
+
+		return _impls::_adopt(left, std::move(res));
+	}
+
+	template< class Sv > requires _impls::_is_sorted_vector_v<Sv>
+	Sv set_intersection(const Sv& left, const Sv& right) {
+		typename Sv::vector_type res(left.get_allocator());
+		res.reserve(std::min(left.size(), right.size()));
+
+		const auto& ld = left.vector();
+		_impls::_sorted_walk(left, right,
+			[](size_t, size_t) { },
+			[](size_t, size_t) { },
+			[&](size_t i, size_t) { res.push_back(ld[i]); });
+
+		return _impls::_adopt(left, std::move(res));
+	}
+
+	template< class Sv > requires _impls::_is_sorted_vector_v<Sv>
+	Sv set_difference(const Sv& left, const Sv& right) {
+		typename Sv::vector_type res(left.get_allocator());
+		res.reserve(left.size());
+
+		const auto& ld = left.vector();
+		_impls::_sorted_walk(left, right,
+			[&](size_t first, size_t last) { res.insert(res.end(), ld.begin() + first, ld.begin() + last); },
+			[](size_t, size_t) { },
+			[](size_t, size_t) { });
+
+		return _impls::_adopt(left, std::move(res));
+	}
+
+	template< class Sv > requires _impls::_is_sorted_vector_v<Sv>
+	Sv set_symmetric_difference(const Sv& left, const Sv& right) {
+		typename Sv::vector_type res(left.get_allocator());
+		res.reserve(left.size() + right.size());
+
+		const auto& ld = left.vector();
+		const auto& rd = right.vector();
+		_impls::_sorted_walk(left, right,
+			[&](size_t first, size_t last) { res.insert(res.end(), ld.begin() + first, ld.begin() + last); },
+			[&](size_t first, size_t last) { res.insert(res.end(), rd.begin() + first, rd.begin() + last); },
+			[](size_t, size_t) { });
+
+		return _impls::_adopt(left, std::move(res));
+	}
+
+	/*
+	*	k-way merge
+	*/
+
+	/**
+	 * @brief Resolver of the k-way merge, keeps the entry of the first input
+	*/
+	struct first_wins
+	{
+		template< class Ty >
+		constexpr void operator()(Ty&, const Ty&) const noexcept {
+		}
+	};
+
+	/**
+	 * @brief Resolver of the k-way merge, keeps the entry of the last input
+	*/
+	struct last_wins
+	{
+		template< class Ty >
+		constexpr void operator()(Ty& kept, const Ty& incoming) const {
+			kept = incoming;
+		}
+	};
+
+	/**
+	 * @brief Resolver of the k-way merge, folds the mapped values with fn(kept, incoming)
+	*/
+	template< class Fn >
+	struct combine
+	{
+		constexpr combine(Fn fn = Fn())
+			: fn(std::move(fn)) {
+		}
+
+		template< class Ty >
+		constexpr void operator()(Ty& kept, const Ty& incoming) const {
+			kept.value() = fn(std::as_const(kept.value()), incoming.value());
+		}
+
+		Fn fn;
+	};
+
+	namespace _impls
+	{
+
+		/**
+		 * @brief Loser tree over the cursors of k sorted_vectors
+		 *
+		 * The leaves are the nodes k to 2k - 1 of an implicit tree, every inner node keeps the loser
+		 * of its match and node 0 the overall winner. Replacing the winner replays a single path,
+		 * so every output costs log k comparisons. Equal keys are ordered by input.
+		*/
+		template< class Sv >
+		class _loser_tree
+		{
+		public:
+			using value_type = Sv::value_type;
+
+			_loser_tree(std::vector<const Sv*> inputs)
+				: _inputs(std::move(inputs)), _pos(_inputs.size(), 0), _tree(_inputs.size() > 0 ? _inputs.size() : 1) {
+				const auto k = _inputs.size();
+				if (k == 0)
+					return;
+
+				std::vector<size_t> winners(2 * k);
+				for (size_t i = 0; i < k; i++)
+					winners[k + i] = i;
+				for (size_t node = k - 1; node > 0; node--) {
+					const auto a = winners[2 * node], b = winners[2 * node + 1];
+					const bool a_wins = _less(a, b);
+					winners[node] = a_wins ? a : b;
+					_tree[node] = a_wins ? b : a;
+				}
+				_tree[0] = k > 1 ? winners[1] : 0;
+			}
+
+			bool empty() const noexcept {
+				return _inputs.empty() || _done(_tree[0]);
+			}
+			size_t top_input() const noexcept {
+				return _tree[0];
+			}
+			const value_type& top() const noexcept {
+				return _inputs[_tree[0]]->vector()[_pos[_tree[0]]];
+			}
+
+			void pop() {
+				auto winner = _tree[0];
+				_pos[winner]++;
+				for (auto node = (_inputs.size() + winner) / 2; node > 0; node /= 2) {
+					if (_less(_tree[node], winner))
+						std::swap(_tree[node], winner);
+				}
+				_tree[0] = winner;
+			}
+
+		private:
+			bool _done(size_t i) const noexcept {
+				return _pos[i] >= _inputs[i]->size();
+			}
+
+			// an exhausted input loses every match
+			bool _less(size_t a, size_t b) const {
+				if (_done(a))
+					return false;
+				if (_done(b))
+					return true;
+
+				const auto comp = _inputs[a]->key_comp();
+				const auto& ka = _inputs[a]->vector()[_pos[a]].key();
+				const auto& kb = _inputs[b]->vector()[_pos[b]].key();
+				if (comp(ka, kb))
+					return true;
+				if (comp(kb, ka))
+					return false;
+				return a < b;
+			}
+
+			std::vector<const Sv*> _inputs;
+			std::vector<size_t> _pos;
+			std::vector<size_t> _tree;
+		};
+
+	}
+
+	/**
+	 * @brief Merge a range of sorted_vectors into one, in O(n log k)
+	 *
+	 * The inputs are merged through a loser tree and the output is allocated once, for the total size.
+	 * Entries with equal keys reach the resolver in input order, resolver(kept, incoming) updates the kept one:
+	 * first_wins, last_wins or combine{ fn }.
+	*/
+	template< class It, class Resolver = first_wins >
+		requires _impls::_is_sorted_vector_v<std::iter_value_t<It>>
+	std::iter_value_t<It> merge_all(It first, It last, Resolver resolver = Resolver()) {
+		using sv_type = std::iter_value_t<It>;
+
+		std::vector<const sv_type*> inputs;
+		size_t total = 0;
+		for (; first != last; ++first) {
+			const sv_type& sv = *first;
+			if (!sv.empty())
+				inputs.push_back(std::addressof(sv)), total += sv.size();
+		}
+		if (inputs.empty())
+			return sv_type();
+
+		const auto comp = inputs.front()->key_comp();
+		typename sv_type::vector_type res(inputs.front()->get_allocator());
+		res.reserve(total);
+
+		_impls::_loser_tree<sv_type> tree(std::move(inputs));
+		for (; !tree.empty(); tree.pop()) {
+			const auto& entry = tree.top();
+			if (!res.empty() && !comp(res.back().key(), entry.key()))
+				resolver(res.back(), entry);
+			else
+				res.push_back(entry);
+		}
+
+		return sv_type(sorted_unique, std::move(res), comp);
+	}
+
+}
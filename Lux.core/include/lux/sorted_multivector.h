@@ -0,0 +1,324 @@
+#pragma once
+
+#include <lux/base_core.h>
+
+#include <lux/searching.h>
+#include <lux/sorted_vector.h>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace lux
+{
+
+	/**
+	 * @brief sorted_vector that accepts duplicate keys
+	 *
+	 * The entries with equal keys are kept in insertion order: a new entry is inserted at the upper bound of its key.
+	 * With Value = void it is a multiset, otherwise a multimap.
+	*/
+	template<
+		class Key, class Value = void,
+		class Compare = std::less<Key>,
+		class Alloc = std::allocator<sorted_vector_type<Key, Value>>,
+		class Search = lux::default_search,
+		class Stats = lux::no_stats
+	>
+	class sorted_multivector : private _impls::_sorted_storage<Key, Value, Compare, Alloc, Search, Stats>
+	{
+		using _this_type = sorted_vector_type<Key, Value>;
+		using _base = _impls::_sorted_storage<Key, Value, Compare, Alloc, Search, Stats>;
+
+	public:
+		using key_type					= Key;
+		using mapped_type				= Value;
+		using value_type				= _this_type;
+		using key_compare				= Compare;
+		using search_type				= Search;
+		using stats_type				= Stats;
+		using is_mapped					= _this_type::is_mapped;
+		using vector_type				= std::vector<value_type, Alloc>;
+		using allocator_type			= vector_type::allocator_type;
+		using size_type					= vector_type::size_type;
+		using difference_type			= vector_type::difference_type;
+		using reference					= vector_type::reference;
+		using const_reference			= vector_type::const_reference;
+		using pointer					= vector_type::pointer;
+		using const_pointer				= vector_type::const_pointer;
+		using iterator					= vector_type::iterator;
+		using const_iterator			= vector_type::const_iterator;
+		using reverse_iterator			= vector_type::reverse_iterator;
+		using const_reverse_iterator	= vector_type::const_reverse_iterator;
+
+	private:
+		using _base::_key;
+		using _base::_is_transparent;
+		using _base::_searched;
+		using _base::_less;
+		using _base::_count_storage;
+		using _base::_vector_emplace;
+		using _base::_vector_emplace_back;
+		using _base::_vector_erase;
+		using _base::_keys_changed;
+		using _base::_key_inserted;
+		using _base::_may_contain;
+		using _base::_lower_bound;
+		using _base::_upper_bound;
+		using _base::_data;
+		using _base::_comp;
+		using _base::_search;
+
+	public:
+		using _base::get_allocator;
+		using _base::key_comp;
+		using _base::stats;
+		using _base::reset_stats;
+		using _base::search_policy;
+		using _base::empty;
+		using _base::size;
+		using _base::max_size;
+		using _base::begin;
+		using _base::cbegin;
+		using _base::end;
+		using _base::cend;
+		using _base::rbegin;
+		using _base::crbegin;
+		using _base::rend;
+		using _base::crend;
+		using _base::clear;
+
+		constexpr ~sorted_multivector() = default;
+
+		constexpr sorted_multivector(const key_compare& comp, const allocator_type& alloc = allocator_type())
+			: _base(comp, alloc) {
+		}
+
+		constexpr sorted_multivector()
+			: sorted_multivector(key_compare(), allocator_type()) {
+		}
+		explicit constexpr sorted_multivector(const allocator_type& alloc)
+			: sorted_multivector(key_compare(), alloc) {
+		}
+
+		template< class It >
+		constexpr sorted_multivector(It first, It last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+			: sorted_multivector(comp, alloc) {
+			insert(first, last);
+		}
+		constexpr sorted_multivector(std::initializer_list<value_type> ilist, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+			: sorted_multivector(ilist.begin(), ilist.end(), comp, alloc) {
+		}
+
+		constexpr sorted_multivector(const sorted_multivector& other) = default;
+		constexpr sorted_multivector(sorted_multivector&& other) = default;
+
+		constexpr sorted_multivector& operator=(const sorted_multivector& other) = default;
+		constexpr sorted_multivector& operator=(sorted_multivector&& other) = default;
+
+		constexpr const vector_type& vector() const noexcept {
+			return _data;
+		}
+
+	private:
+		// the upper bound is searched only in the entries after the first equal one,
+		// both searches go through the search policy and are counted by the stats
+		template< class K >
+		constexpr std::pair<size_type, size_type> _equal_range(const K& key) const {
+			const auto first = _lower_bound(key);
+			if (first == size() || _less(key, _key(_data[first])))
+				return { first, first };
+
+			const auto data = _data.data() + first + 1;
+			const auto& window = _impls::_window_search(_search);
+			const auto last = first + 1 + _searched([&](auto proj) { return window.upper_bound(data, size() - first - 1, key, _comp, proj); });
+			return { first, last };
+		}
+
+		template< class K >
+		constexpr size_type _find(const K& key) const {
+			if (!_may_contain(key))
+				return size();
+
+			auto pos = _lower_bound(key);
+			if (pos < size() && !_less(key, _key(_data[pos])))
+				return pos;
+			return size();
+		}
+
+		// upper bound of a key to insert, a key not less than the last one costs a single comparison
+		template< class K >
+		constexpr size_type _insert_upper_bound(const K& key) const {
+			if (empty() || !_less(key, _key(_data.back())))
+				return size();
+			return _upper_bound(key);
+		}
+
+	public:
+		/**
+		 * @brief Insert an entry after the entries with an equal key
+		 *
+		 * A key not less than every key of the container is appended in amortized O(1).
+		*/
+		template< class... Args >
+		constexpr iterator emplace(Args&&... args) {
+			value_type val{ std::forward<Args>(args)... };
+			auto it = _vector_emplace(_insert_upper_bound(_key(val)), std::move(val));
+			_key_inserted(_key(*it));
+			return it;
+		}
+
+		constexpr iterator insert(const value_type& value) {
+			return emplace(value);
+		}
+		constexpr iterator insert(value_type&& value) {
+			return emplace(std::move(value));
+		}
+
+		/**
+		 * @brief Insert a range of entries in O((n + m) log m), the equal keys keep their insertion order
+		*/
+		template< class It >
+		constexpr void insert(It first, It last) {
+			const auto old = size();
+			if constexpr (std::forward_iterator<It>) {
+				const auto capacity = _data.capacity();
+				_data.reserve(old + std::distance(first, last));
+				_count_storage(capacity, old, 0);
+			}
+
+			try {
+				for (; first != last; ++first)
+					_vector_emplace_back(*first);
+			}
+			catch (...) {
+				_data.erase(begin() + old, end());
+				throw;
+			}
+
+			auto vcomp = [this](const value_type& left, const value_type& right) { return _less(_key(left), _key(right)); };
+			const auto mid = begin() + old;
+			std::stable_sort(mid, end(), vcomp);
+			if (old > 0 && mid != end() && vcomp(*mid, *(mid - 1)))
+				std::inplace_merge(begin(), mid, end(), vcomp);
+			_keys_changed();
+		}
+		constexpr void insert(std::initializer_list<value_type> ilist) {
+			insert(ilist.begin(), ilist.end());
+		}
+
+		constexpr iterator erase(const_iterator it) {
+			_keys_changed();
+			return _vector_erase(it, it + 1);
+		}
+		constexpr iterator erase(const_iterator first, const_iterator last) {
+			_keys_changed();
+			return _vector_erase(first, last);
+		}
+
+		/**
+		 * @brief Erase every entry with the given key
+		 * @return The number of erased entries
+		*/
+		constexpr size_type erase(const key_type& key) {
+			auto [first, last] = _equal_range(key);
+			_vector_erase(begin() + first, begin() + last);
+			_keys_changed();
+			return last - first;
+		}
+
+		constexpr void swap(sorted_multivector& other) noexcept {
+			_base::_swap(other);
+		}
+
+		constexpr size_type count(const key_type& key) const {
+			if (!_may_contain(key))
+				return 0;
+			auto [first, last] = _equal_range(key);
+			return last - first;
+		}
+		template< class K > requires _is_transparent
+		constexpr size_type count(const K& key) const {
+			if (!_may_contain(key))
+				return 0;
+			auto [first, last] = _equal_range(key);
+			return last - first;
+		}
+
+		constexpr bool contains(const key_type& key) const {
+			return _find(key) != size();
+		}
+		template< class K > requires _is_transparent
+		constexpr bool contains(const K& key) const {
+			return _find(key) != size();
+		}
+
+		/**
+		 * @brief The first entry with the given key
+		*/
+		constexpr iterator find(const key_type& key) {
+			return begin() + _find(key);
+		}
+		constexpr const_iterator find(const key_type& key) const {
+			return begin() + _find(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr iterator find(const K& key) {
+			return begin() + _find(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr const_iterator find(const K& key) const {
+			return begin() + _find(key);
+		}
+
+		constexpr iterator lower_bound(const key_type& key) {
+			return begin() + _lower_bound(key);
+		}
+		constexpr const_iterator lower_bound(const key_type& key) const {
+			return begin() + _lower_bound(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr iterator lower_bound(const K& key) {
+			return begin() + _lower_bound(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr const_iterator lower_bound(const K& key) const {
+			return begin() + _lower_bound(key);
+		}
+
+		constexpr iterator upper_bound(const key_type& key) {
+			return begin() + _upper_bound(key);
+		}
+		constexpr const_iterator upper_bound(const key_type& key) const {
+			return begin() + _upper_bound(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr iterator upper_bound(const K& key) {
+			return begin() + _upper_bound(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr const_iterator upper_bound(const K& key) const {
+			return begin() + _upper_bound(key);
+		}
+
+		constexpr std::pair<iterator, iterator> equal_range(const key_type& key) {
+			auto [first, last] = _equal_range(key);
+			return { begin() + first, begin() + last };
+		}
+		constexpr std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+			auto [first, last] = _equal_range(key);
+			return { begin() + first, begin() + last };
+		}
+		template< class K > requires _is_transparent
+		constexpr std::pair<iterator, iterator> equal_range(const K& key) {
+			auto [first, last] = _equal_range(key);
+			return { begin() + first, begin() + last };
+		}
+		template< class K > requires _is_transparent
+		constexpr std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+			auto [first, last] = _equal_range(key);
+			return { begin() + first, begin() + last };
+		}
+	};
+
+}
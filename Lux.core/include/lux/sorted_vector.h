@@ -6,7 +6,13 @@
 #include <lux/memory.h>
 #include <lux/math.h>
 #include <lux/functions.h>
+#include <lux/searching.h>
+#include <lux/stats.h>
 
+#include <algorithm>
+#include <execution>
+#include <iterator>
+#include <span>
 #include <vector>
 
 namespace lux
@@ -15,7 +21,7 @@ namespace lux
 	template< class Key, class Value >
 	class sorted_vector_type
 	{
-		template< class, class, class, class >
+		template< class, class, class, class, class, class >
 		friend class sorted_vector;
 
 	public:
@@ -118,14 +124,290 @@ namespace lux
 		value_type _data;
 	};
 
+	/**
+	 * @brief Tag for data that is already sorted and free of duplicate keys
+	*/
+	struct sorted_unique_t
+	{
+		explicit sorted_unique_t() = default;
+	};
+	inline constexpr sorted_unique_t sorted_unique{};
+
+	namespace _impls
+	{
+
+		/**
+		 * @brief The storage shared by sorted_vector and sorted_multivector
+		 *
+		 * The vector of entries sorted by key with its comparator, search policy and stats policy. The searches and
+		 * the changes of the vector go through it, to be counted and to keep a stateful search policy in sync.
+		*/
+		template< class Key, class Value, class Compare, class Alloc, class Search, class Stats >
+		class _sorted_storage
+		{
+		public:
+			using key_type					= Key;
+			using value_type				= sorted_vector_type<Key, Value>;
+			using key_compare				= Compare;
+			using search_type				= Search;
+			using stats_type				= Stats;
+			using vector_type				= std::vector<value_type, Alloc>;
+			using allocator_type			= vector_type::allocator_type;
+			using size_type					= vector_type::size_type;
+			using iterator					= vector_type::iterator;
+			using const_iterator			= vector_type::const_iterator;
+			using reverse_iterator			= vector_type::reverse_iterator;
+			using const_reverse_iterator	= vector_type::const_reverse_iterator;
+
+		protected:
+			static inline const key_type& _key(const value_type& value) {
+				return value.key();
+			}
+
+			struct _key_projection
+			{
+				constexpr const key_type& operator()(const value_type& value) const noexcept {
+					return value.key();
+				}
+			};
+
+			// a search reads every key it compares through its projection, so the keys read are its depth
+			struct _counting_projection
+			{
+				uint64_t& depth;
+
+				constexpr const key_type& operator()(const value_type& value) const noexcept {
+					++depth;
+					return value.key();
+				}
+				// the keys a policy loads without the projection
+				constexpr void read(uint64_t count) const noexcept {
+					depth += count;
+				}
+			};
+
+			// heterogeneous lookups are enabled by a transparent comparator, like std::map
+			static constexpr bool _is_transparent = requires { typename key_compare::is_transparent; };
+
+			constexpr _sorted_storage(const key_compare& comp, const allocator_type& alloc)
+				: _data(alloc), _comp(comp), _search() {
+			}
+			constexpr _sorted_storage(const key_compare& comp, vector_type&& data)
+				: _data(std::move(data)), _comp(comp), _search() {
+			}
+			constexpr _sorted_storage(const _sorted_storage& other, const allocator_type& alloc)
+				: _data(other._data, alloc), _comp(other._comp), _search(other._search) {
+			}
+			constexpr _sorted_storage(_sorted_storage&& other, const allocator_type& alloc)
+				: _data(std::move(other._data), alloc), _comp(std::move(other._comp)), _search(std::move(other._search)) {
+			}
+
+			constexpr _sorted_storage(const _sorted_storage& other) = default;
+			constexpr _sorted_storage(_sorted_storage&& other) = default;
+
+			constexpr _sorted_storage& operator=(const _sorted_storage& other) = default;
+			constexpr _sorted_storage& operator=(_sorted_storage&& other) = default;
+
+			constexpr ~_sorted_storage() = default;
+
+			// search(proj) runs a search that reads the keys with proj, its depth is recorded in the stats
+			template< class Fn >
+			constexpr size_type _searched(Fn search) const {
+				if constexpr (stats_type::enabled) {
+					uint64_t depth = 0;
+					const auto res = search(_counting_projection{ depth });
+					_stats.searched(depth);
+					return res;
+				}
+				else
+					return search(_key_projection{});
+			}
+
+			// the comparisons outside of the searches go through here, to be counted by the stats
+			template< class L, class R >
+			constexpr bool _less(const L& left, const R& right) const {
+				_stats.compared();
+				return _comp(left, right);
+			}
+
+			/*
+			*	The changes of the vector go through these, to count the entries they move and the buffers they allocate
+			*/
+
+			// when the capacity changed the size entries were relocated to a new buffer, else shifted were moved in place
+			constexpr void _count_storage(size_type capacity, size_type size, size_type shifted) const noexcept {
+				if (_data.capacity() != capacity)
+					_stats.reallocated(_data.capacity() * sizeof(value_type), size);
+				else
+					_stats.moved(shifted);
+			}
+
+			template< class... Args >
+			constexpr iterator _vector_emplace(size_type pos, Args&&... args) {
+				const auto capacity = _data.capacity(), old = size();
+				auto it = _data.emplace(begin() + pos, std::forward<Args>(args)...);
+				_count_storage(capacity, old, old - pos);
+				return it;
+			}
+			template< class... Args >
+			constexpr void _vector_emplace_back(Args&&... args) {
+				const auto capacity = _data.capacity(), old = size();
+				_data.emplace_back(std::forward<Args>(args)...);
+				_count_storage(capacity, old, 0);
+			}
+			constexpr iterator _vector_erase(const_iterator first, const_iterator last) {
+				_stats.moved(static_cast<size_type>(cend() - last));
+				return _data.erase(first, last);
+			}
+
+			// every change of the keys goes through here, a stateful search policy drops what it derived from them
+			constexpr void _keys_changed() noexcept {
+				_search_keys_changed(_search);
+			}
+			// a single new key, a policy that can absorb it keeps its state
+			template< class K >
+			constexpr void _key_inserted(const K& key) {
+				_search_key_inserted(_search, key);
+			}
+
+			// false if a search policy with a membership filter proves that key is missing
+			template< class K >
+			constexpr bool _may_contain(const K& key) const {
+				return _search_may_contain(_search, _data.data(), size(), key, _comp, _key_projection{});
+			}
+
+			constexpr void _swap(_sorted_storage& other) noexcept {
+				using std::swap;
+				_data.swap(other._data);
+				swap(_comp, other._comp);
+				swap(_search, other._search);
+				_keys_changed(), other._keys_changed();
+			}
+
+			/*
+			*	Searches over the whole vector
+			*/
+
+			template< class K >
+			constexpr size_type _lower_bound(const K& key) const {
+				return _searched([&](auto proj) { return _search.lower_bound(_data.data(), size(), key, _comp, proj); });
+			}
+			template< class K >
+			constexpr size_type _upper_bound(const K& key) const {
+				return _searched([&](auto proj) { return _search.upper_bound(_data.data(), size(), key, _comp, proj); });
+			}
+
+			// lower bound of key in [from, size()), a walk over sorted keys costs O(log gap) per key
+			template< class K >
+			constexpr size_type _gallop_lower_bound(size_type from, const K& key) const {
+				return _searched([&](auto proj) { return _impls::_gallop_lower_bound(_data.data(), size(), from, key, _comp, proj, _search); });
+			}
+
+		public:
+			constexpr allocator_type get_allocator() const noexcept {
+				return _data.get_allocator();
+			}
+			constexpr key_compare key_comp() const {
+				return _comp;
+			}
+
+			/**
+			 * @brief Operation counters of the container, all zero unless its stats policy counts
+			 *
+			 * Counted are the comparisons, the entries moved by the insertions and the erasures,
+			 * the buffers allocated by the growth of the vector, and the keys read by every search.
+			 * The entries moved inside std::stable_sort and std::inplace_merge by the range insertions
+			 * and merge are not counted, their comparisons are.
+			*/
+			container_stats stats() const noexcept {
+				return _stats.get();
+			}
+			constexpr void reset_stats() noexcept {
+				_stats.reset();
+			}
+
+			constexpr search_type& search_policy() noexcept {
+				return _search;
+			}
+			constexpr const search_type& search_policy() const noexcept {
+				return _search;
+			}
+
+			constexpr bool empty() const noexcept {
+				return _data.empty();
+			}
+			constexpr size_type size() const noexcept {
+				return _data.size();
+			}
+			constexpr size_type max_size() const noexcept {
+				return _data.max_size();
+			}
+
+			constexpr iterator begin() noexcept {
+				return _data.begin();
+			}
+			constexpr const_iterator begin() const noexcept {
+				return _data.begin();
+			}
+			constexpr const_iterator cbegin() const noexcept {
+				return _data.cbegin();
+			}
+
+			constexpr iterator end() noexcept {
+				return _data.end();
+			}
+			constexpr const_iterator end() const noexcept {
+				return _data.end();
+			}
+			constexpr const_iterator cend() const noexcept {
+				return _data.cend();
+			}
+
+			constexpr reverse_iterator rbegin() noexcept {
+				return _data.rbegin();
+			}
+			constexpr const_reverse_iterator rbegin() const noexcept {
+				return _data.rbegin();
+			}
+			constexpr const_reverse_iterator crbegin() const noexcept {
+				return _data.crbegin();
+			}
+
+			constexpr reverse_iterator rend() noexcept {
+				return _data.rend();
+			}
+			constexpr const_reverse_iterator rend() const noexcept {
+				return _data.rend();
+			}
+			constexpr const_reverse_iterator crend() const noexcept {
+				return _data.crend();
+			}
+
+			constexpr void clear() noexcept {
+				_data.clear();
+				_keys_changed();
+			}
+
+		protected:
+			vector_type _data;
+			key_compare _comp;
+			search_type _search;
+			LUX_NO_UNIQUE_ADDRESS stats_type _stats;
+		};
+
+	}
+
 	template<
 		class Key, class Value = void,
 		class Compare = std::less<Key>,
-		class Alloc = std::allocator<sorted_vector_type<Key, Value>>
+		class Alloc = std::allocator<sorted_vector_type<Key, Value>>,
+		class Search = lux::default_search,
+		class Stats = lux::no_stats
 	>
-	class sorted_vector
+	class sorted_vector : private _impls::_sorted_storage<Key, Value, Compare, Alloc, Search, Stats>
 	{
 		using _this_type = sorted_vector_type<Key, Value>;
+		using _base = _impls::_sorted_storage<Key, Value, Compare, Alloc, Search, Stats>;
 
 	public:
 		class value_compare;
@@ -134,6 +416,8 @@ namespace lux
 		using mapped_type				= Value;
 		using value_type				= _this_type;
 		using key_compare				= Compare;
+		using search_type				= Search;
+		using stats_type				= Stats;
 		using value_compare				= sorted_vector::value_compare;
 		using is_mapped					= _this_type::is_mapped;
 		using vector_type				= std::vector<value_type, Alloc>;
@@ -161,10 +445,6 @@ namespace lux
 
 		// the container **must** have _key and _value
 
-		static inline const key_type& _key(const value_type& value) {
-			return value.key();
-		}
-
 		static inline _access_return_type _value(value_type& value) {
 			return value.value();
 		}
@@ -172,7 +452,46 @@ namespace lux
 			return value.value();
 		}
 
+		using _base::_key;
+		using typename _base::_key_projection;
+		using typename _base::_counting_projection;
+		using _base::_is_transparent;
+		using _base::_searched;
+		using _base::_less;
+		using _base::_count_storage;
+		using _base::_vector_emplace;
+		using _base::_vector_emplace_back;
+		using _base::_vector_erase;
+		using _base::_keys_changed;
+		using _base::_key_inserted;
+		using _base::_may_contain;
+		using _base::_lower_bound;
+		using _base::_upper_bound;
+		using _base::_gallop_lower_bound;
+		using _base::_data;
+		using _base::_comp;
+		using _base::_search;
+		using _base::_stats;
+
 	public:
+		using _base::get_allocator;
+		using _base::key_comp;
+		using _base::stats;
+		using _base::reset_stats;
+		using _base::search_policy;
+		using _base::empty;
+		using _base::size;
+		using _base::max_size;
+		using _base::begin;
+		using _base::cbegin;
+		using _base::end;
+		using _base::cend;
+		using _base::rbegin;
+		using _base::crbegin;
+		using _base::rend;
+		using _base::crend;
+		using _base::clear;
+
 		static inline const key_type& get_key(const value_type& value) {
 			return _key(value);
 		}
@@ -187,7 +506,7 @@ namespace lux
 		constexpr ~sorted_vector() = default;
 
 		constexpr sorted_vector(const key_compare& comp, const allocator_type& alloc = allocator_type())
-			: _data(alloc), _comp(comp) {
+			: _base(comp, alloc) {
 		}
 
 		constexpr sorted_vector()
@@ -199,28 +518,30 @@ namespace lux
 
 		constexpr sorted_vector(const sorted_vector& other) = default;
 		constexpr sorted_vector(const sorted_vector& other, const allocator_type& alloc)
-			: _data(other._data, alloc), _comp(other._comp) {
+			: _base(other, alloc) {
 		}
 
 		constexpr sorted_vector(sorted_vector&& other) = default;
 		constexpr sorted_vector(sorted_vector&& other, const allocator_type& alloc)
-			: _data(std::move(other._data), alloc), _comp(std::move(other._comp)) {
+			: _base(std::move(other), alloc) {
 		}
 
 		constexpr sorted_vector& operator=(const sorted_vector& other) = default;
 		constexpr sorted_vector& operator=(sorted_vector&& other) = default;
 
+		/**
+		 * @brief The underlying vector, the keys edited through it must stay sorted and unique
+		 *
+		 * A stateful search policy drops what it derived from the keys, since they may change through the reference.
+		*/
 		constexpr vector_type& vector() noexcept {
+			_keys_changed();
 			return _data;
 		}
 		constexpr const vector_type& vector() const noexcept {
 			return _data;
 		}
 
-		constexpr allocator_type get_allocator() const noexcept {
-			return _data.get_allocator();
-		}
-
 		class value_compare
 		{
 			friend class sorted_vector;
@@ -238,119 +559,101 @@ namespace lux
 			sorted_vector::key_compare _comp;
 		};
 
-		constexpr key_compare key_comp() const {
-			return _comp;
-		}
 		constexpr value_compare value_comp() const {
 			return value_compare{ _comp };
 		}
 
-		constexpr bool empty() const noexcept {
-			return _data.empty();
-		}
-		constexpr size_type size() const noexcept {
-			return _data.size();
-		}
-		constexpr size_type max_size() const noexcept {
-			return _data.max_size();
-		}
-
-		constexpr iterator begin() noexcept {
-			return _data.begin();
-		}
-		constexpr const_iterator begin() const noexcept {
-			return _data.begin();
-		}
-		constexpr const_iterator cbegin() const noexcept {
-			return _data.cbegin();
-		}
-
-		constexpr iterator end() noexcept {
-			return _data.end();
-		}
-		constexpr const_iterator end() const noexcept {
-			return _data.end();
-		}
-		constexpr const_iterator cend() const noexcept {
-			return _data.cend();
-		}
-
-		constexpr reverse_iterator rbegin() noexcept {
-			return _data.rbegin();
-		}
-		constexpr const_reverse_iterator rbegin() const noexcept {
-			return _data.rbegin();
-		}
-		constexpr const_reverse_iterator crbegin() const noexcept {
-			return _data.crbegin();
-		}
-
-		constexpr reverse_iterator rend() noexcept {
-			return _data.rend();
-		}
-		constexpr const_reverse_iterator rend() const noexcept {
-			return _data.rend();
-		}
-		constexpr const_reverse_iterator crend() const noexcept {
-			return _data.crend();
-		}
-
-		constexpr void clear() noexcept {
-			_data.clear();
-		}
-
 	private:
-		constexpr size_type _lower_bound(const key_type& key) const {
-			size_type mid = 0, left = 0, right = size();
-			while (left < right) {
-				mid = (left + right) / 2;
-				if (_comp(key, _key(_data.at(mid))))
-					right = mid;
-				else if (_comp(_key(_data.at(mid)), key))
-					left = mid + 1;
-				else
-					return mid;
-			}
-
-			return left;
-		}
-
-		constexpr bool _lower_bound_match(const key_type& res, const key_type& key) const {
+		template< class K >
+		constexpr bool _key_match(const key_type& res, const K& key) const {
 			// lb must be less or equal to key
-			return !_comp(key, res);
+			return !_less(key, res);
 		}
-		constexpr bool _lower_bound_match(size_type pos, const key_type& key) const {
+		template< class K >
+		constexpr bool _lower_bound_match(size_type pos, const K& key) const {
 			// lb must be less or equal to key
-			return pos < size() && _lower_bound_match(_key(_data.at(pos)), key);
+			return pos < size() && _key_match(_key(_data[pos]), key);
 		}
 
-		template< class... Args >
-		constexpr std::pair<iterator, bool> _emplace(Args&&... args) {
+		// lower bound of a key to insert, a key past the last one costs a single comparison
+		template< class K >
+		constexpr size_type _insert_lower_bound(const K& key) const {
+			if (empty() || _less(_key(_data.back()), key))
+				return size();
+			return _lower_bound(key);
+		}
+
+		// lower bound of a key to insert, the neighbourhood of hint is checked first
+		template< class K >
+		constexpr size_type _hint_lower_bound(size_type hint, const K& key) const {
+			const auto data = _data.data();
+			if (hint < size() && _less(_key(data[hint]), key))
+				return _gallop_lower_bound(hint, key);
+			if (hint == 0 || _less(_key(data[hint - 1]), key))
+				return hint;
+			return _searched([&](auto proj) { return _impls::_window_search(_search).lower_bound(data, hint - 1, key, _comp, proj); });
+		}
+
+		// lower_bound_of(key) gives the position of the new entry
+		template< class LowerBoundOf, class... Args >
+		constexpr std::pair<iterator, bool> _emplace_with(LowerBoundOf lower_bound_of, Args&&... args) {
 			using _key_extractor = _in_place_key_extractor<_remove_cvref_t<Args>...>;
 
 			if constexpr (is_mapped::value && _key_extractor::_Extractable) {
 				const auto& key	= _key_extractor::_Extract(args...);
-				auto pos		= _lower_bound(key);
+				auto pos		= lower_bound_of(key);
 				if (_lower_bound_match(pos, key))
 					return { begin() + pos, false };
-				return { _data.emplace(begin() + pos, std::forward<Args>(args)...), true };
+				auto it = _vector_emplace(pos, std::forward<Args>(args)...);
+				_key_inserted(_key(*it));
+				return { it, true };
 			}
 			else {
 				value_type val{ std::forward<Args>(args)... };
 				const auto& key	= _key(val);
-				auto pos		= _lower_bound(key);
+				auto pos		= lower_bound_of(key);
 				if (_lower_bound_match(pos, key))
 					return { begin() + pos, false };
-				return { _data.emplace(begin() + pos, std::move(val)), true };
+				auto it = _vector_emplace(pos, std::move(val));
+				_key_inserted(_key(*it));
+				return { it, true };
 			}
 		}
 
+		template< class... Args >
+		constexpr std::pair<iterator, bool> _emplace(Args&&... args) {
+			return _emplace_with([this](const auto& key) { return _insert_lower_bound(key); }, std::forward<Args>(args)...);
+		}
+
+		template< class... Args >
+		constexpr iterator _emplace_hint(const_iterator hint, Args&&... args) {
+			const auto pos = static_cast<size_type>(hint - cbegin());
+			return _emplace_with([this, pos](const auto& key) { return _hint_lower_bound(pos, key); }, std::forward<Args>(args)...).first;
+		}
+
 	public:
+		/**
+		 * @brief Insert an entry if its key is missing
+		 *
+		 * A key greater than every key of the container is appended in amortized O(1).
+		*/
 		template< class... Args >
 		constexpr std::pair<iterator, bool> emplace(Args&&... args) {
 			return _emplace(std::forward<Args>(args)...);
 		}
 
+		/**
+		 * @brief Insert an entry if its key is missing, hint is the position the key is expected at
+		 *
+		 * If the key belongs right before hint it costs two comparisons, after hint it is searched by galloping
+		 * from hint, so a nearly sorted stream with the previous result as hint costs O(log distance) per entry.
+		 * @return The entry with the key, inserted or not
+		*/
+		template< class... Args >
+		constexpr iterator emplace_hint(const_iterator hint, Args&&... args) {
+			return _emplace_hint(hint, std::forward<Args>(args)...);
+		}
+
 		constexpr std::pair<iterator, bool> insert(const value_type& value) {
 			return _emplace(value);
 		}
@@ -362,20 +665,126 @@ namespace lux
 			return _emplace(std::forward<P>(value));
 		}
 
+		constexpr iterator insert(const_iterator hint, const value_type& value) {
+			return _emplace_hint(hint, value);
+		}
+		constexpr iterator insert(const_iterator hint, value_type&& value) {
+			return _emplace_hint(hint, std::move(value));
+		}
+		template< class P, std::enable_if_t<std::is_constructible_v<value_type, P>, int> = 0>
+		constexpr iterator insert(const_iterator hint, P&& value) {
+			return _emplace_hint(hint, std::forward<P>(value));
+		}
+
+	private:
+		constexpr bool _equivalent(const value_type& left, const value_type& right) const {
+			return !_less(_key(left), _key(right)) && !_less(_key(right), _key(left));
+		}
+
+		// sorts the entries from old onward and merges them with the sorted front,
+		// of the entries with equal keys the first one inserted is kept
+		constexpr void _merge_tail(size_type old, bool sorted_tail = false) {
+			auto vcomp = [this](const value_type& left, const value_type& right) { return _less(_key(left), _key(right)); };
+			auto equal = [this](const value_type& left, const value_type& right) { return _equivalent(left, right); };
+
+			const auto mid = begin() + old;
+			auto last = end();
+			if (!sorted_tail) {
+				std::stable_sort(mid, end(), vcomp);
+				last = std::unique(mid, end(), equal);
+			}
+
+			// stable merge keeps the old entries in front of the new ones with equal keys
+			if (old > 0 && mid != last && !_less(_key(*(mid - 1)), _key(*mid))) {
+				std::inplace_merge(begin(), mid, last, vcomp);
+				last = std::unique(begin(), last, equal);
+			}
+
+			_data.erase(last, end());
+			_keys_changed();
+		}
+
+		// _merge_tail with the sort, the deduplication and the merge run under an execution policy
+		template< class ExecutionPolicy >
+		void _merge_tail(ExecutionPolicy&& policy, size_type old) {
+			auto vcomp = [this](const value_type& left, const value_type& right) { return _less(_key(left), _key(right)); };
+			auto equal = [this](const value_type& left, const value_type& right) { return _equivalent(left, right); };
+
+			const auto mid = begin() + old;
+			std::stable_sort(policy, mid, end(), vcomp);
+			auto last = std::unique(policy, mid, end(), equal);
+
+			if (old > 0 && mid != last && !_less(_key(*(mid - 1)), _key(*mid))) {
+				std::inplace_merge(policy, begin(), mid, last, vcomp);
+				last = std::unique(policy, begin(), last, equal);
+			}
+
+			_data.erase(last, end());
+			_keys_changed();
+		}
+
+	public:
+		/**
+		 * @brief Insert a range of entries in O((n + m) log m)
+		 *
+		 * The entries are appended, sorted, deduplicated and merged with the container in a single pass,
+		 * instead of being inserted one by one. Like emplace, an entry whose key is already present is dropped.
+		*/
 		template< class It >
 		constexpr void insert(It first, It last) {
-			using deref_type = lux::deref_t<It>;
-			_data.reserve(_data.size() + std::distance(first, last));
+			const auto old = size();
+			if constexpr (std::forward_iterator<It>) {
+				const auto capacity = _data.capacity();
+				_data.reserve(old + std::distance(first, last));
+				_count_storage(capacity, old, 0);
+			}
+
+			try {
+				for (; first != last; ++first)
+					_vector_emplace_back(*first);
+			}
+			catch (...) {
+				_data.erase(begin() + old, end());
+				throw;
+			}
 
-			auto it			= (first);
-			const auto end	= (last);
-			for (; it != end; ++it)
-				_emplace(*it);
+			_merge_tail(old);
 		}
 		constexpr void insert(std::initializer_list<value_type> ilist) {
 			insert(ilist.begin(), ilist.end());
 		}
 
+		/**
+		 * @brief Insert a range of entries, sorted, deduplicated and merged under an execution policy
+		 *
+		 * Same result as insert(first, last); with std::execution::par the work is spread over the cores,
+		 * which pays off for large unsorted ranges.
+		*/
+		template< class ExecutionPolicy, class It >
+			requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>
+		void insert(ExecutionPolicy&& policy, It first, It last) {
+			const auto old = size();
+			try {
+				if constexpr (std::random_access_iterator<It> && std::is_default_constructible_v<value_type>
+					&& std::is_assignable_v<value_type&, std::iter_reference_t<It>>) {
+					const auto capacity = _data.capacity();
+					_data.resize(old + std::distance(first, last));
+					_count_storage(capacity, old, 0);
+					std::copy(policy, first, last, begin() + old);
+				}
+				else {
+					for (; first != last; ++first)
+						_vector_emplace_back(*first);
+				}
+			}
+			catch (...) {
+				_data.erase(begin() + old, end());
+				throw;
+			}
+
+			_merge_tail(std::forward<ExecutionPolicy>(policy), old);
+		}
+
 		template< class It >
 		constexpr sorted_vector(It first, It last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
 			: sorted_vector(comp, alloc) {
@@ -386,6 +795,16 @@ namespace lux
 			: sorted_vector(first, last, key_compare(), alloc) {
 		}
 
+		/**
+		 * @brief Build from an unsorted range under an execution policy, e.g. std::execution::par
+		*/
+		template< class ExecutionPolicy, class It >
+			requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>
+		sorted_vector(ExecutionPolicy&& policy, It first, It last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+			: sorted_vector(comp, alloc) {
+			insert(std::forward<ExecutionPolicy>(policy), first, last);
+		}
+
 		constexpr sorted_vector(std::initializer_list<value_type> ilist, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
 			: sorted_vector(comp, alloc) {
 			insert(ilist);
@@ -401,16 +820,74 @@ namespace lux
 			return *this;
 		}
 
+	private:
+		constexpr bool _is_sorted_unique() const {
+			return std::adjacent_find(begin(), end(), [this](const value_type& left, const value_type& right) {
+				return !_comp(_key(left), _key(right));
+			}) == end();
+		}
+
+		constexpr void _check_sorted_unique() const {
+#ifdef _DEBUG
+			if (!_is_sorted_unique())
+				throw std::invalid_argument("lux::sorted_vector data is not sorted and unique");
+#endif // _DEBUG
+		}
+
+	public:
+		/**
+		 * @brief Adopt a buffer of sorted and unique entries in O(1)
+		 *
+		 * The order is verified in debug builds only.
+		*/
+		constexpr sorted_vector(sorted_unique_t, vector_type&& data, const key_compare& comp = key_compare())
+			: _base(comp, std::move(data)) {
+			_check_sorted_unique();
+		}
+		/**
+		 * @brief Copy a range of sorted and unique entries in O(n)
+		 *
+		 * The order is verified in debug builds only.
+		*/
+		template< class It >
+		constexpr sorted_vector(sorted_unique_t, It first, It last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+			: _base(comp, vector_type(first, last, alloc)) {
+			_check_sorted_unique();
+		}
+
+		/**
+		 * @brief Replace the contents with a buffer of sorted and unique entries in O(1)
+		 *
+		 * The order is verified in debug builds only.
+		*/
+		constexpr void replace(vector_type&& data) {
+			_data = std::move(data);
+			_keys_changed();
+			_check_sorted_unique();
+		}
+
+		/**
+		 * @brief Move the underlying buffer out, the container is left empty
+		*/
+		constexpr vector_type extract() noexcept {
+			vector_type res = std::move(_data);
+			_data.clear();
+			_keys_changed();
+			return res;
+		}
+
 	private:
 		template< class K, class... Args >
 		constexpr std::pair<iterator, bool> _try_emplace(K&& k, Args&&... args) {
 			static_assert(is_mapped::value, "mapped_value must be valid");
 
-			auto pos = _lower_bound(k);
+			auto pos = _insert_lower_bound(k);
 			if (_lower_bound_match(pos, k))
 				return { begin() + pos, false };
 
-			return { _data.emplace(begin() + pos, value_type(std::forward<K>(k), mapped_type(std::forward<Args>(args)...))), true };
+			auto it = _vector_emplace(pos, value_type(std::forward<K>(k), mapped_type(std::forward<Args>(args)...)));
+			_key_inserted(_key(*it));
+			return { it, true };
 		}
 
 	public:
@@ -430,7 +907,7 @@ namespace lux
 
 			auto pos = _lower_bound(key);
 			if (_lower_bound_match(pos, key)) {
-				_value(_data.at(pos)) = std::forward<T>(val);
+				_value(_data[pos]) = std::forward<T>(val);
 				return { begin() + pos, false };
 			}
 
@@ -448,14 +925,17 @@ namespace lux
 		}
 
 		constexpr iterator erase(const_iterator it) {
-			return _data.erase(it);
+			_keys_changed();
+			return _vector_erase(it, it + 1);
 		}
 		constexpr iterator erase(const_iterator first, const_iterator last) {
-			return _data.erase(first, last);
+			_keys_changed();
+			return _vector_erase(first, last);
 		}
 
 	private:
-		constexpr size_type _erase(const key_type& key) {
+		template< class K >
+		constexpr size_type _erase(const K& key) {
 			auto pos = _lower_bound(key);
 			if (!_lower_bound_match(pos, key))
 				return 0;
@@ -467,28 +947,171 @@ namespace lux
 		constexpr size_type erase(const key_type& key) {
 			return _erase(key);
 		}
+		template< class K >
+			requires (_is_transparent && !std::is_convertible_v<K, iterator> && !std::is_convertible_v<K, const_iterator>)
+		constexpr size_type erase(K&& key) {
+			return _erase(key);
+		}
 
-		constexpr void swap(sorted_vector&& other) noexcept {
-			_data.swap(other._data);
+		/*
+		*	Bulk erase, every function compacts the container in a single pass
+		*/
+
+	private:
+		// moves [from, to) down to out, out and from are equal until the first hole
+		constexpr void _compact(size_type& out, size_type from, size_type to) {
+			if (out != from) {
+				std::move(begin() + from, begin() + to, begin() + out);
+				_stats.moved(to - from);
+			}
+			out += to - from;
+		}
+
+		// erases the entries whose key is in the sorted range, key_of maps an element of the range to its key
+		template< class It, class KeyOf >
+		constexpr size_type _erase_sorted(It first, It last, KeyOf key_of) {
+			const auto n = size();
+
+			size_type out = 0, in = 0;
+			for (; first != last && in < n; ++first) {
+				auto&& elem = *first;
+				const auto& key = key_of(elem);
+				const auto pos = _gallop_lower_bound(in, key);
+				_compact(out, in, pos);
+				in = pos;
+				if (_lower_bound_match(in, key))
+					in++;
+			}
+			_compact(out, in, n);
+
+			_data.erase(begin() + out, end());
+			_keys_changed();
+			return n - out;
 		}
 
 	public:
-		constexpr _access_return_type at(const key_type& key) {
-			auto pos	= _lower_bound(key);
-			auto& val	= _data.at(pos);
-			if (_lower_bound_match(_key(val), key))
-				return _value(val);
+		/**
+		 * @brief Erase every entry that satisfies pred, keeping the order of the others
+		 * @return The number of erased entries
+		*/
+		template< class Pred >
+		constexpr size_type erase_if(Pred pred) {
+			const auto n = size();
+
+			size_type out = 0;
+			for (size_type in = 0; in < n; in++)
+				if (!pred(begin()[in]))
+					_compact(out, in, in + 1);
+
+			_data.erase(begin() + out, end());
+			_keys_changed();
+			return n - out;
+		}
+
+		/**
+		 * @brief Erase the entries of a sorted range of k keys in O(k log(n / k) + n)
+		 *
+		 * Each key is searched by galloping from the position of the previous one, the entries in between
+		 * are moved once. The order of the keys is verified in debug builds only.
+		 * @return The number of erased entries
+		*/
+		template< class It >
+		constexpr size_type erase_keys(It first, It last) {
+#ifdef _DEBUG
+			if constexpr (std::forward_iterator<It>) {
+				if (!std::is_sorted(first, last, _comp))
+					throw std::invalid_argument("lux::sorted_vector erase_keys range is not sorted");
+			}
+#endif // _DEBUG
+			return _erase_sorted(first, last, [](const auto& key) -> const auto& { return key; });
+		}
+
+		/**
+		 * @brief Erase the entries with a key in [lo, hi)
+		 * @return The number of erased entries
+		*/
+		constexpr size_type erase_range(const key_type& lo, const key_type& hi) {
+			const auto first = _lower_bound(lo);
+			const auto last = std::max(first, _lower_bound(hi));
+			_vector_erase(cbegin() + first, cbegin() + last);
+			_keys_changed();
+			return last - first;
+		}
+
+		/*
+		*	Set operations, in place
+		*/
+
+		/**
+		 * @brief Move the entries of other whose key is missing into the container, in O(n + m)
+		 *
+		 * other is left empty. On equal keys the entry of the container is kept.
+		 * @return The number of inserted entries
+		*/
+		constexpr size_type merge(sorted_vector&& other) {
+			const auto old = size(), capacity = _data.capacity();
+			_data.insert(end(), std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+			_count_storage(capacity, old, 0);
+			other.clear();
+
+			_merge_tail(old, true);
+			return size() - old;
+		}
+		/**
+		 * @brief Copy the entries of other whose key is missing into the container, in O(n + m)
+		 * @return The number of inserted entries
+		*/
+		constexpr size_type merge(const sorted_vector& other) {
+			const auto old = size(), capacity = _data.capacity();
+			_data.insert(end(), other.begin(), other.end());
+			_count_storage(capacity, old, 0);
+
+			_merge_tail(old, true);
+			return size() - old;
+		}
+
+		/**
+		 * @brief Keep only the entries whose key is in other, without allocating
+		 *
+		 * The keys of other are searched by galloping, so a small other costs O(m log(n / m)) comparisons.
+		 * @return The number of erased entries
+		*/
+		constexpr size_type intersect(const sorted_vector& other) {
+			const auto n = size();
+
+			size_type out = 0, in = 0;
+			for (auto it = other.begin(); it != other.end() && in < n; ++it) {
+				const auto pos = _gallop_lower_bound(in, _key(*it));
+				in = pos;
+				if (_lower_bound_match(pos, _key(*it))) {
+					_compact(out, pos, pos + 1);
+					in = pos + 1;
+				}
+			}
 
-			if constexpr (is_mapped::value)
-				throw std::out_of_range("invalid lux::sorted_vector<K, T> key");
-			else
-				throw std::out_of_range("invalid lux::sorted_vector<K> key");
+			_data.erase(begin() + out, end());
+			_keys_changed();
+			return n - out;
+		}
+
+		/**
+		 * @brief Erase the entries whose key is in other, without allocating
+		 * @return The number of erased entries
+		*/
+		constexpr size_type subtract(const sorted_vector& other) {
+			return _erase_sorted(other.begin(), other.end(), [](const value_type& val) -> const key_type& { return _key(val); });
 		}
-		constexpr _const_access_return_type at(const key_type& key) const {
-			auto pos	= _lower_bound(key);
-			auto& val	= _data.at(pos);
-			if (_lower_bound_match(_key(val), key))
-				return _value(val);
+
+		constexpr void swap(sorted_vector&& other) noexcept {
+			_base::_swap(other);
+		}
+
+	private:
+		template< class K >
+		constexpr size_type _at(const K& key) const {
+			auto pos	= _may_contain(key) ? _lower_bound(key) : size();
+			if (_lower_bound_match(pos, key))
+				return pos;
 
 			if constexpr (is_mapped::value)
 				throw std::out_of_range("invalid lux::sorted_vector<K, T> key");
@@ -496,13 +1119,28 @@ namespace lux
 				throw std::out_of_range("invalid lux::sorted_vector<K> key");
 		}
 
+	public:
+		constexpr _access_return_type at(const key_type& key) {
+			return _value(_data[_at(key)]);
+		}
+		constexpr _const_access_return_type at(const key_type& key) const {
+			return _value(_data[_at(key)]);
+		}
+		template< class K > requires _is_transparent
+		constexpr _access_return_type at(const K& key) {
+			return _value(_data[_at(key)]);
+		}
+		template< class K > requires _is_transparent
+		constexpr _const_access_return_type at(const K& key) const {
+			return _value(_data[_at(key)]);
+		}
+
 	private:
 		template< class K >
 		constexpr _access_return_type _op_array(K&& key) {
 			auto pos	= _lower_bound(key);
-			auto& val	= _data.at(pos);
-			if (_lower_bound_match(_key(val), key))
-				return _value(val);
+			if (_lower_bound_match(pos, key))
+				return _value(_data[pos]);
 
 			if constexpr (is_mapped::value)
 				return _value(*_emplace(std::forward<K>(key), mapped_type{}).first);
@@ -519,25 +1157,35 @@ namespace lux
 		}
 
 		constexpr size_type count(const key_type& key) const noexcept {
-			if (_lower_bound_match(_lower_bound(key), key))
+			if (_may_contain(key) && _lower_bound_match(_lower_bound(key), key))
+				return 1;
+			return 0;
+		}
+		template< class K > requires _is_transparent
+		constexpr size_type count(const K& key) const {
+			if (_may_contain(key) && _lower_bound_match(_lower_bound(key), key))
 				return 1;
 			return 0;
 		}
 
 		constexpr bool contains(const key_type& key) const noexcept {
-			return _lower_bound_match(_lower_bound(key), key);
+			return _may_contain(key) && _lower_bound_match(_lower_bound(key), key);
+		}
+		template< class K > requires _is_transparent
+		constexpr bool contains(const K& key) const {
+			return _may_contain(key) && _lower_bound_match(_lower_bound(key), key);
 		}
 
 	private:
-		constexpr size_type _find(const key_type& key) const {
-			auto pos	= _lower_bound(key);
-			auto len	= size();
+		template< class K >
+		constexpr size_type _find(const K& key) const {
+			if (!_may_contain(key))
+				return size();
 
-			if (pos >= len)
-				return len;
-			if (_lower_bound_match(_key(_data.at(pos)), key))
+			auto pos	= _lower_bound(key);
+			if (_lower_bound_match(pos, key))
 				return pos;
-			return len;
+			return size();
 		}
 
 	public:
@@ -547,6 +1195,14 @@ namespace lux
 		constexpr const_iterator find(const key_type& key) const {
 			return begin() + _find(key);
 		}
+		template< class K > requires _is_transparent
+		constexpr iterator find(const K& key) {
+			return begin() + _find(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr const_iterator find(const K& key) const {
+			return begin() + _find(key);
+		}
 
 		constexpr iterator lower_bound(const key_type& key) {
 			return begin() + _lower_bound(key);
@@ -554,28 +1210,29 @@ namespace lux
 		constexpr const_iterator lower_bound(const key_type& key) const {
 			return begin() + _lower_bound(key);
 		}
-
-	private:
-		constexpr size_type _upper_bound(const key_type& key) const {
-			size_type mid = 0, left = 0, right = size();
-			while (left < right) {
-				mid = (left + right) / 2;
-				if (_comp(key, _key(_data.at(mid))))
-					right = mid;
-				else
-					left = mid + 1;
-			}
-
-			return left;
+		template< class K > requires _is_transparent
+		constexpr iterator lower_bound(const K& key) {
+			return begin() + _lower_bound(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr const_iterator lower_bound(const K& key) const {
+			return begin() + _lower_bound(key);
 		}
 
-	public:
 		constexpr iterator upper_bound(const key_type& key) {
 			return begin() + _upper_bound(key);
 		}
 		constexpr const_iterator upper_bound(const key_type& key) const {
 			return begin() + _upper_bound(key);
 		}
+		template< class K > requires _is_transparent
+		constexpr iterator upper_bound(const K& key) {
+			return begin() + _upper_bound(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr const_iterator upper_bound(const K& key) const {
+			return begin() + _upper_bound(key);
+		}
 
 		constexpr std::pair<iterator, iterator> equal_range(const key_type& key) {
 			return { lower_bound(key), upper_bound(key) };
@@ -583,11 +1240,112 @@ namespace lux
 		constexpr std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
 			return { lower_bound(key), upper_bound(key) };
 		}
+		template< class K > requires _is_transparent
+		constexpr std::pair<iterator, iterator> equal_range(const K& key) {
+			return { begin() + _lower_bound(key), begin() + _upper_bound(key) };
+		}
+		template< class K > requires _is_transparent
+		constexpr std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+			return { begin() + _lower_bound(key), begin() + _upper_bound(key) };
+		}
+
+		/*
+		*	Batched lookups
+		*/
 
 	private:
+		// lower bounds of n keys given by key_of(j) through the batched search of the policy, out(j, pos) receives them
+		template< class KeyOf, class Out >
+		void _search_many(size_type n, KeyOf key_of, Out out) const {
+			if (n == 0)
+				return;
+
+			if constexpr (stats_type::enabled) {
+				uint64_t depth = 0;
+				_impls::_search_lower_bound_many(_search, _data.data(), size(), n, key_of, _comp, out, _counting_projection{ depth });
+				// the searches may be interleaved, each one is recorded with the mean depth of the batch
+				for (size_type j = 0; j < n; j++)
+					_stats.searched(depth / n + (j < depth % n ? 1 : 0));
+			}
+			else
+				_impls::_search_lower_bound_many(_search, _data.data(), size(), n, key_of, _comp, out, _key_projection{});
+		}
+
+		// out(i, pos) receives the lower bound of every key; with Filter, a key rejected by _may_contain
+		// is not searched and receives size(), which only find and contains may use
+		template< bool Filter, class Out >
+		void _lower_bound_many(std::span<const key_type> keys, Out out) const {
+			// the sorted prefix of the keys is resolved by a galloping walk, every search starts from the previous result
+			size_type sorted = 0, pos = 0;
+			for (; sorted < keys.size() && (sorted == 0 || !_less(keys[sorted], keys[sorted - 1])); sorted++) {
+				if (Filter && !_may_contain(keys[sorted]))
+					out(sorted, size());
+				else
+					out(sorted, pos = _gallop_lower_bound(pos, keys[sorted]));
+			}
+			if (sorted == keys.size())
+				return;
+
+			if constexpr (Filter && _impls::_is_membership_filter<search_type>) {
+				std::vector<size_type> hits;
+				hits.reserve(keys.size() - sorted);
+				for (size_type i = sorted; i < keys.size(); i++) {
+					if (_may_contain(keys[i]))
+						hits.push_back(i);
+					else
+						out(i, size());
+				}
+				_search_many(hits.size(), [&](size_type j) -> const key_type& { return keys[hits[j]]; }, [&](size_type j, size_type res) { out(hits[j], res); });
+			}
+			else
+				_search_many(keys.size() - sorted, [&](size_type j) -> const key_type& { return keys[sorted + j]; }, [&](size_type j, size_type res) { out(sorted + j, res); });
+		}
+
+		static void _check_batch(size_type keys, size_type out) {
+			if (out < keys)
+				throw std::invalid_argument("lux::sorted_vector batched lookup output is shorter than the keys");
+		}
+
+	public:
+		/**
+		 * @brief Lower bound position of every key, written to out[i]
+		 *
+		 * The keys are walked by galloping while they come in order, so sorted keys cost a single walk over the container.
+		 * From the first key out of order, the rest goes to the batched search of the policy, which interleaves
+		 * the searches so that their memory accesses overlap, or to its searches one by one.
+		*/
+		void lower_bound_many(std::span<const key_type> keys, std::span<size_type> out) const {
+			_check_batch(keys.size(), out.size());
+			_lower_bound_many<false>(keys, [&](size_type i, size_type pos) { out[i] = pos; });
+		}
+
+		void find_many(std::span<const key_type> keys, std::span<iterator> out) {
+			_check_batch(keys.size(), out.size());
+			_lower_bound_many<true>(keys, [&](size_type i, size_type pos) {
+				out[i] = _lower_bound_match(pos, keys[i]) ? begin() + pos : end();
+			});
+		}
+		void find_many(std::span<const key_type> keys, std::span<const_iterator> out) const {
+			_check_batch(keys.size(), out.size());
+			_lower_bound_many<true>(keys, [&](size_type i, size_type pos) {
+				out[i] = _lower_bound_match(pos, keys[i]) ? begin() + pos : end();
+			});
+		}
+
+		void contains_many(std::span<const key_type> keys, std::span<bool> out) const {
+			_check_batch(keys.size(), out.size());
+			_lower_bound_many<true>(keys, [&](size_type i, size_type pos) { out[i] = _lower_bound_match(pos, keys[i]); });
+		}
 
-		vector_type _data;
-		key_compare _comp;
 	};
 
+	/**
+	 * @brief Erase every entry of the container that satisfies pred, in a single pass
+	 * @return The number of erased entries
+	*/
+	template< class Key, class Value, class Compare, class Alloc, class Search, class Pred >
+	constexpr typename sorted_vector<Key, Value, Compare, Alloc, Search>::size_type erase_if(sorted_vector<Key, Value, Compare, Alloc, Search>& container, Pred pred) {
+		return container.erase_if(pred);
+	}
+
 }
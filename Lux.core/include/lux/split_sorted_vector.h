@@ -0,0 +1,630 @@
+#pragma once
+
+#include <lux/base_core.h>
+
+#include <lux/searching.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <vector>
+
+namespace lux
+{
+
+	/**
+	 * @brief Mapped sorted_vector that stores the keys and the values in two parallel arrays
+	 *
+	 * The searches only touch the dense key array, the value array is read on a hit.
+	 * The iterators yield proxy references with key() and value(), like sorted_vector_type.
+	*/
+	template<
+		class Key, class Value,
+		class Compare = std::less<Key>,
+		class Alloc = std::allocator<Key>,
+		class Search = lux::default_search
+	>
+	class split_sorted_vector
+	{
+		template< bool Const >
+		class _iterator;
+
+	public:
+		using key_type					= Key;
+		using mapped_type				= Value;
+		using value_type				= std::pair<key_type, mapped_type>;
+		using key_compare				= Compare;
+		using search_type				= Search;
+		using key_vector_type			= std::vector<key_type, typename std::allocator_traits<Alloc>::template rebind_alloc<key_type>>;
+		using value_vector_type			= std::vector<mapped_type, typename std::allocator_traits<Alloc>::template rebind_alloc<mapped_type>>;
+		using allocator_type			= key_vector_type::allocator_type;
+		using size_type					= key_vector_type::size_type;
+		using difference_type			= key_vector_type::difference_type;
+		using iterator					= _iterator<false>;
+		using const_iterator			= _iterator<true>;
+		using reverse_iterator			= std::reverse_iterator<iterator>;
+		using const_reverse_iterator	= std::reverse_iterator<const_iterator>;
+
+		/**
+		 * @brief Proxy to an entry, key() and value() refer to the two arrays
+		*/
+		template< bool Const >
+		class proxy_reference
+		{
+			friend class split_sorted_vector;
+
+			using _mapped = std::conditional_t<Const, const mapped_type, mapped_type>;
+
+		public:
+			constexpr const key_type& key() const noexcept {
+				return *_key;
+			}
+			constexpr _mapped& value() const noexcept {
+				return *_value;
+			}
+
+			constexpr operator value_type() const {
+				return { *_key, *_value };
+			}
+			constexpr operator proxy_reference<true>() const noexcept requires (!Const) {
+				return { _key, _value };
+			}
+
+			constexpr proxy_reference(const key_type* key, _mapped* value) noexcept
+				: _key(key), _value(value) {
+			}
+
+		private:
+			const key_type* _key;
+			_mapped* _value;
+		};
+
+		using reference					= proxy_reference<false>;
+		using const_reference			= proxy_reference<true>;
+
+	private:
+		template< bool Const >
+		class _iterator
+		{
+			friend class split_sorted_vector;
+
+			using _mapped = std::conditional_t<Const, const mapped_type, mapped_type>;
+
+			struct _arrow
+			{
+				proxy_reference<Const> ref;
+
+				constexpr const proxy_reference<Const>* operator->() const noexcept {
+					return std::addressof(ref);
+				}
+			};
+
+		public:
+			using iterator_category	= std::random_access_iterator_tag;
+			using value_type		= split_sorted_vector::value_type;
+			using difference_type	= split_sorted_vector::difference_type;
+			using reference			= proxy_reference<Const>;
+			using pointer			= _arrow;
+
+			constexpr _iterator() noexcept
+				: _key(nullptr), _value(nullptr) {
+			}
+			constexpr operator _iterator<true>() const noexcept requires (!Const) {
+				return { _key, _value };
+			}
+
+			constexpr reference operator*() const noexcept {
+				return { _key, _value };
+			}
+			constexpr pointer operator->() const noexcept {
+				return { **this };
+			}
+			constexpr reference operator[](difference_type off) const noexcept {
+				return { _key + off, _value + off };
+			}
+
+			constexpr _iterator& operator++() noexcept {
+				++_key, ++_value;
+				return *this;
+			}
+			constexpr _iterator operator++(int) noexcept {
+				auto tmp = *this;
+				++(*this);
+				return tmp;
+			}
+			constexpr _iterator& operator--() noexcept {
+				--_key, --_value;
+				return *this;
+			}
+			constexpr _iterator operator--(int) noexcept {
+				auto tmp = *this;
+				--(*this);
+				return tmp;
+			}
+
+			constexpr _iterator& operator+=(difference_type off) noexcept {
+				_key += off, _value += off;
+				return *this;
+			}
+			constexpr _iterator& operator-=(difference_type off) noexcept {
+				_key -= off, _value -= off;
+				return *this;
+			}
+			constexpr _iterator operator+(difference_type off) const noexcept {
+				return { _key + off, _value + off };
+			}
+			friend constexpr _iterator operator+(difference_type off, const _iterator& it) noexcept {
+				return it + off;
+			}
+			constexpr _iterator operator-(difference_type off) const noexcept {
+				return { _key - off, _value - off };
+			}
+			constexpr difference_type operator-(const _iterator& other) const noexcept {
+				return _key - other._key;
+			}
+
+			constexpr bool operator==(const _iterator& other) const noexcept {
+				return _key == other._key;
+			}
+			constexpr std::strong_ordering operator<=>(const _iterator& other) const noexcept {
+				return _key <=> other._key;
+			}
+
+			constexpr _iterator(const key_type* key, _mapped* value) noexcept
+				: _key(key), _value(value) {
+			}
+
+		private:
+			const key_type* _key;
+			_mapped* _value;
+		};
+
+		static constexpr bool _is_transparent = requires { typename key_compare::is_transparent; };
+
+		// every change of the keys goes through here, a stateful search policy drops what it derived from them
+		constexpr void _keys_changed() noexcept {
+			_impls::_search_keys_changed(_search);
+		}
+		// a single new key, a policy that can absorb it keeps its state
+		template< class K >
+		constexpr void _key_inserted(const K& key) {
+			_impls::_search_key_inserted(_search, key);
+		}
+
+		// false if a search policy with a membership filter proves that key is missing
+		template< class K >
+		constexpr bool _may_contain(const K& key) const {
+			return _impls::_search_may_contain(_search, _keys.data(), size(), key, _comp, std::identity{});
+		}
+
+	public:
+		constexpr ~split_sorted_vector() = default;
+
+		constexpr split_sorted_vector(const key_compare& comp, const allocator_type& alloc = allocator_type())
+			: _keys(alloc), _values(alloc), _comp(comp), _search() {
+		}
+
+		constexpr split_sorted_vector()
+			: split_sorted_vector(key_compare(), allocator_type()) {
+		}
+		explicit constexpr split_sorted_vector(const allocator_type& alloc)
+			: split_sorted_vector(key_compare(), alloc) {
+		}
+
+		template< class It >
+		constexpr split_sorted_vector(It first, It last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+			: split_sorted_vector(comp, alloc) {
+			insert(first, last);
+		}
+		constexpr split_sorted_vector(std::initializer_list<value_type> ilist, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type())
+			: split_sorted_vector(ilist.begin(), ilist.end(), comp, alloc) {
+		}
+
+		constexpr split_sorted_vector(const split_sorted_vector& other) = default;
+		constexpr split_sorted_vector(split_sorted_vector&& other) = default;
+
+		constexpr split_sorted_vector& operator=(const split_sorted_vector& other) = default;
+		constexpr split_sorted_vector& operator=(split_sorted_vector&& other) = default;
+
+		/**
+		 * @brief The sorted keys
+		*/
+		constexpr const key_vector_type& keys() const noexcept {
+			return _keys;
+		}
+		/**
+		 * @brief The values, values()[i] belongs to keys()[i]
+		*/
+		constexpr std::span<mapped_type> values() noexcept {
+			return _values;
+		}
+		constexpr std::span<const mapped_type> values() const noexcept {
+			return _values;
+		}
+
+		constexpr allocator_type get_allocator() const noexcept {
+			return _keys.get_allocator();
+		}
+		constexpr key_compare key_comp() const {
+			return _comp;
+		}
+
+		constexpr search_type& search_policy() noexcept {
+			return _search;
+		}
+		constexpr const search_type& search_policy() const noexcept {
+			return _search;
+		}
+
+		constexpr bool empty() const noexcept {
+			return _keys.empty();
+		}
+		constexpr size_type size() const noexcept {
+			return _keys.size();
+		}
+		constexpr size_type max_size() const noexcept {
+			return std::min(_keys.max_size(), _values.max_size());
+		}
+
+		constexpr void reserve(size_type count) {
+			_keys.reserve(count);
+			_values.reserve(count);
+			_keys_changed();
+		}
+
+		constexpr iterator begin() noexcept {
+			return { _keys.data(), _values.data() };
+		}
+		constexpr const_iterator begin() const noexcept {
+			return { _keys.data(), _values.data() };
+		}
+		constexpr const_iterator cbegin() const noexcept {
+			return begin();
+		}
+
+		constexpr iterator end() noexcept {
+			return begin() + size();
+		}
+		constexpr const_iterator end() const noexcept {
+			return begin() + size();
+		}
+		constexpr const_iterator cend() const noexcept {
+			return end();
+		}
+
+		constexpr reverse_iterator rbegin() noexcept {
+			return reverse_iterator(end());
+		}
+		constexpr const_reverse_iterator rbegin() const noexcept {
+			return const_reverse_iterator(end());
+		}
+		constexpr const_reverse_iterator crbegin() const noexcept {
+			return rbegin();
+		}
+
+		constexpr reverse_iterator rend() noexcept {
+			return reverse_iterator(begin());
+		}
+		constexpr const_reverse_iterator rend() const noexcept {
+			return const_reverse_iterator(begin());
+		}
+		constexpr const_reverse_iterator crend() const noexcept {
+			return rend();
+		}
+
+		constexpr void clear() noexcept {
+			_keys.clear();
+			_values.clear();
+			_keys_changed();
+		}
+
+	private:
+		template< class K >
+		constexpr size_type _lower_bound(const K& key) const {
+			return _search.lower_bound(_keys.data(), size(), key, _comp);
+		}
+		template< class K >
+		constexpr size_type _upper_bound(const K& key) const {
+			return _search.upper_bound(_keys.data(), size(), key, _comp);
+		}
+
+		template< class K >
+		constexpr bool _lower_bound_match(size_type pos, const K& key) const {
+			// lb must be less or equal to key
+			return pos < size() && !_comp(key, _keys[pos]);
+		}
+
+		// the keys are unique, so the range is empty or the single entry at the lower bound
+		template< class K >
+		constexpr std::pair<size_type, size_type> _equal_range(const K& key) const {
+			const auto pos = _lower_bound(key);
+			return { pos, _lower_bound_match(pos, key) ? pos + 1 : pos };
+		}
+
+		template< class K >
+		constexpr size_type _find(const K& key) const {
+			if (!_may_contain(key))
+				return size();
+
+			auto pos = _lower_bound(key);
+			if (_lower_bound_match(pos, key))
+				return pos;
+			return size();
+		}
+
+		template< class K, class... Args >
+		constexpr iterator _emplace_at(size_type pos, K&& key, Args&&... args) {
+			_values.emplace(_values.begin() + pos, std::forward<Args>(args)...);
+			try {
+				_keys.emplace(_keys.begin() + pos, std::forward<K>(key));
+			}
+			catch (...) {
+				_values.erase(_values.begin() + pos);
+				throw;
+			}
+			_key_inserted(_keys[pos]);
+			return begin() + pos;
+		}
+
+		template< class K, class... Args >
+		constexpr std::pair<iterator, bool> _try_emplace(K&& key, Args&&... args) {
+			auto pos = _lower_bound(key);
+			if (_lower_bound_match(pos, key))
+				return { begin() + pos, false };
+			return { _emplace_at(pos, std::forward<K>(key), std::forward<Args>(args)...), true };
+		}
+
+		template< class K, class T >
+		constexpr std::pair<iterator, bool> _insert_or_assign(K&& key, T&& val) {
+			auto pos = _lower_bound(key);
+			if (_lower_bound_match(pos, key)) {
+				_values[pos] = std::forward<T>(val);
+				return { begin() + pos, false };
+			}
+			return { _emplace_at(pos, std::forward<K>(key), std::forward<T>(val)), true };
+		}
+
+	public:
+		/**
+		 * @brief Insert the value built from args under key, if the key is missing
+		*/
+		template< class K, class... Args >
+		constexpr std::pair<iterator, bool> emplace(K&& key, Args&&... args) {
+			return _try_emplace(key_type(std::forward<K>(key)), std::forward<Args>(args)...);
+		}
+
+		constexpr std::pair<iterator, bool> insert(const value_type& value) {
+			return _try_emplace(value.first, value.second);
+		}
+		constexpr std::pair<iterator, bool> insert(value_type&& value) {
+			return _try_emplace(std::move(value.first), std::move(value.second));
+		}
+
+		/**
+		 * @brief Insert a range of key/value pairs in O(n + m log m)
+		 *
+		 * Like emplace, a pair whose key is already present is dropped.
+		 * The new pairs are merged into both arrays in place, from the back, without rebuilding them.
+		*/
+		template< class It >
+		constexpr void insert(It first, It last) {
+			std::vector<value_type> tail(first, last);
+			auto vcomp = [this](const value_type& left, const value_type& right) { return _comp(left.first, right.first); };
+			std::stable_sort(tail.begin(), tail.end(), vcomp);
+			auto tail_end = std::unique(tail.begin(), tail.end(), [&](const value_type& left, const value_type& right) {
+				return !vcomp(left, right) && !vcomp(right, left);
+			});
+
+			// the entries already present win over the new ones, the sorted new keys are looked up by galloping
+			auto missing = tail.begin();
+			size_type pos = 0;
+			for (auto it = tail.begin(); it != tail_end; ++it) {
+				pos = _impls::_gallop_lower_bound(_keys.data(), size(), pos, it->first, _comp, std::identity{}, _search);
+				if (_lower_bound_match(pos, it->first))
+					continue;
+				if (missing != it)
+					*missing = std::move(*it);
+				++missing;
+			}
+
+			const auto old = size(), added = static_cast<size_type>(missing - tail.begin());
+			if (added == 0)
+				return;
+			_keys.reserve(old + added);
+			_values.reserve(old + added);
+
+			// the last added entries of the merge go past the old end: old [i, old) and new [j, added), appended in order
+			size_type i = old, j = added;
+			for (size_type k = 0; k < added; k++) {
+				if (i == 0 || (j > 0 && _comp(_keys[i - 1], tail[j - 1].first)))
+					j--;
+				else
+					i--;
+			}
+			for (size_type a = i, b = j; a < old || b < added;) {
+				if (b == added || (a < old && _comp(_keys[a], tail[b].first)))
+					_keys.push_back(std::move(_keys[a])), _values.push_back(std::move(_values[a])), a++;
+				else
+					_keys.push_back(std::move(tail[b].first)), _values.push_back(std::move(tail[b].second)), b++;
+			}
+
+			// old [0, i) and new [0, j) fill [0, old) backward, the write position never passes the old entry it reads
+			for (auto w = old; j > 0;) {
+				--w;
+				if (i > 0 && _comp(tail[j - 1].first, _keys[i - 1]))
+					--i, _keys[w] = std::move(_keys[i]), _values[w] = std::move(_values[i]);
+				else
+					--j, _keys[w] = std::move(tail[j].first), _values[w] = std::move(tail[j].second);
+			}
+			_keys_changed();
+		}
+		constexpr void insert(std::initializer_list<value_type> ilist) {
+			insert(ilist.begin(), ilist.end());
+		}
+
+		template< class... Args >
+		constexpr std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) {
+			return _try_emplace(key, std::forward<Args>(args)...);
+		}
+		template< class... Args >
+		constexpr std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args) {
+			return _try_emplace(std::move(key), std::forward<Args>(args)...);
+		}
+
+		template< class T >
+		constexpr std::pair<iterator, bool> insert_or_assign(const key_type& key, T&& val) {
+			return _insert_or_assign(key, std::forward<T>(val));
+		}
+		template< class T >
+		constexpr std::pair<iterator, bool> insert_or_assign(key_type&& key, T&& val) {
+			return _insert_or_assign(std::move(key), std::forward<T>(val));
+		}
+
+		constexpr iterator erase(const_iterator it) {
+			return erase(it, it + 1);
+		}
+		constexpr iterator erase(const_iterator first, const_iterator last) {
+			const auto pos = first - cbegin(), count = last - first;
+			_keys.erase(_keys.begin() + pos, _keys.begin() + (pos + count));
+			_values.erase(_values.begin() + pos, _values.begin() + (pos + count));
+			_keys_changed();
+			return begin() + pos;
+		}
+
+		constexpr size_type erase(const key_type& key) {
+			auto pos = _find(key);
+			if (pos == size())
+				return 0;
+			erase(cbegin() + pos);
+			return 1;
+		}
+
+		constexpr void swap(split_sorted_vector& other) noexcept {
+			_keys.swap(other._keys);
+			_values.swap(other._values);
+			std::swap(_comp, other._comp);
+			std::swap(_search, other._search);
+			_keys_changed(), other._keys_changed();
+		}
+
+	private:
+		template< class K >
+		constexpr size_type _at(const K& key) const {
+			auto pos = _find(key);
+			if (pos != size())
+				return pos;
+			throw std::out_of_range("invalid lux::split_sorted_vector<K, T> key");
+		}
+
+	public:
+		constexpr mapped_type& at(const key_type& key) {
+			return _values[_at(key)];
+		}
+		constexpr const mapped_type& at(const key_type& key) const {
+			return _values[_at(key)];
+		}
+		template< class K > requires _is_transparent
+		constexpr mapped_type& at(const K& key) {
+			return _values[_at(key)];
+		}
+		template< class K > requires _is_transparent
+		constexpr const mapped_type& at(const K& key) const {
+			return _values[_at(key)];
+		}
+
+		constexpr mapped_type& operator[](const key_type& key) {
+			return (*_try_emplace(key).first).value();
+		}
+		constexpr mapped_type& operator[](key_type&& key) {
+			return (*_try_emplace(std::move(key)).first).value();
+		}
+
+		constexpr size_type count(const key_type& key) const {
+			return _find(key) != size() ? 1 : 0;
+		}
+		template< class K > requires _is_transparent
+		constexpr size_type count(const K& key) const {
+			return _find(key) != size() ? 1 : 0;
+		}
+
+		constexpr bool contains(const key_type& key) const {
+			return _find(key) != size();
+		}
+		template< class K > requires _is_transparent
+		constexpr bool contains(const K& key) const {
+			return _find(key) != size();
+		}
+
+		constexpr iterator find(const key_type& key) {
+			return begin() + _find(key);
+		}
+		constexpr const_iterator find(const key_type& key) const {
+			return begin() + _find(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr iterator find(const K& key) {
+			return begin() + _find(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr const_iterator find(const K& key) const {
+			return begin() + _find(key);
+		}
+
+		constexpr iterator lower_bound(const key_type& key) {
+			return begin() + _lower_bound(key);
+		}
+		constexpr const_iterator lower_bound(const key_type& key) const {
+			return begin() + _lower_bound(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr iterator lower_bound(const K& key) {
+			return begin() + _lower_bound(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr const_iterator lower_bound(const K& key) const {
+			return begin() + _lower_bound(key);
+		}
+
+		constexpr iterator upper_bound(const key_type& key) {
+			return begin() + _upper_bound(key);
+		}
+		constexpr const_iterator upper_bound(const key_type& key) const {
+			return begin() + _upper_bound(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr iterator upper_bound(const K& key) {
+			return begin() + _upper_bound(key);
+		}
+		template< class K > requires _is_transparent
+		constexpr const_iterator upper_bound(const K& key) const {
+			return begin() + _upper_bound(key);
+		}
+
+		constexpr std::pair<iterator, iterator> equal_range(const key_type& key) {
+			auto [first, last] = _equal_range(key);
+			return { begin() + first, begin() + last };
+		}
+		constexpr std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+			auto [first, last] = _equal_range(key);
+			return { begin() + first, begin() + last };
+		}
+		template< class K > requires _is_transparent
+		constexpr std::pair<iterator, iterator> equal_range(const K& key) {
+			auto [first, last] = _equal_range(key);
+			return { begin() + first, begin() + last };
+		}
+		template< class K > requires _is_transparent
+		constexpr std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+			auto [first, last] = _equal_range(key);
+			return { begin() + first, begin() + last };
+		}
+
+	private:
+		key_vector_type _keys;
+		value_vector_type _values;
+		key_compare _comp;
+		LUX_NO_UNIQUE_ADDRESS search_type _search;
+	};
+
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <lux/base_core.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace lux
+{
+
+	/*
+	*	Operation counters of the containers, chosen per container by its Stats parameter:
+	*	no_stats compiles them out and takes no space, counting_stats counts. The policy is part of the type,
+	*	so an instrumented table and a plain one may live in the same program.
+	*/
+
+	/**
+	 * @brief Snapshot of the operation counters of a container
+	 *
+	 * comparisons includes the keys read by the searches, search_depth is their sum over every search.
+	*/
+	struct container_stats
+	{
+		bool enabled = false;
+
+		uint64_t comparisons = 0;
+		uint64_t moves = 0;
+		uint64_t bytes_allocated = 0;
+		uint64_t reallocations = 0;
+		uint64_t searches = 0;
+		uint64_t search_depth = 0;
+		uint64_t max_search_depth = 0;
+
+		double mean_search_depth() const noexcept {
+			return searches == 0 ? 0.0 : static_cast<double>(search_depth) / static_cast<double>(searches);
+		}
+
+		/**
+		 * @brief The counters as a single line JSON object
+		*/
+		std::string to_json() const {
+			std::string res = "{\"enabled\":";
+			res += enabled ? "true" : "false";
+			auto field = [&res](const char* name, uint64_t value) {
+				res += ",\"";
+				res += name;
+				res += "\":";
+				res += std::to_string(value);
+			};
+			field("comparisons", comparisons);
+			field("moves", moves);
+			field("bytes_allocated", bytes_allocated);
+			field("reallocations", reallocations);
+			field("searches", searches);
+			field("search_depth", search_depth);
+			field("max_search_depth", max_search_depth);
+			res += '}';
+			return res;
+		}
+	};
+
+	/**
+	 * @brief Stats policy that counts nothing, every call is a no-op and the policy takes no space
+	*/
+	struct no_stats
+	{
+		static constexpr bool enabled = false;
+
+		constexpr void compared(uint64_t = 1) const noexcept {
+		}
+		constexpr void searched(uint64_t) const noexcept {
+		}
+		constexpr void moved(uint64_t) const noexcept {
+		}
+		constexpr void allocated(uint64_t) const noexcept {
+		}
+		constexpr void reallocated(uint64_t, uint64_t) const noexcept {
+		}
+
+		container_stats get() const noexcept {
+			return {};
+		}
+		constexpr void reset() noexcept {
+		}
+	};
+
+	/**
+	 * @brief Stats policy that counts the operations of its container
+	 *
+	 * The counters are relaxed atomics, so concurrent readers of a container count without a data race.
+	 * A copy starts from zero: the counters belong to a container, not to its contents.
+	*/
+	class counting_stats
+	{
+	public:
+		static constexpr bool enabled = true;
+
+		constexpr counting_stats() noexcept = default;
+		constexpr counting_stats(const counting_stats&) noexcept {
+		}
+		constexpr counting_stats& operator=(const counting_stats&) noexcept {
+			return *this;
+		}
+
+		void compared(uint64_t count = 1) const noexcept {
+			_add(_comparisons, count);
+		}
+		void searched(uint64_t depth) const noexcept {
+			_add(_comparisons, depth);
+			_add(_searches, 1);
+			_add(_search_depth, depth);
+
+			auto max = _max_search_depth.load(std::memory_order_relaxed);
+			while (max < depth && !_max_search_depth.compare_exchange_weak(max, depth, std::memory_order_relaxed));
+		}
+		void moved(uint64_t count) const noexcept {
+			_add(_moves, count);
+		}
+		void allocated(uint64_t bytes) const noexcept {
+			_add(_bytes_allocated, bytes);
+		}
+		void reallocated(uint64_t bytes, uint64_t moved) const noexcept {
+			_add(_bytes_allocated, bytes);
+			_add(_reallocations, 1);
+			_add(_moves, moved);
+		}
+
+		container_stats get() const noexcept {
+			container_stats res;
+			res.enabled				= true;
+			res.comparisons			= _comparisons.load(std::memory_order_relaxed);
+			res.moves				= _moves.load(std::memory_order_relaxed);
+			res.bytes_allocated		= _bytes_allocated.load(std::memory_order_relaxed);
+			res.reallocations		= _reallocations.load(std::memory_order_relaxed);
+			res.searches			= _searches.load(std::memory_order_relaxed);
+			res.search_depth		= _search_depth.load(std::memory_order_relaxed);
+			res.max_search_depth	= _max_search_depth.load(std::memory_order_relaxed);
+			return res;
+		}
+		void reset() noexcept {
+			for (auto counter : { &_comparisons, &_moves, &_bytes_allocated, &_reallocations, &_searches, &_search_depth, &_max_search_depth })
+				counter->store(0, std::memory_order_relaxed);
+		}
+
+	private:
+		static void _add(std::atomic<uint64_t>& counter, uint64_t count) noexcept {
+			counter.fetch_add(count, std::memory_order_relaxed);
+		}
+
+		mutable std::atomic<uint64_t> _comparisons{ 0 };
+		mutable std::atomic<uint64_t> _moves{ 0 };
+		mutable std::atomic<uint64_t> _bytes_allocated{ 0 };
+		mutable std::atomic<uint64_t> _reallocations{ 0 };
+		mutable std::atomic<uint64_t> _searches{ 0 };
+		mutable std::atomic<uint64_t> _search_depth{ 0 };
+		mutable std::atomic<uint64_t> _max_search_depth{ 0 };
+	};
+
+}
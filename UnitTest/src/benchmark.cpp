@@ -0,0 +1,451 @@
+#include "head.h"
+
+#include <lux/mapped_sorted_vector.h>
+
+#include <chrono>
+#include <execution>
+#include <filesystem>
+#include <iomanip>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+
+namespace lux::test::containers
+{
+
+	/*
+	*	Timings of the containers against their baselines, written to the test output.
+	*	They take minutes and assert only that the containers agree, so they are ignored unless LUX_BENCHMARK is defined;
+	*	LUX_BENCHMARK_LARGE adds the production scale sizes, which need several GB of memory.
+	*/
+
+	TEST_CLASS(benchmark)
+	{
+		BEGIN_TEST_CLASS_ATTRIBUTE()
+			TEST_CLASS_ATTRIBUTE(L"TestCategory", L"Benchmark")
+#ifndef LUX_BENCHMARK
+			TEST_IGNORE()
+#endif // LUX_BENCHMARK
+		END_TEST_CLASS_ATTRIBUTE()
+
+		template< class Key, class Search, class Value = void >
+		using set_type = lux::sorted_vector<Key, Value, std::less<Key>, std::allocator<lux::sorted_vector_type<Key, Value>>, Search>;
+
+		// milliseconds taken by fn
+		template< class Fn >
+		static double time_ms(Fn&& fn) {
+			const auto start = std::chrono::steady_clock::now();
+			fn();
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		// one line per measure, the time per operation when ops is given
+		static void report(const std::string& name, double ms, size_t ops = 0) {
+			std::ostringstream line;
+			line << std::fixed << std::setprecision(2) << name << ": " << ms << " ms";
+			if (ops > 0)
+				line << ", " << ms * 1e6 / static_cast<double>(ops) << " ns/op";
+			Logger::WriteMessage(line.str().c_str());
+		}
+
+		/*
+		*	Lookup latency of the search policies
+		*/
+
+		// the keys are appended in order, a map gets default values
+		template< class Search, class Value, class Key >
+		static size_t time_lookups(const std::string& name, const std::vector<Key>& keys, const std::vector<Key>& probes) {
+			set_type<Key, Search, Value> sv;
+			for (const auto& key : keys) {
+				if constexpr (std::is_void_v<Value>)
+					sv.emplace(key);
+				else
+					sv.emplace(key, Value());
+			}
+
+			size_t hits = 0;
+			report(name + " " + std::to_string(keys.size()), time_ms([&]() {
+				for (const auto& probe : probes)
+					hits += sv.contains(probe);
+			}), probes.size());
+			return hits;
+		}
+
+		template< class Key, class Value = void, class Make >
+		static void compare_lookups(const char* name, size_t count, Make make) {
+			std::mt19937 rng{ 42 };
+			std::vector<Key> keys, probes;
+			for (size_t i = 0; i < count; i++)
+				keys.push_back(make(i * 2));
+			for (size_t i = 0; i < (1 << 20); i++)
+				probes.push_back(make(rng() % (count * 2)));
+
+			const auto hits = time_lookups<lux::binary_search, Value>(std::string(name) + " binary_search", keys, probes);
+			Assert::AreEqual(hits, time_lookups<lux::branchless_search, Value>(std::string(name) + " branchless_search", keys, probes), L"lookup mismatch");
+			Assert::AreEqual(hits, time_lookups<lux::simd_index_search<>, Value>(std::string(name) + " simd_index_search", keys, probes), L"lookup mismatch");
+			Assert::AreEqual(hits, time_lookups<lux::default_search, Value>(std::string(name) + " default_search", keys, probes), L"lookup mismatch");
+		}
+
+		/*
+		*	Startup load, one bulk insert against an emplace per entry
+		*/
+
+		static void compare_load(size_t count, bool per_entry) {
+			using sv_type = lux::sorted_vector<simple_t, simple_t>;
+
+			std::mt19937 rng{ 42 };
+			std::vector<std::pair<simple_t, simple_t>> rows;
+			for (size_t i = 0; i < count; i++)
+				rows.emplace_back(static_cast<simple_t>(rng() % (count * 2)), static_cast<simple_t>(i));
+
+			sv_type bulk;
+			report("bulk insert " + std::to_string(count), time_ms([&]() {
+				bulk = sv_type(rows.begin(), rows.end());
+			}), count);
+
+			if (per_entry) {
+				sv_type emplaced;
+				report("emplace per entry " + std::to_string(count), time_ms([&]() {
+					for (const auto& [key, value] : rows)
+						emplaced.emplace(key, value);
+				}), count);
+				Assert::IsTrue(std::equal(bulk.begin(), bulk.end(), emplaced.begin(), emplaced.end(),
+					[](const auto& left, const auto& right) { return left.key() == right.key() && left.value() == right.value(); }), L"load mismatch");
+			}
+		}
+
+		/*
+		*	Mixed insertions and lookups, eager insertion against the write buffer
+		*/
+
+		template< class Container >
+		static size_t mixed_ops(Container& container, const std::vector<std::pair<bool, simple_t>>& ops) {
+			size_t hits = 0;
+			for (const auto& [insert, key] : ops) {
+				if (insert)
+					container.emplace(key, key);
+				else
+					hits += container.contains(key);
+			}
+			return hits;
+		}
+
+		/*
+		*	k-way merge through the loser tree against pairwise unions
+		*/
+
+		template< class Sv >
+		static Sv fold_union(const std::vector<Sv>& parts) {
+			Sv res;
+			for (const auto& part : parts)
+				res = lux::set_union(res, part);
+			return res;
+		}
+
+		// the parts are merged two by two in rounds, log k passes over the entries
+		template< class Sv >
+		static Sv tree_union(std::vector<Sv> parts) {
+			while (parts.size() > 1) {
+				std::vector<Sv> next;
+				for (size_t i = 0; i + 1 < parts.size(); i += 2)
+					next.push_back(lux::set_union(parts[i], parts[i + 1]));
+				if (parts.size() % 2 == 1)
+					next.push_back(std::move(parts.back()));
+				parts = std::move(next);
+			}
+			return parts.empty() ? Sv() : std::move(parts.front());
+		}
+
+		/*
+		*	Multi-writer throughput, the shards against one locked sorted_vector
+		*/
+
+		// the ops are split over the threads, each one runs its share on its own thread
+		template< class Fn >
+		static double time_threads(size_t threads, Fn&& fn) {
+			return time_ms([&]() {
+				std::vector<std::thread> workers;
+				for (size_t t = 0; t < threads; t++)
+					workers.emplace_back(fn, t);
+				for (auto& worker : workers)
+					worker.join();
+			});
+		}
+
+	public:
+		TEST_METHOD(lookup) {
+#ifdef LUX_BENCHMARK_LARGE
+			// 100M complex_t keys take about 1.6GB
+			constexpr size_t counts[] = { 1'000, 1'000'000, 100'000'000 };
+#else
+			constexpr size_t counts[] = { 1'000, 1'000'000 };
+#endif // LUX_BENCHMARK_LARGE
+			for (size_t count : counts) {
+				compare_lookups<simple_t>("int", count, [](size_t i) { return static_cast<simple_t>(i); });
+				compare_lookups<simple_t, simple_t>("int map", count, [](size_t i) { return static_cast<simple_t>(i); });
+				compare_lookups<uint64_t, uint64_t>("uint64_t map", count, [](size_t i) { return static_cast<uint64_t>(i); });
+				compare_lookups<complex_t>("complex_t", count, [](size_t i) { return complex_t(static_cast<simple_t>(i % 1024), static_cast<simple_t>(i / 1024)); });
+			}
+		}
+
+		TEST_METHOD(load) {
+			// the emplace per entry is quadratic, it is only timed at the size it can finish at
+			compare_load(20'000, true);
+			compare_load(1'000'000, false);
+		}
+
+		TEST_METHOD(mixed_insertion) {
+			constexpr size_t count = 50'000;
+			for (size_t insert_percent : { 90, 50, 10 }) {
+				std::mt19937 rng{ 42 };
+				std::vector<std::pair<bool, simple_t>> ops;
+				for (size_t i = 0; i < count; i++)
+					ops.emplace_back(rng() % 100 < insert_percent, static_cast<simple_t>(rng() % (count * 4)));
+
+				lux::sorted_vector<simple_t, simple_t> sv;
+				lux::buffered_sorted_vector<simple_t, simple_t> bv;
+				size_t s_hits = 0, b_hits = 0;
+				const auto name = std::to_string(insert_percent) + "% insertions";
+				report(name + " sorted_vector", time_ms([&]() { s_hits = mixed_ops(sv, ops); }), count);
+				report(name + " buffered_sorted_vector", time_ms([&]() { b_hits = mixed_ops(bv, ops); }), count);
+				Assert::AreEqual(s_hits, b_hits, L"lookup mismatch");
+				Assert::AreEqual(sv.size(), bv.size(), L"size mismatch");
+			}
+		}
+
+		TEST_METHOD(merge_all) {
+			using sv_type = lux::sorted_vector<simple_t, simple_t>;
+
+			for (size_t k : { 64, 256 }) {
+				std::mt19937 rng{ 42 };
+				std::vector<sv_type> parts(k);
+				for (auto& part : parts) {
+					std::vector<std::pair<simple_t, simple_t>> rows;
+					for (size_t i = 0; i < 4'000; i++)
+						rows.emplace_back(static_cast<simple_t>(rng() % (k * 8'000)), static_cast<simple_t>(i));
+					part = sv_type(rows.begin(), rows.end());
+				}
+
+				sv_type merged, folded, tree;
+				const auto name = std::to_string(k) + " inputs";
+				report(name + " merge_all", time_ms([&]() { merged = lux::merge_all(parts.begin(), parts.end()); }));
+				report(name + " pairwise fold", time_ms([&]() { folded = fold_union(parts); }));
+				report(name + " pairwise rounds", time_ms([&]() { tree = tree_union(parts); }));
+				Assert::AreEqual(folded.size(), merged.size(), L"merge mismatch");
+				Assert::AreEqual(tree.size(), merged.size(), L"merge mismatch");
+			}
+		}
+
+		TEST_METHOD(sharded_throughput) {
+			constexpr size_t count = 128 * 1024;
+
+			std::mt19937 rng{ 42 };
+			std::vector<std::pair<bool, simple_t>> ops;
+			for (size_t i = 0; i < count; i++)
+				ops.emplace_back(rng() % 4 == 0, static_cast<simple_t>(rng() % (count * 4)));
+
+			for (size_t threads : { 1, 2, 4, 8, 16, 32, 64 }) {
+				const auto share = count / threads;
+
+				lux::sorted_vector<simple_t, simple_t> sv;
+				std::shared_mutex mutex;
+				const auto locked = time_threads(threads, [&](size_t t) {
+					for (size_t i = t * share; i < (t + 1) * share; i++) {
+						const auto& [insert, key] = ops[i];
+						if (insert) {
+							std::unique_lock lock(mutex);
+							sv.emplace(key, key);
+						}
+						else {
+							std::shared_lock lock(mutex);
+							sv.contains(key);
+						}
+					}
+				});
+
+				lux::sharded_sorted_vector<simple_t, simple_t> sh;
+				const auto sharded = time_threads(threads, [&](size_t t) {
+					for (size_t i = t * share; i < (t + 1) * share; i++) {
+						const auto& [insert, key] = ops[i];
+						if (insert)
+							sh.emplace(key, key);
+						else
+							sh.contains(key);
+					}
+				});
+
+				report(std::to_string(threads) + " threads locked sorted_vector", locked, count);
+				report(std::to_string(threads) + " threads sharded_sorted_vector", sharded, count);
+				Assert::AreEqual(sv.size(), sh.size(), L"size mismatch");
+			}
+		}
+
+		TEST_METHOD(rcu_readers) {
+			constexpr size_t count = 1024 * 1024;
+			constexpr size_t size = 64 * 1024;
+
+			lux::sorted_vector<simple_t, simple_t> sv;
+			for (simple_t i = 0; i < simple_t(size); i++)
+				sv.emplace(i * 2, i);
+
+			for (size_t threads : { 1, 2, 4, 8, 16, 32, 64 }) {
+				const auto share = count / threads;
+
+				std::shared_mutex mutex;
+				std::atomic<size_t> locked_hits = 0;
+				const auto locked = time_threads(threads, [&](size_t t) {
+					size_t hits = 0;
+					for (size_t i = t * share; i < (t + 1) * share; i++) {
+						std::shared_lock lock(mutex);
+						hits += sv.contains(static_cast<simple_t>(i % (size * 2)));
+					}
+					locked_hits += hits;
+				});
+
+				lux::rcu_sorted_vector<simple_t, simple_t> table{ sv };
+				std::atomic<size_t> rcu_hits = 0;
+				const auto published = time_threads(threads, [&](size_t t) {
+					size_t hits = 0;
+					for (size_t i = t * share; i < (t + 1) * share; i++)
+						hits += table.snapshot()->contains(static_cast<simple_t>(i % (size * 2)));
+					rcu_hits += hits;
+				});
+
+				report(std::to_string(threads) + " readers shared_mutex sorted_vector", locked, count);
+				report(std::to_string(threads) + " readers rcu_sorted_vector", published, count);
+				Assert::AreEqual(locked_hits.load(), rcu_hits.load(), L"hits mismatch");
+			}
+		}
+
+		TEST_METHOD(parallel_construction) {
+			// std::execution::par picks its own thread count, the scaling shows across machines with different hardware threads
+			using sv_type = lux::sorted_vector<simple_t, simple_t>;
+			Logger::WriteMessage(("hardware threads: " + std::to_string(std::thread::hardware_concurrency())).c_str());
+
+			for (size_t count : { 1'000'000, 4'000'000 }) {
+				std::mt19937 rng{ 42 };
+				std::vector<sv_type::value_type> rows;
+				for (size_t i = 0; i < count; i++)
+					rows.emplace_back(static_cast<simple_t>(rng() % (count * 2)), static_cast<simple_t>(i));
+
+				sv_type serial, seq, par;
+				const auto name = std::to_string(count) + " entries";
+				report(name + " range constructor", time_ms([&]() { serial = sv_type(rows.begin(), rows.end()); }), count);
+				report(name + " std::execution::seq", time_ms([&]() { seq = sv_type(std::execution::seq, rows.begin(), rows.end()); }), count);
+				report(name + " std::execution::par", time_ms([&]() { par = sv_type(std::execution::par, rows.begin(), rows.end()); }), count);
+				Assert::AreEqual(serial.size(), seq.size(), L"size mismatch");
+				Assert::AreEqual(serial.size(), par.size(), L"size mismatch");
+			}
+		}
+
+		TEST_METHOD(image_start) {
+			// the image was just written, so its pages are cached and this is the warm bound of a cold start
+			using sv_type = lux::sorted_vector<uint64_t, simple_t>;
+			constexpr size_t count = 2'000'000;
+
+			std::mt19937_64 rng{ 42 };
+			std::vector<sv_type::value_type> rows;
+			for (size_t i = 0; i < count; i++)
+				rows.emplace_back(rng(), static_cast<simple_t>(i));
+			std::vector<uint64_t> probes;
+			for (size_t i = 0; i < 100'000; i++)
+				probes.push_back(rows[rng() % count].key());
+
+			const auto path = std::filesystem::temp_directory_path() / "lux_benchmark_image.bin";
+			lux::save_image(sv_type(rows.begin(), rows.end()), path);
+
+			size_t rebuilt_hits = 0, mapped_hits = 0;
+			report("rebuild from rows and lookups", time_ms([&]() {
+				sv_type sv(rows.begin(), rows.end());
+				for (auto probe : probes)
+					rebuilt_hits += sv.contains(probe);
+			}));
+			report("map the image and lookups", time_ms([&]() {
+				lux::mapped_sorted_vector<uint64_t, simple_t> mv{ path };
+				for (auto probe : probes)
+					mapped_hits += mv.contains(probe);
+			}));
+			report("map the image with checksum and lookups", time_ms([&]() {
+				lux::mapped_sorted_vector<uint64_t, simple_t> mv{ path, lux::image_check::checksum };
+				for (auto probe : probes)
+					mv.contains(probe);
+			}));
+			std::filesystem::remove(path);
+
+			Assert::AreEqual(probes.size(), rebuilt_hits, L"lookup mismatch");
+			Assert::AreEqual(probes.size(), mapped_hits, L"lookup mismatch");
+		}
+
+		template< class Search >
+		static size_t time_learned(const char* name, const std::vector<uint64_t>& keys, const std::vector<uint64_t>& probes) {
+			set_type<uint64_t, Search> sv;
+			sv.insert(keys.begin(), keys.end());
+
+			// learned_search trains its model after keys.size() / 32 lookups, the warm-up runs past that point
+			const auto warm_count = std::max(probes.size(), keys.size() / 32 + 1);
+			size_t warm = 0, steady = 0;
+			report(std::string(name) + " warm-up", time_ms([&]() {
+				for (size_t i = 0; i < warm_count; i++)
+					warm += sv.contains(probes[i % probes.size()]);
+			}), warm_count);
+			if constexpr (requires { sv.search_policy().trained(); })
+				Assert::IsTrue(sv.search_policy().trained(), L"the warm-up must train the model");
+
+			report(std::string(name) + " steady state", time_ms([&]() {
+				for (auto probe : probes)
+					steady += sv.contains(probe);
+			}), probes.size());
+			return steady;
+		}
+
+		TEST_METHOD(learned_lookup) {
+			// the steady state pass compares the trained model against binary search, the training is in the warm-up
+			constexpr size_t count = 10'000'000;
+
+			std::mt19937_64 rng{ 42 };
+			std::vector<uint64_t> keys, probes;
+			uint64_t key = 0;
+			for (size_t i = 0; i < count; i++)
+				keys.push_back(key += 1 + rng() % 64);
+			for (size_t i = 0; i < 1'000'000; i++)
+				probes.push_back(rng() % key);
+
+			const auto hits = time_learned<lux::binary_search>("binary_search", keys, probes);
+			Assert::AreEqual(hits, time_learned<lux::default_search>("default_search", keys, probes), L"lookup mismatch");
+			Assert::AreEqual(hits, time_learned<lux::learned_search<>>("learned_search", keys, probes), L"lookup mismatch");
+		}
+
+		TEST_METHOD(hinted_insertion) {
+			using sv_type = lux::sorted_vector<simple_t, simple_t>;
+			constexpr size_t count = 1'000'000;
+
+			// a monotonic stream, and one where every key is up to 16 places away from its sorted position
+			std::mt19937 rng{ 42 };
+			std::vector<simple_t> monotonic(count), nearly(count);
+			for (size_t i = 0; i < count; i++)
+				monotonic[i] = nearly[i] = static_cast<simple_t>(i);
+			for (size_t i = 0; i + 16 < count; i += 16)
+				std::shuffle(nearly.begin() + i, nearly.begin() + i + 16, rng);
+
+			for (const auto& [name, keys] : { std::pair{ "monotonic", &monotonic }, std::pair{ "nearly sorted", &nearly } }) {
+				sv_type plain, at_end, previous;
+				report(std::string(name) + " emplace", time_ms([&]() {
+					for (auto key : *keys)
+						plain.emplace(key, key);
+				}), count);
+				report(std::string(name) + " emplace_hint end()", time_ms([&]() {
+					for (auto key : *keys)
+						at_end.emplace_hint(at_end.end(), key, key);
+				}), count);
+				report(std::string(name) + " emplace_hint previous", time_ms([&]() {
+					auto hint = previous.end();
+					for (auto key : *keys)
+						hint = previous.emplace_hint(hint, key, key) + 1;
+				}), count);
+				Assert::AreEqual(plain.size(), at_end.size(), L"size mismatch");
+				Assert::AreEqual(plain.size(), previous.size(), L"size mismatch");
+			}
+		}
+	};
+
+}
@@ -0,0 +1,231 @@
+#include "head.h"
+
+namespace lux::test::containers
+{
+
+	TEST_CLASS(buffered_sorted_vector)
+	{
+		using sv_type = lux::sorted_vector<simple_t, simple_t>;
+		using bv_type = lux::buffered_sorted_vector<simple_t, simple_t>;
+
+		static void compare(const sv_type& sv, bv_type& bv) {
+			Assert::AreEqual(sv.size(), bv.size(), L"size mismatch");
+
+			auto s_it = sv.begin();
+			for (auto b_it = bv.begin(); b_it != bv.end(); ++b_it, ++s_it) {
+				Assert::AreEqual(s_it->key(), b_it->key(), L"order mismatch");
+				Assert::AreEqual(s_it->value(), b_it->value(), L"values mismatch");
+			}
+			Assert::AreEqual(size_t(0), bv.buffered(), L"iteration must flush the buffer");
+		}
+
+	public:
+		buffered_sorted_vector() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(insertion) {
+			for (size_t threshold : { 1, 7, 64, 1000 }) {
+				sv_type sv;
+				bv_type bv{ threshold };
+
+				for (size_t i = 0; i < 2000; i++) {
+					auto key = rand() % 1000;
+					auto val = rand();
+					auto [it, inserted] = bv.emplace(key, val);
+					Assert::AreEqual(sv.emplace(key, val).second, inserted, L"emplace mismatch");
+					Assert::AreEqual(sv.at(key), it->value(), L"emplace iterator mismatch");
+					Assert::IsTrue(bv.buffered() < threshold, L"buffer over the threshold");
+				}
+				compare(sv, bv);
+			}
+		}
+
+		TEST_METHOD(lookup) {
+			sv_type sv;
+			bv_type bv{ 100 };
+
+			for (size_t i = 0; i < 1000; i++) {
+				auto key = rand() % 2000;
+				auto val = rand();
+				sv.emplace(key, val), bv.emplace(key, val);
+
+				// some of the keys are in the buffer, the others are merged
+				auto probe = rand() % 2000;
+				Assert::AreEqual(sv.contains(probe), bv.contains(probe), L"contains mismatch");
+				Assert::AreEqual(sv.count(probe), bv.count(probe), L"count mismatch");
+				const auto& cbv = bv;
+				if (sv.contains(probe)) {
+					Assert::AreEqual(sv.at(probe), bv.at(probe), L"at mismatch");
+					Assert::AreEqual(sv.at(probe), bv.find(probe)->value(), L"find mismatch");
+					Assert::AreEqual(sv.at(probe), cbv.at(probe), L"const at mismatch");
+					Assert::AreEqual(sv.at(probe), cbv.find(probe)->value(), L"const find mismatch");
+				}
+				else {
+					Assert::IsTrue(cbv.find(probe) == cbv.end(), L"const find mismatch");
+					Assert::IsTrue(bv.find(probe) == bv.end(), L"find mismatch");
+				}
+			}
+
+			Assert::ExpectException<std::out_of_range>([&]() { bv.at(-1); }, L"at with a missing key must throw");
+			Assert::ExpectException<std::out_of_range>([&]() { std::as_const(bv).at(-1); }, L"const at with a missing key must throw");
+		}
+
+		TEST_METHOD(modifiers) {
+			sv_type sv;
+			bv_type bv{ 50 };
+
+			for (size_t i = 0; i < 3000; i++) {
+				auto key = rand() % 500;
+				auto val = rand();
+				switch (rand() % 5) {
+				case 0:
+					Assert::AreEqual(sv.erase(key), bv.erase(key), L"erase mismatch");
+					break;
+				case 1:
+					Assert::AreEqual(sv.insert_or_assign(key, val).second, bv.insert_or_assign(key, val).second, L"insert_or_assign mismatch");
+					break;
+				case 2:
+					Assert::AreEqual(sv.try_emplace(key, val).second, bv.try_emplace(key, val).second, L"try_emplace mismatch");
+					break;
+				case 3:
+					sv[key] += 1, bv[key] += 1;
+					break;
+				default:
+					sv.emplace(key, val), bv.emplace(key, val);
+					break;
+				}
+				Assert::AreEqual(sv.size(), bv.size(), L"size mismatch");
+			}
+			compare(sv, bv);
+
+			std::vector<sv_type::value_type> range;
+			for (size_t i = 0; i < 200; i++)
+				range.emplace_back(rand() % 1000, rand());
+			bv.emplace(2000, 0), sv.emplace(2000, 0);
+			sv.insert(range.begin(), range.end());
+			bv.insert(range.begin(), range.end());
+			compare(sv, bv);
+
+			bv.clear();
+			Assert::IsTrue(bv.empty(), L"clear failed");
+		}
+
+		TEST_METHOD(complex_keys) {
+			lux::sorted_vector<complex_t> sv;
+			lux::buffered_sorted_vector<complex_t> bv{ 16 };
+
+			for (size_t i = 0; i < 500; i++) {
+				complex_t key{ rand() % 20, rand() % 20 };
+				Assert::AreEqual(sv.emplace(key).second, bv.emplace(key).second, L"emplace mismatch");
+				Assert::IsTrue(bv.contains(key), L"contains failed");
+			}
+
+			auto& sorted = bv.sorted();
+			Assert::AreEqual(sv.size(), sorted.size(), L"size mismatch");
+			for (size_t i = 0; i < sv.size(); i++)
+				Assert::AreEqual(sv.vector()[i].key(), sorted.vector()[i].key(), L"order mismatch");
+		}
+
+		TEST_METHOD(buffered_find) {
+			lux::buffered_sorted_vector<simple_t, std::string> bv{ 100 };
+			for (simple_t i = 0; i < 10; i++)
+				bv.try_emplace(i * 2, std::to_string(i * 2) + " is a string too long for the small buffer");
+			bv.flush();
+			bv.try_emplace(5, "five is a string too long for the small buffer");
+			Assert::AreEqual(size_t(1), bv.buffered(), L"entry not buffered");
+
+			// find merges the buffer, so comparing its result with end() must not move the entry out of it
+			auto it = bv.find(5);
+			Assert::IsTrue(it != bv.end(), L"find missed a buffered entry");
+			Assert::AreEqual(std::string("five is a string too long for the small buffer"), it->value(), L"buffered entry moved");
+			Assert::AreEqual(size_t(0), bv.buffered(), L"find must merge the buffer");
+
+			auto sorted_it = bv.find(4);
+			Assert::IsTrue(sorted_it != bv.end(), L"find missed a sorted entry");
+			Assert::AreEqual(std::string("4 is a string too long for the small buffer"), sorted_it->value(), L"sorted entry mismatch");
+
+			bv.try_emplace(7, "seven");
+			Assert::IsTrue(bv.find(9) == bv.end(), L"a miss must return end()");
+
+			const auto& cbv = bv;
+			bv.try_emplace(9, "nine");
+			auto cit = cbv.find(9);
+			Assert::IsTrue(cit != cbv.end(), L"const find missed a buffered entry");
+			Assert::AreEqual(std::string("nine"), cit->value(), L"const find mismatch");
+		}
+
+		TEST_METHOD(iterator_pair) {
+			bv_type bv{ 100 };
+			for (simple_t i = 0; i < 40; i++)
+				bv.emplace(i * 3 % 40, i);
+			Assert::AreEqual(size_t(40), bv.buffered(), L"entries not buffered");
+
+			// the iterators are valid whichever end is taken first
+			auto last = bv.end();
+			auto first = bv.begin();
+			Assert::AreEqual(ptrdiff_t(40), last - first, L"end() taken before begin() must stay valid");
+
+			bv.emplace(100, 0);
+			std::vector<bv_type::value_type> copy(bv.begin(), bv.end());
+			Assert::AreEqual(size_t(41), copy.size(), L"range copy mismatch");
+
+			bv.emplace(101, 0);
+			const auto& cbv = bv;
+			simple_t prev = -1;
+			size_t count = 0;
+			for (auto cit = cbv.cbegin(); cit != cbv.cend(); ++cit, ++count) {
+				Assert::IsTrue(prev < cit->key(), L"const iteration order mismatch");
+				prev = cit->key();
+			}
+			Assert::AreEqual(size_t(42), count, L"const iteration must see the buffered entries");
+		}
+
+		struct throwing_t
+		{
+			throwing_t(simple_t value)
+				: value(value) {
+			}
+			throwing_t(const throwing_t& other)
+				: value(other.value) {
+				if (--copies_left == 0)
+					throw std::runtime_error("copy failed");
+			}
+			throwing_t& operator=(const throwing_t&) = default;
+
+			simple_t value;
+			static inline size_t copies_left = 0;
+		};
+
+		TEST_METHOD(flush_guarantee) {
+			// without a noexcept move the entries are copied, a failed copy must leave the container unchanged
+			lux::buffered_sorted_vector<simple_t, throwing_t> bv{ 1000 };
+			for (simple_t i = 0; i < 200; i++)
+				bv.emplace(i * 2, throwing_t(i));
+			bv.flush();
+			for (simple_t i = 0; i < 100; i++)
+				bv.emplace(i * 2 + 1, throwing_t(-i));
+			Assert::AreEqual(size_t(100), bv.buffered(), L"entries not buffered");
+
+			throwing_t::copies_left = 150;
+			Assert::ExpectException<std::runtime_error>([&]() { bv.flush(); }, L"the copy must throw");
+			throwing_t::copies_left = 0;
+
+			Assert::AreEqual(size_t(300), bv.size(), L"a failed flush lost entries");
+			Assert::AreEqual(size_t(100), bv.buffered(), L"a failed flush must keep the buffer");
+			for (simple_t i = 0; i < 100; i++) {
+				Assert::AreEqual(i, bv.at(i * 2).value, L"sorted entry changed");
+				Assert::AreEqual(-i, bv.at(i * 2 + 1).value, L"buffered entry changed");
+			}
+
+			bv.flush();
+			simple_t prev = -1;
+			for (const auto& entry : bv) {
+				Assert::IsTrue(prev < entry.key(), L"order mismatch");
+				prev = entry.key();
+			}
+			Assert::AreEqual(simple_t(398), prev, L"merge mismatch");
+		}
+	};
+
+}
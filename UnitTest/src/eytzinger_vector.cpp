@@ -0,0 +1,112 @@
+#include "head.h"
+
+#include <array>
+
+namespace lux::test::containers
+{
+
+	TEST_CLASS(eytzinger_vector)
+	{
+		using sv_type = lux::sorted_vector<simple_t, simple_t>;
+		using ev_type = lux::eytzinger_vector<simple_t, simple_t>;
+
+		static sv_type generate(size_t count) {
+			sv_type sv;
+			for (size_t i = 0; i < count; i++)
+				sv.emplace(rand() % 10000, rand());
+			return sv;
+		}
+
+		static void compare(const sv_type& sv, const ev_type& ev) {
+			Assert::AreEqual(sv.size(), ev.size(), L"size mismatch");
+
+			auto s_it = sv.begin();
+			for (auto e_it = ev.begin(); e_it != ev.end(); ++e_it, ++s_it) {
+				Assert::AreEqual(s_it->key(), e_it->key(), L"order mismatch");
+				Assert::AreEqual(s_it->value(), e_it->value(), L"values mismatch");
+			}
+			Assert::IsTrue(s_it == sv.end(), L"iteration too short");
+		}
+
+	public:
+		eytzinger_vector() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(iteration) {
+			for (size_t len : { 0, 1, 2, 3, 7, 8, 100, 1000 }) {
+				auto sv = generate(len);
+				ev_type ev{ sv };
+				compare(sv, ev);
+
+				// reverse iteration
+				auto s_it = sv.rbegin();
+				for (auto e_it = ev.rbegin(); e_it != ev.rend(); ++e_it, ++s_it)
+					Assert::AreEqual(s_it->key(), e_it->key(), L"reverse order mismatch");
+			}
+		}
+
+		TEST_METHOD(search) {
+			for (size_t len : { 0, 1, 5, 100, 1000 }) {
+				auto sv = generate(len);
+				ev_type ev{ sv };
+
+				for (simple_t key = -1; key <= 10000; key += 3) {
+					auto lb = ev.lower_bound(key);
+					auto ub = ev.upper_bound(key);
+					auto s_lb = sv.lower_bound(key);
+					auto s_ub = sv.upper_bound(key);
+
+					Assert::AreEqual(s_lb == sv.end(), lb == ev.end(), L"lower_bound mismatch");
+					if (lb != ev.end())
+						Assert::AreEqual(s_lb->key(), lb->key(), L"lower_bound mismatch");
+					Assert::AreEqual(s_ub == sv.end(), ub == ev.end(), L"upper_bound mismatch");
+					if (ub != ev.end())
+						Assert::AreEqual(s_ub->key(), ub->key(), L"upper_bound mismatch");
+
+					Assert::AreEqual(sv.contains(key), ev.contains(key), L"contains mismatch");
+					auto range = ev.equal_range(key);
+					Assert::AreEqual(size_t(sv.contains(key)), size_t(std::distance(range.first, range.second)), L"equal_range mismatch");
+					if (sv.contains(key))
+						Assert::AreEqual(sv.at(key), ev.at(key), L"at mismatch");
+				}
+			}
+		}
+
+		TEST_METHOD(round_trip) {
+			auto sv = generate(500);
+			ev_type ev{ sv };
+
+			auto copy = ev.to_sorted_vector();
+			Assert::IsTrue(copy.vector().size() == sv.size(), L"copy size mismatch");
+			compare(copy, ev);
+
+			auto moved = ev_type{ std::move(copy) }.to_sorted_vector();
+			compare(moved, ev);
+		}
+
+		template< class Value >
+		static void check_entry_size() {
+			lux::sorted_vector<simple_t, Value> sv;
+			for (simple_t i = 0; i < 3000; i++)
+				sv.emplace(i * 2, Value{ i });
+			lux::eytzinger_vector<simple_t, Value> ev{ sv };
+
+			for (simple_t key = -1; key <= 6001; key++) {
+				auto lb = ev.lower_bound(key);
+				const auto expected = std::max(key + (key & 1), 0);
+				Assert::AreEqual(expected > 5998, lb == ev.end(), L"lower_bound mismatch");
+				if (lb != ev.end())
+					Assert::AreEqual(expected, lb->key(), L"lower_bound mismatch");
+				Assert::AreEqual(sv.contains(key), ev.contains(key), L"contains mismatch");
+			}
+		}
+
+		TEST_METHOD(entry_size) {
+			// 12 and 24 byte entries do not divide a cache line, the prefetch distance is rounded down to a power of two
+			check_entry_size<std::array<simple_t, 2>>();
+			check_entry_size<std::array<simple_t, 5>>();
+		}
+	};
+
+}
@@ -0,0 +1,92 @@
+#include "head.h"
+
+#include <map>
+
+namespace lux::test::containers
+{
+
+	namespace
+	{
+
+		constexpr auto opcodes = lux::make_frozen_map<simple_t, simple_t>({
+			{ 0x90, 1 }, { 0x01, 2 }, { 0xc3, 3 }, { 0x55, 4 }, { 0x48, 5 }, { 0x89, 6 }, { 0xe8, 7 }, { 0x31, 8 }
+		});
+
+		static_assert(opcodes.size() == 8);
+		static_assert(opcodes.hashed());
+		static_assert(opcodes.at(0xc3) == 3);
+		static_assert(opcodes.contains(0x55) && !opcodes.contains(0x56));
+		static_assert(opcodes.begin()->first == 0x01);
+
+		constexpr auto words = lux::make_frozen_set<std::string_view>({ "delta", "alpha", "charlie", "bravo" });
+
+		static_assert(!words.hashed());
+		static_assert(words.contains("charlie") && !words.contains("echo"));
+		static_assert(*words.begin() == "alpha");
+
+	}
+
+	TEST_CLASS(frozen_vector)
+	{
+		template< size_t N >
+		static void check(simple_t spread) {
+			std::array<std::pair<simple_t, simple_t>, N> data{};
+			std::vector<simple_t> keys;
+			for (size_t i = 0; i < N; i++) {
+				simple_t key;
+				do key = rand() % spread - spread / 2;
+				while (std::find(keys.begin(), keys.end(), key) != keys.end());
+				keys.push_back(key);
+				data[i] = { key, rand() };
+			}
+
+			lux::frozen_map<simple_t, simple_t, N> fm{ data };
+			Assert::IsTrue(std::is_sorted(fm.begin(), fm.end()), L"not sorted");
+			Assert::IsTrue(N == 0 || fm.hashed(), L"the perfect hash was not built");
+
+			std::map<simple_t, simple_t> expected(data.begin(), data.end());
+			for (simple_t key = -spread / 2 - 1; key <= spread / 2 + 1; key++) {
+				Assert::AreEqual(expected.contains(key), fm.contains(key), L"contains mismatch");
+				Assert::AreEqual(size_t(std::distance(expected.begin(), expected.lower_bound(key))), size_t(fm.lower_bound(key) - fm.begin()), L"lower_bound mismatch");
+				Assert::AreEqual(size_t(std::distance(expected.begin(), expected.upper_bound(key))), size_t(fm.upper_bound(key) - fm.begin()), L"upper_bound mismatch");
+				if (expected.contains(key))
+					Assert::AreEqual(expected.at(key), fm.at(key), L"at mismatch");
+				else
+					Assert::IsTrue(fm.find(key) == fm.end(), L"find mismatch");
+			}
+		}
+
+	public:
+		frozen_vector() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(lookup) {
+			check<0>(10);
+			check<1>(10);
+			check<37>(200);
+			check<1000>(5000);
+			check<4000>(40000);
+		}
+
+		TEST_METHOD(hash) {
+			std::array<std::pair<uint64_t, simple_t>, 500> data{};
+			for (size_t i = 0; i < data.size(); i++)
+				data[i] = { uint64_t(i) << 40, simple_t(i) };
+			lux::frozen_map<uint64_t, simple_t, 500> fm{ data };
+
+			Assert::IsTrue(fm.hashed(), L"the perfect hash was not built");
+			for (size_t i = 0; i < data.size(); i++) {
+				Assert::AreEqual(simple_t(i), fm.at(uint64_t(i) << 40), L"at mismatch");
+				Assert::IsFalse(fm.contains((uint64_t(i) << 40) + 1), L"contains mismatch");
+			}
+		}
+
+		TEST_METHOD(duplicates) {
+			std::array<simple_t, 3> data{ 1, 2, 1 };
+			Assert::ExpectException<std::invalid_argument>([&]() { lux::frozen_set<simple_t, 3>{ data }; }, L"duplicated keys must throw");
+			Assert::ExpectException<std::out_of_range>([&]() { opcodes.at(0); }, L"at with a missing key must throw");
+		}
+	};
+
+}
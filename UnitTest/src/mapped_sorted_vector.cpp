@@ -0,0 +1,150 @@
+#include "head.h"
+
+#include <lux/mapped_sorted_vector.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace lux::test::containers
+{
+
+	TEST_CLASS(mapped_sorted_vector)
+	{
+		static std::filesystem::path image_path(const char* name) {
+			return std::filesystem::temp_directory_path() / name;
+		}
+
+	public:
+		mapped_sorted_vector() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(map_image) {
+			lux::sorted_vector<uint64_t, simple_t> sv;
+			for (size_t i = 0; i < 20000; i++)
+				sv.emplace(uint64_t(rand()) * 7, rand());
+
+			const auto path = image_path("lux_map_image.bin");
+			lux::save_image(sv, path);
+			{
+				lux::mapped_sorted_vector<uint64_t, simple_t> mv{ path, lux::image_check::checksum };
+				Assert::AreEqual(sv.size(), mv.size(), L"size mismatch");
+
+				auto s_it = sv.begin();
+				for (auto m_it = mv.begin(); m_it != mv.end(); ++m_it, ++s_it) {
+					Assert::AreEqual(s_it->key(), m_it->key(), L"order mismatch");
+					Assert::AreEqual(s_it->value(), m_it->value(), L"values mismatch");
+				}
+
+				for (size_t i = 0; i < 2000; i++) {
+					auto probe = uint64_t(rand()) * 7 + rand() % 2;
+					Assert::AreEqual(sv.contains(probe), mv.contains(probe), L"contains mismatch");
+					Assert::AreEqual(sv.count(probe), mv.count(probe), L"count mismatch");
+					Assert::AreEqual(size_t(sv.lower_bound(probe) - sv.begin()), size_t(mv.lower_bound(probe) - mv.begin()), L"lower_bound mismatch");
+					Assert::AreEqual(size_t(sv.upper_bound(probe) - sv.begin()), size_t(mv.upper_bound(probe) - mv.begin()), L"upper_bound mismatch");
+					if (sv.contains(probe)) {
+						Assert::AreEqual(sv.at(probe), mv.at(probe), L"at mismatch");
+						Assert::AreEqual(sv.at(probe), mv.find(probe)->value(), L"find mismatch");
+					}
+					else
+						Assert::IsTrue(mv.find(probe) == mv.end(), L"find mismatch");
+				}
+
+				Assert::ExpectException<std::out_of_range>([&]() { mv.at(1); }, L"at with a missing key must throw");
+			}
+			std::filesystem::remove(path);
+		}
+
+		TEST_METHOD(set_image) {
+			lux::sorted_vector<simple_t> sv;
+			for (size_t i = 0; i < 5000; i++)
+				sv.emplace(rand() % 100000);
+
+			lux::split_sorted_vector<simple_t, double> split;
+			for (size_t i = 0; i < 1000; i++)
+				split.emplace(rand() % 5000, rand() / 3.0);
+
+			const auto set_path = image_path("lux_set_image.bin");
+			const auto split_path = image_path("lux_split_image.bin");
+			lux::save_image(sv, set_path);
+			lux::save_image(split, split_path);
+			{
+				lux::mapped_sorted_vector<simple_t> mv{ set_path };
+				Assert::AreEqual(sv.size(), mv.size(), L"size mismatch");
+				for (size_t i = 0; i < sv.size(); i++)
+					Assert::AreEqual(sv.vector()[i].key(), mv.begin()[i], L"order mismatch");
+				for (simple_t probe = 0; probe < 1000; probe++)
+					Assert::AreEqual(sv.contains(probe), mv.contains(probe), L"contains mismatch");
+
+				lux::mapped_sorted_vector<simple_t, double> ms{ split_path };
+				Assert::IsTrue(std::ranges::equal(split.keys(), ms.keys()), L"keys mismatch");
+				Assert::IsTrue(std::ranges::equal(split.values(), ms.values()), L"values mismatch");
+			}
+			std::filesystem::remove(set_path);
+			std::filesystem::remove(split_path);
+
+			lux::sorted_vector<simple_t, simple_t> empty;
+			const auto empty_path = image_path("lux_empty_image.bin");
+			lux::save_image(empty, empty_path);
+			{
+				lux::mapped_sorted_vector<simple_t, simple_t> mv{ empty_path, lux::image_check::checksum };
+				Assert::IsTrue(mv.empty(), L"empty image mismatch");
+				Assert::IsFalse(mv.contains(0), L"contains mismatch");
+			}
+			std::filesystem::remove(empty_path);
+		}
+
+		TEST_METHOD(invalid_images) {
+			lux::sorted_vector<simple_t, simple_t> sv;
+			for (simple_t i = 0; i < 1000; i++)
+				sv.emplace(i, i);
+
+			const auto path = image_path("lux_invalid_image.bin");
+			lux::save_image(sv, path);
+
+			Assert::ExpectException<std::runtime_error>([&]() {
+				lux::mapped_sorted_vector<int64_t, simple_t> mv{ path };
+			}, L"a layout mismatch must throw");
+			Assert::ExpectException<std::runtime_error>([&]() {
+				lux::mapped_sorted_vector<simple_t> mv{ path };
+			}, L"a layout mismatch must throw");
+			Assert::ExpectException<std::runtime_error>([&]() {
+				lux::mapped_sorted_vector<simple_t, simple_t> mv{ image_path("lux_missing_image.bin") };
+			}, L"a missing file must throw");
+
+			// corrupt one value
+			{
+				std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+				file.seekp(-1, std::ios::end);
+				file.put('\x7f');
+			}
+			{
+				lux::mapped_sorted_vector<simple_t, simple_t> mv{ path };
+				Assert::IsFalse(mv.verify(), L"the corruption must fail the checksum");
+			}
+			Assert::ExpectException<std::runtime_error>([&]() {
+				lux::mapped_sorted_vector<simple_t, simple_t> mv{ path, lux::image_check::checksum };
+			}, L"a checksum mismatch must throw");
+
+			// a count whose offsets wrap around to the ones of the real count
+			lux::save_image(sv, path);
+			{
+				const uint64_t count = (uint64_t(1) << 62) + 1000;
+				std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+				file.seekp(offsetof(lux::_impls::_image_header, count));
+				file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+			}
+			Assert::ExpectException<std::runtime_error>([&]() {
+				lux::mapped_sorted_vector<simple_t, simple_t> mv{ path };
+			}, L"an overflowing count must throw");
+
+			std::filesystem::resize_file(path, 200);
+			Assert::ExpectException<std::runtime_error>([&]() {
+				lux::mapped_sorted_vector<simple_t, simple_t> mv{ path };
+			}, L"a truncated image must throw");
+
+			std::filesystem::remove(path);
+		}
+	};
+
+}
@@ -0,0 +1,161 @@
+#include "head.h"
+
+namespace lux::test::containers
+{
+
+	TEST_CLASS(packed_sorted_set)
+	{
+		template< class Key, size_t BlockSize >
+		static void compare(const lux::sorted_vector<Key>& sv, const lux::packed_sorted_set<Key, BlockSize>& ps) {
+			Assert::AreEqual(sv.size(), ps.size(), L"size mismatch");
+
+			auto s_it = sv.begin();
+			for (auto key : ps) {
+				Assert::AreEqual(s_it->key(), key, L"order mismatch");
+				++s_it;
+			}
+			Assert::IsTrue(s_it == sv.end(), L"iteration incomplete");
+
+			for (size_t i = 0; i < sv.size(); i += 1 + rand() % 50)
+				Assert::AreEqual(sv.vector()[i].key(), ps.select(i), L"select mismatch");
+		}
+
+		template< class Key, size_t BlockSize >
+		static void probe(const lux::sorted_vector<Key>& sv, const lux::packed_sorted_set<Key, BlockSize>& ps, Key key) {
+			Assert::AreEqual(sv.contains(key), ps.contains(key), L"contains mismatch");
+			Assert::AreEqual(sv.count(key), ps.count(key), L"count mismatch");
+			Assert::AreEqual(size_t(sv.lower_bound(key) - sv.begin()), ps.rank(key), L"rank mismatch");
+			Assert::AreEqual(size_t(sv.lower_bound(key) - sv.begin()), ps.lower_bound(key).index(), L"lower_bound mismatch");
+			Assert::AreEqual(size_t(sv.upper_bound(key) - sv.begin()), ps.upper_bound(key).index(), L"upper_bound mismatch");
+			if (sv.lower_bound(key) != sv.end())
+				Assert::AreEqual(sv.lower_bound(key)->key(), *ps.lower_bound(key), L"lower_bound value mismatch");
+			if (sv.contains(key))
+				Assert::AreEqual(key, *ps.find(key), L"find mismatch");
+			else
+				Assert::IsTrue(ps.find(key) == ps.end(), L"find mismatch");
+		}
+
+	public:
+		packed_sorted_set() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(dense_ids) {
+			lux::sorted_vector<uint64_t> sv;
+			uint64_t key = 1'000'000'000'000ull;
+			for (size_t i = 0; i < 100000; i++) {
+				key += 1 + rand() % 4;
+				sv.emplace(key);
+			}
+
+			lux::packed_sorted_set<uint64_t> ps{ sv };
+			compare(sv, ps);
+			for (size_t i = 0; i < 5000; i++)
+				probe(sv, ps, sv.vector()[rand() % sv.size()].key() + rand() % 3);
+			probe(sv, ps, uint64_t(0));
+			probe(sv, ps, uint64_t(-1));
+
+			// gaps up to 4 need 2 bits per key, plus the block index
+			Assert::IsTrue(ps.memory_usage() < sv.size() / 2, L"keys are not compressed");
+			Assert::ExpectException<std::out_of_range>([&]() { ps.select(ps.size()); }, L"select past the end must throw");
+		}
+
+		TEST_METHOD(sparse_keys) {
+			lux::sorted_vector<uint32_t> sv;
+			std::vector<uint32_t> input;
+			for (size_t i = 0; i < 20000; i++)
+				input.push_back(uint32_t(rand()) * uint32_t(rand()));
+			// the widest possible gaps
+			input.push_back(0), input.push_back(uint32_t(-1));
+			sv.insert(input.begin(), input.end());
+
+			lux::packed_sorted_set<uint32_t, 16> ps(input.begin(), input.end());
+			compare(sv, ps);
+			for (size_t i = 0; i < 5000; i++)
+				probe(sv, ps, uint32_t(rand()) * uint32_t(rand()));
+			probe(sv, ps, uint32_t(-1));
+		}
+
+		TEST_METHOD(widths) {
+			// gaps of up to 1 << bits need bits bits, the word decoding covers the widths that divide 64
+			for (unsigned bits = 0; bits <= 40; bits++) {
+				lux::sorted_vector<uint64_t> sv;
+				uint64_t key = uint64_t(rand());
+				for (size_t i = 0; i < 1000; i++) {
+					key += 1 + (bits == 0 ? 0 : (uint64_t(rand()) * uint64_t(rand())) % (uint64_t(1) << bits));
+					sv.emplace(key);
+				}
+
+				lux::packed_sorted_set<uint64_t, 100> ps{ sv };
+				compare(sv, ps);
+				for (const auto& entry : sv) {
+					probe(sv, ps, entry.key() - 1);
+					probe(sv, ps, entry.key());
+					probe(sv, ps, entry.key() + 1);
+				}
+				probe(sv, ps, uint64_t(-1));
+			}
+		}
+
+		TEST_METHOD(map) {
+			lux::sorted_vector<uint32_t, uint32_t> sv;
+			uint32_t key = 1000;
+			for (size_t i = 0; i < 50000; i++) {
+				key += 1 + rand() % 3;
+				sv.emplace(key, uint32_t(rand()));
+			}
+
+			lux::packed_sorted_map<uint32_t, uint32_t> pm{ sv };
+			Assert::AreEqual(sv.size(), pm.size(), L"size mismatch");
+			auto s_it = sv.begin();
+			for (auto [k, v] : pm) {
+				Assert::AreEqual(s_it->key(), k, L"order mismatch");
+				Assert::AreEqual(s_it->value(), v, L"values mismatch");
+				++s_it;
+			}
+
+			for (size_t i = 0; i < 5000; i++) {
+				const auto probe = uint32_t(1000 + rand() % (key - 990));
+				Assert::AreEqual(sv.contains(probe), pm.contains(probe), L"contains mismatch");
+				Assert::AreEqual(size_t(sv.lower_bound(probe) - sv.begin()), pm.lower_bound(probe).index(), L"lower_bound mismatch");
+				if (sv.contains(probe)) {
+					Assert::AreEqual(sv.at(probe), pm.at(probe), L"at mismatch");
+					Assert::AreEqual(sv.at(probe), pm.find(probe).value(), L"find mismatch");
+				}
+				else {
+					Assert::IsTrue(pm.find(probe) == pm.end(), L"find mismatch");
+					Assert::ExpectException<std::out_of_range>([&]() { pm.at(probe); }, L"at with a missing key must throw");
+				}
+			}
+			Assert::IsTrue(pm.memory_usage() < sv.size() * sizeof(uint32_t) * 3 / 2, L"keys are not compressed");
+
+			lux::packed_sorted_map<uint64_t, simple_t> small{ { 5, 50 }, { 1, 10 }, { 5, 51 } };
+			Assert::AreEqual(size_t(2), small.size(), L"duplicates must be dropped");
+			Assert::AreEqual(50, small.at(5), L"the first of equal keys must be kept");
+		}
+
+		TEST_METHOD(small_sets) {
+			lux::packed_sorted_set<uint32_t> empty;
+			Assert::IsTrue(empty.empty(), L"empty mismatch");
+			Assert::IsTrue(empty.begin() == empty.end(), L"empty iteration mismatch");
+			Assert::IsFalse(empty.contains(0), L"contains mismatch");
+			Assert::AreEqual(size_t(0), empty.rank(10), L"rank mismatch");
+
+			for (size_t n = 1; n < 40; n++) {
+				lux::sorted_vector<uint32_t> sv;
+				for (size_t i = 0; i < n; i++)
+					sv.emplace(uint32_t(rand() % 100));
+
+				lux::packed_sorted_set<uint32_t, 8> ps{ sv };
+				compare(sv, ps);
+				for (uint32_t key = 0; key < 101; key++)
+					probe(sv, ps, key);
+			}
+
+			lux::packed_sorted_set<uint64_t> ps{ 5, 1, 3, 3, 1 };
+			Assert::AreEqual(size_t(3), ps.size(), L"duplicates must be dropped");
+			Assert::AreEqual(uint64_t(5), ps.select(2), L"select mismatch");
+		}
+	};
+
+}
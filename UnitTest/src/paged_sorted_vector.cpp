@@ -0,0 +1,271 @@
+#include "head.h"
+
+namespace lux::test::containers
+{
+
+	TEST_CLASS(paged_sorted_vector)
+	{
+		using sv_type = lux::sorted_vector<simple_t, simple_t>;
+		using pv_type = lux::paged_sorted_vector<simple_t, simple_t>;
+
+		static void compare(const sv_type& sv, const pv_type& pv) {
+			Assert::AreEqual(sv.size(), pv.size(), L"size mismatch");
+
+			auto s_it = sv.begin();
+			for (auto p_it = pv.begin(); p_it != pv.end(); ++p_it, ++s_it) {
+				Assert::AreEqual(s_it->key(), p_it->key(), L"order mismatch");
+				Assert::AreEqual(s_it->value(), p_it->value(), L"values mismatch");
+			}
+			Assert::IsTrue(s_it == sv.end(), L"iteration too short");
+
+			auto rs_it = sv.rbegin();
+			for (auto rp_it = pv.rbegin(); rp_it != pv.rend(); ++rp_it, ++rs_it)
+				Assert::AreEqual(rs_it->key(), rp_it->key(), L"reverse order mismatch");
+		}
+
+	public:
+		paged_sorted_vector() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(modifiers) {
+			sv_type sv;
+			pv_type pv;
+
+			// grow over many pages, then shrink so that the pages are merged again
+			for (int phase = 0; phase < 2; phase++) {
+				for (size_t i = 0; i < 20000; i++) {
+					auto key = rand() % 30000;
+					auto val = rand();
+					switch (rand() % (phase == 0 ? 6 : 2)) {
+					case 0:
+						Assert::AreEqual(sv.erase(key), pv.erase(key), L"erase mismatch");
+						break;
+					case 1:
+						if (phase == 1) {
+							auto it = pv.lower_bound(key);
+							if (it != pv.end()) {
+								auto next = std::next(it);
+								auto expected = next == pv.end() ? simple_t(-1) : next->key();
+								sv.erase(it->key());
+								auto res = pv.erase(it);
+								Assert::AreEqual(expected, res == pv.end() ? simple_t(-1) : res->key(), L"erase returned a wrong iterator");
+							}
+							break;
+						}
+						Assert::AreEqual(sv.insert_or_assign(key, val).second, pv.insert_or_assign(key, val).second, L"insert_or_assign mismatch");
+						break;
+					case 2:
+						Assert::AreEqual(sv.try_emplace(key, val).second, pv.try_emplace(key, val).second, L"try_emplace mismatch");
+						break;
+					case 3:
+						sv[key] += 1, pv[key] += 1;
+						break;
+					default: {
+						auto [it, inserted] = pv.emplace(key, val);
+						Assert::AreEqual(sv.emplace(key, val).second, inserted, L"emplace mismatch");
+						Assert::AreEqual(key, it->key(), L"emplace returned a wrong iterator");
+						break;
+					}
+					}
+				}
+				compare(sv, pv);
+				Assert::IsTrue(pv.page_count() * pv_type::page_capacity >= pv.size(), L"pages overflow");
+			}
+
+			pv.clear();
+			Assert::IsTrue(pv.empty() && pv.begin() == pv.end(), L"clear failed");
+		}
+
+		TEST_METHOD(lookup) {
+			sv_type sv;
+			pv_type pv;
+			for (size_t i = 0; i < 10000; i++) {
+				auto key = rand() % 50000;
+				auto val = rand();
+				sv.emplace(key, val), pv.emplace(key, val);
+			}
+
+			const auto& cpv = pv;
+			for (simple_t key = -1; key <= 50000; key += 7) {
+				Assert::AreEqual(sv.contains(key), cpv.contains(key), L"contains mismatch");
+				Assert::AreEqual(sv.count(key), cpv.count(key), L"count mismatch");
+
+				auto lb = cpv.lower_bound(key);
+				auto ub = cpv.upper_bound(key);
+				Assert::AreEqual(sv.lower_bound(key) == sv.end(), lb == cpv.end(), L"lower_bound mismatch");
+				if (lb != cpv.end())
+					Assert::AreEqual(sv.lower_bound(key)->key(), lb->key(), L"lower_bound mismatch");
+				Assert::AreEqual(sv.upper_bound(key) == sv.end(), ub == cpv.end(), L"upper_bound mismatch");
+				if (ub != cpv.end())
+					Assert::AreEqual(sv.upper_bound(key)->key(), ub->key(), L"upper_bound mismatch");
+
+				if (sv.contains(key)) {
+					Assert::AreEqual(sv.at(key), cpv.at(key), L"at mismatch");
+					Assert::AreEqual(sv.at(key), cpv.find(key)->value(), L"find mismatch");
+				}
+				else {
+					Assert::IsTrue(cpv.find(key) == cpv.end(), L"find mismatch");
+					Assert::ExpectException<std::out_of_range>([&]() { cpv.at(key); }, L"at with a missing key must throw");
+				}
+			}
+		}
+
+		TEST_METHOD(bulk_insert) {
+			sv_type sv;
+			pv_type pv;
+
+			// into an empty table, into a large one, and ranges of duplicates
+			for (size_t round = 0; round < 6; round++) {
+				std::vector<std::pair<simple_t, simple_t>> range;
+				const size_t count = round % 3 == 2 ? 50 : 8000;
+				for (size_t i = 0; i < count; i++)
+					range.emplace_back(rand() % 40000, rand());
+
+				for (const auto& [key, val] : range)
+					sv.emplace(key, val);
+				pv.insert(range.begin(), range.end());
+				compare(sv, pv);
+				Assert::IsTrue(pv.page_count() * pv_type::page_capacity >= pv.size(), L"pages overflow");
+			}
+
+			for (simple_t key = 0; key < 40000; key += 3)
+				Assert::AreEqual(sv.contains(key), pv.contains(key), L"contains mismatch");
+
+			pv_type other{ { 1, 1 } };
+			other.swap(pv);
+			compare(sv, other);
+			Assert::AreEqual(size_t(1), pv.size(), L"swap mismatch");
+			Assert::IsTrue(pv.contains(1) && !pv.contains(2), L"swap mismatch");
+		}
+
+		TEST_METHOD(hinted_insertion) {
+			sv_type sv;
+			pv_type pv;
+
+			// ascending runs with the previous result as hint, and random hints
+			auto hint = pv.cend();
+			for (simple_t i = 0; i < 20000; i++) {
+				const auto key = i % 4 == 0 ? simple_t(rand() % 40000) : i * 2;
+				sv.emplace(key, i);
+				auto it = pv.emplace_hint(hint, key, i);
+				Assert::AreEqual(key, it->key(), L"emplace_hint returned a wrong iterator");
+				hint = i % 8 == 0 ? pv.cbegin() : pv_type::const_iterator(std::next(it));
+			}
+			compare(sv, pv);
+
+			Assert::AreEqual(simple_t(-5), pv.insert(pv.cbegin(), { -5, 0 })->key(), L"insert at the front mismatch");
+			Assert::AreEqual(simple_t(100000), pv.insert(pv.cend(), { 100000, 0 })->key(), L"insert at the end mismatch");
+			Assert::AreEqual(sv.size() + 2, pv.size(), L"size mismatch");
+		}
+
+		TEST_METHOD(erase_range) {
+			sv_type sv;
+			pv_type pv;
+			for (size_t i = 0; i < 20000; i++) {
+				auto key = rand() % 40000;
+				sv.emplace(key, simple_t(i)), pv.emplace(key, simple_t(i));
+			}
+
+			// within a page, across a few pages and across many
+			for (size_t span : { 3, 300, 3000, 0 }) {
+				for (size_t round = 0; round < 10 && !sv.empty(); round++) {
+					const auto from = rand() % sv.size();
+					const auto to = std::min(sv.size(), from + span);
+					const auto first = std::next(pv.cbegin(), from), last = std::next(pv.cbegin(), to);
+
+					const auto expected = to == sv.size() ? simple_t(-1) : sv.vector()[to].key();
+					sv.erase(sv.begin() + from, sv.begin() + to);
+					auto res = pv.erase(first, last);
+					Assert::AreEqual(expected, res == pv.end() ? simple_t(-1) : res->key(), L"erase returned a wrong iterator");
+					compare(sv, pv);
+				}
+			}
+
+			auto res = pv.erase(pv.cbegin(), pv.cend());
+			Assert::IsTrue(pv.empty() && res == pv.end() && pv.page_count() == 0, L"erase of everything failed");
+		}
+
+		TEST_METHOD(transparent) {
+			lux::paged_sorted_vector<std::string, simple_t, std::less<>> pv;
+			for (simple_t i = 0; i < 2000; i++)
+				pv.emplace(std::to_string(i), i);
+
+			for (simple_t i = 0; i < 2000; i += 7) {
+				const auto key = std::to_string(i);
+				const std::string_view view = key;
+				Assert::IsTrue(pv.contains(view) && pv.count(view) == 1, L"contains mismatch");
+				Assert::AreEqual(i, pv.at(view), L"at mismatch");
+				Assert::IsTrue(pv.find(view) == pv.find(key), L"find mismatch");
+				Assert::IsTrue(pv.lower_bound(view) == pv.lower_bound(key) && pv.upper_bound(view) == pv.upper_bound(key), L"bounds mismatch");
+				Assert::IsTrue(pv.equal_range(view) == pv.equal_range(key), L"equal_range mismatch");
+			}
+			Assert::IsFalse(pv.contains(std::string_view("x")), L"contains mismatch");
+			Assert::ExpectException<std::out_of_range>([&]() { pv.at(std::string_view("x")); }, L"at with a missing key must throw");
+			Assert::AreEqual(size_t(1), pv.erase(std::string_view("7")), L"erase mismatch");
+			Assert::IsFalse(pv.contains("7"), L"erase failed");
+		}
+
+		struct throwing_key
+		{
+			throwing_key(simple_t value)
+				: value(value) {
+			}
+			throwing_key(const throwing_key& other)
+				: value(other.value) {
+				if (--copies_left == 0)
+					throw std::runtime_error("copy failed");
+			}
+			throwing_key& operator=(const throwing_key&) = default;
+
+			constexpr bool operator<(const throwing_key& other) const noexcept {
+				return value < other.value;
+			}
+
+			simple_t value;
+			static inline size_t copies_left = 0;
+		};
+
+		TEST_METHOD(split_guarantee) {
+			// the last copy of a split is the fence of the new page, if it throws the pages must stay consistent
+			using tv_type = lux::paged_sorted_vector<throwing_key, simple_t>;
+			tv_type pv;
+			const auto capacity = simple_t(tv_type::page_capacity);
+			for (simple_t i = 0; i < capacity; i++)
+				pv.emplace(i * 2, i);
+
+			// a twin counts the copies of the insertion
+			auto twin = pv;
+			throwing_key::copies_left = std::numeric_limits<size_t>::max();
+			twin.emplace(capacity + 1, -1);
+			const auto copies = std::numeric_limits<size_t>::max() - throwing_key::copies_left;
+
+			throwing_key::copies_left = copies;
+			Assert::ExpectException<std::runtime_error>([&]() { pv.emplace(capacity + 1, -1); }, L"the copy must throw");
+			throwing_key::copies_left = 0;
+
+			simple_t prev = -1;
+			size_t count = 0;
+			for (const auto& entry : pv) {
+				Assert::IsTrue(prev < entry.key().value, L"order mismatch");
+				prev = entry.key().value, count++;
+			}
+			Assert::AreEqual(pv.size(), count, L"size out of sync with the pages");
+			for (simple_t i = 0; i < capacity; i++)
+				Assert::AreEqual(i, pv.at(i * 2), L"a failed split lost an entry");
+
+			for (simple_t i = 0; i < capacity; i++)
+				pv.emplace(i * 2 + 1, -i);
+			Assert::AreEqual(size_t(capacity * 2), pv.size(), L"insertion after a failed split mismatch");
+			for (simple_t i = 0; i < capacity * 2; i++)
+				Assert::IsTrue(pv.contains(i), L"lookup after a failed split mismatch");
+		}
+
+		TEST_METHOD(set) {
+			lux::paged_sorted_vector<complex_t> ps{ { 2, 2 }, { 1, 1 }, { 2, 2 }, { 0, 5 } };
+			Assert::AreEqual(size_t(3), ps.size(), L"size mismatch");
+			Assert::IsTrue(ps.begin()->key() == complex_t{ 1, 1 }, L"order mismatch");
+		}
+	};
+
+}
@@ -0,0 +1,109 @@
+#include "head.h"
+
+#include <thread>
+
+namespace lux::test::containers
+{
+
+	TEST_CLASS(rcu)
+	{
+		using table_type = lux::rcu_sorted_vector<simple_t, simple_t>;
+
+	public:
+		TEST_METHOD(snapshot) {
+			table_type table;
+			table.update([](auto& sv) { sv.emplace(1, 1); });
+
+			auto old = table.snapshot();
+			auto count = table.update([](auto& sv) {
+				sv.emplace(2, 2);
+				sv.insert_or_assign(1, 10);
+				return sv.size();
+			});
+
+			Assert::AreEqual(size_t(2), count, L"update result mismatch");
+			Assert::AreEqual(size_t(1), old->size(), L"a held snapshot must not change");
+			Assert::AreEqual(simple_t(1), old->at(1), L"a held snapshot must not change");
+			Assert::AreEqual(simple_t(10), table.snapshot()->at(1), L"update not published");
+
+			auto&& value = table.update([](auto& sv) -> simple_t& { return sv.at(2); });
+			static_assert(std::is_same_v<decltype(value), simple_t&&>, "update must return by value");
+			Assert::AreEqual(simple_t(2), value, L"update result mismatch");
+
+			Assert::ExpectException<std::out_of_range>([&]() {
+				table.update([](auto& sv) { sv.emplace(3, 3); sv.at(4); });
+			}, L"the exception must reach the writer");
+			Assert::IsFalse(table.snapshot()->contains(3), L"a failed update must not be published");
+
+			table.publish({});
+			Assert::IsTrue(table.snapshot()->empty(), L"publish failed");
+		}
+
+		TEST_METHOD(held_snapshots) {
+			// more snapshots than a block of reader slots, each keeps the version it was taken at
+			table_type table;
+			std::vector<table_type::snapshot_type> held;
+			for (simple_t version = 0; version < simple_t(table_type::slot_block_size * 3); version++) {
+				table.update([&](auto& sv) { sv.insert_or_assign(0, version); });
+				held.push_back(table.snapshot());
+			}
+
+			for (simple_t version = 0; version < simple_t(held.size()); version++)
+				Assert::AreEqual(version, held[version]->at(0), L"a held snapshot must not change");
+
+			auto moved = std::move(held.front());
+			Assert::IsFalse(bool(held.front()), L"a moved snapshot must be empty");
+			Assert::AreEqual(simple_t(0), moved->at(0), L"a moved snapshot must keep its value");
+
+			held.clear();
+			moved.reset();
+			table.publish({});
+			Assert::IsTrue(table.snapshot()->empty(), L"publish failed");
+		}
+
+		TEST_METHOD(concurrent) {
+			// every published table maps all its keys to the same version
+			table_type table;
+			std::atomic<bool> stop = false;
+			std::atomic<size_t> failures = 0;
+
+			std::vector<std::thread> readers;
+			for (size_t i = 0; i < 4; i++) {
+				readers.emplace_back([&]() {
+					while (!stop.load()) {
+						auto snap = table.snapshot();
+						if (snap->empty())
+							continue;
+						auto version = snap->begin()->value();
+						for (auto& el : *snap) {
+							if (el.value() != version)
+								failures++;
+						}
+					}
+				});
+			}
+
+			std::vector<std::thread> writers;
+			for (simple_t w = 0; w < 2; w++) {
+				writers.emplace_back([&, w]() {
+					for (simple_t version = 0; version < 200; version++) {
+						table.update([&](auto& sv) {
+							sv.emplace((version * 31 + w * 17) % 1000, 0);
+							for (auto& el : sv)
+								el.value() = version * 2 + w;
+						});
+					}
+				});
+			}
+
+			for (auto& t : writers)
+				t.join();
+			stop = true;
+			for (auto& t : readers)
+				t.join();
+
+			Assert::AreEqual(size_t(0), failures.load(), L"a reader saw a partial update");
+		}
+	};
+
+}
@@ -0,0 +1,124 @@
+#include "head.h"
+
+#include <thread>
+
+namespace lux::test::containers
+{
+
+	TEST_CLASS(sharded_sorted_vector)
+	{
+		using sv_type = lux::sorted_vector<simple_t, simple_t>;
+		using sh_type = lux::sharded_sorted_vector<simple_t, simple_t>;
+
+	public:
+		sharded_sorted_vector() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(single_thread) {
+			for (size_t shards : { 1, 3, 16 }) {
+				sv_type sv;
+				sh_type sh{ shards };
+
+				for (size_t i = 0; i < 3000; i++) {
+					auto key = rand() % 500;
+					auto val = rand();
+					switch (rand() % 4) {
+					case 0:
+						Assert::AreEqual(sv.erase(key), sh.erase(key), L"erase mismatch");
+						break;
+					case 1:
+						Assert::AreEqual(sv.insert_or_assign(key, val).second, sh.insert_or_assign(key, val), L"insert_or_assign mismatch");
+						break;
+					case 2:
+						Assert::AreEqual(sv.contains(key), sh.visit(key, [](auto& el) { el.value() += 1; }), L"visit mismatch");
+						if (sv.contains(key))
+							sv.at(key) += 1;
+						break;
+					default:
+						Assert::AreEqual(sv.emplace(key, val).second, sh.emplace(key, val), L"emplace mismatch");
+						break;
+					}
+
+					auto probe = rand() % 500;
+					Assert::AreEqual(sv.contains(probe), sh.contains(probe), L"contains mismatch");
+					if (sv.contains(probe)) {
+						Assert::AreEqual(sv.at(probe), sh.at(probe), L"at mismatch");
+						Assert::AreEqual(sv.at(probe), sh.find(probe)->value(), L"find mismatch");
+					}
+					else
+						Assert::IsFalse(sh.find(probe).has_value(), L"find mismatch");
+				}
+				Assert::AreEqual(sv.size(), sh.size(), L"size mismatch");
+
+				auto s_it = sv.begin();
+				size_t visited = 0;
+				for (auto& el : sh.ordered()) {
+					Assert::AreEqual(s_it->key(), el.key(), L"order mismatch");
+					Assert::AreEqual(s_it->value(), el.value(), L"values mismatch");
+					++s_it, ++visited;
+				}
+				Assert::AreEqual(sv.size(), visited, L"ordered traversal incomplete");
+
+				auto snap = sh.snapshot();
+				Assert::AreEqual(sv.size(), snap.size(), L"snapshot size mismatch");
+				for (size_t i = 0; i < sv.size(); i++)
+					Assert::AreEqual(sv.vector()[i].key(), snap.vector()[i].key(), L"snapshot order mismatch");
+
+				Assert::ExpectException<std::out_of_range>([&]() { sh.at(-1); }, L"at with a missing key must throw");
+				sh.clear();
+				Assert::IsTrue(sh.empty(), L"clear failed");
+			}
+
+			Assert::ExpectException<std::invalid_argument>([]() { sh_type{ 0 }; }, L"zero shards must throw");
+		}
+
+		TEST_METHOD(concurrent) {
+			// every writer owns a disjoint key range, the readers traverse meanwhile
+			constexpr simple_t per_writer = 2000;
+			sh_type sh{ 8 };
+			std::atomic<bool> stop = false;
+			std::atomic<size_t> failures = 0;
+
+			std::vector<std::thread> readers;
+			for (size_t i = 0; i < 2; i++) {
+				readers.emplace_back([&]() {
+					while (!stop.load()) {
+						auto view = sh.ordered();
+						size_t seen = 0;
+						simple_t last = -1;
+						for (auto& el : view) {
+							if (el.key() <= last)
+								failures++;
+							last = el.key(), seen++;
+						}
+						if (seen != view.size())
+							failures++;
+					}
+				});
+			}
+
+			std::vector<std::thread> writers;
+			for (simple_t w = 0; w < 4; w++) {
+				writers.emplace_back([&, w]() {
+					for (simple_t i = 0; i < per_writer; i++)
+						sh.emplace(w * per_writer + i, w);
+					for (simple_t i = 0; i < per_writer; i += 2)
+						sh.erase(w * per_writer + i);
+				});
+			}
+
+			for (auto& t : writers)
+				t.join();
+			stop = true;
+			for (auto& t : readers)
+				t.join();
+
+			Assert::AreEqual(size_t(0), failures.load(), L"a reader saw an inconsistent view");
+			Assert::AreEqual(size_t(4 * per_writer / 2), sh.size(), L"size mismatch");
+			for (simple_t key = 0; key < 4 * per_writer; key++)
+				Assert::AreEqual(key % 2 == 1, sh.contains(key), L"contains mismatch");
+		}
+	};
+
+}
@@ -0,0 +1,118 @@
+#include "head.h"
+
+#include <map>
+
+namespace lux::test::containers
+{
+
+	TEST_CLASS(sorted_multivector)
+	{
+		using mv_type = lux::sorted_multivector<simple_t, simple_t>;
+		using ref_type = std::multimap<simple_t, simple_t>;
+
+		static void compare(const ref_type& ref, const mv_type& mv) {
+			Assert::AreEqual(ref.size(), mv.size(), L"size mismatch");
+
+			auto r_it = ref.begin();
+			for (auto m_it = mv.begin(); m_it != mv.end(); ++m_it, ++r_it) {
+				Assert::AreEqual(r_it->first, m_it->key(), L"order mismatch");
+				// std::multimap inserts at the upper bound too
+				Assert::AreEqual(r_it->second, m_it->value(), L"insertion order mismatch");
+			}
+		}
+
+	public:
+		sorted_multivector() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(insertion) {
+			ref_type ref;
+			mv_type mv;
+
+			for (simple_t i = 0; i < 2000; i++) {
+				auto key = rand() % 100;
+				ref.emplace(key, i);
+				auto it = mv.emplace(key, i);
+				Assert::AreEqual(i, it->value(), L"emplace returned a wrong iterator");
+			}
+			compare(ref, mv);
+
+			std::vector<std::pair<simple_t, simple_t>> range;
+			for (simple_t i = 0; i < 500; i++)
+				range.emplace_back(rand() % 200, -i);
+			for (auto& [key, val] : range)
+				ref.emplace(key, val);
+			mv.insert(range.begin(), range.end());
+			compare(ref, mv);
+		}
+
+		TEST_METHOD(lookup) {
+			ref_type ref;
+			mv_type mv;
+			for (simple_t i = 0; i < 3000; i++) {
+				auto key = rand() % 300;
+				ref.emplace(key, i), mv.emplace(key, i);
+			}
+
+			for (simple_t key = -1; key <= 301; key++) {
+				Assert::AreEqual(ref.count(key), mv.count(key), L"count mismatch");
+				Assert::AreEqual(ref.contains(key), mv.contains(key), L"contains mismatch");
+
+				auto [r_first, r_last] = ref.equal_range(key);
+				auto [m_first, m_last] = mv.equal_range(key);
+				Assert::AreEqual(size_t(std::distance(ref.begin(), r_first)), size_t(m_first - mv.begin()), L"equal_range mismatch");
+				Assert::AreEqual(size_t(std::distance(ref.begin(), r_last)), size_t(m_last - mv.begin()), L"equal_range mismatch");
+				Assert::IsTrue(mv.lower_bound(key) == m_first, L"lower_bound mismatch");
+				Assert::IsTrue(mv.upper_bound(key) == m_last, L"upper_bound mismatch");
+
+				auto it = mv.find(key);
+				if (ref.contains(key))
+					Assert::AreEqual(ref.find(key)->second, it->value(), L"find must return the first entry");
+				else
+					Assert::IsTrue(it == mv.end(), L"find mismatch");
+			}
+		}
+
+		TEST_METHOD(erase) {
+			ref_type ref;
+			mv_type mv;
+			for (simple_t i = 0; i < 2000; i++) {
+				auto key = rand() % 100;
+				ref.emplace(key, i), mv.emplace(key, i);
+			}
+
+			for (simple_t key = 0; key < 100; key += 3)
+				Assert::AreEqual(ref.erase(key), mv.erase(key), L"erase mismatch");
+			compare(ref, mv);
+		}
+
+		TEST_METHOD(multiset) {
+			lux::sorted_multivector<complex_t> ms{ { 1, 1 }, { 0, 0 }, { 1, 1 }, { 2, 2 }, { 1, 1 } };
+			Assert::AreEqual(size_t(5), ms.size(), L"size mismatch");
+			Assert::AreEqual(size_t(3), ms.count({ 1, 1 }), L"count mismatch");
+			Assert::AreEqual(size_t(0), ms.count({ 3, 3 }), L"count mismatch");
+			Assert::IsTrue(std::is_sorted(ms.begin(), ms.end(), [](auto& l, auto& r) { return l.key() < r.key(); }), L"not sorted");
+		}
+
+		TEST_METHOD(swap) {
+			using bloom_type = lux::sorted_multivector<simple_t, simple_t, std::less<simple_t>, std::allocator<lux::sorted_vector_type<simple_t, simple_t>>, lux::bloom_search<>>;
+
+			bloom_type left, right;
+			for (simple_t i = 0; i < 1000; i++)
+				left.emplace(i * 2, i), right.emplace(i * 2 + 1, i);
+			// enough lookups to build the filters
+			for (simple_t i = 0; i < 200; i++)
+				left.contains(i), right.contains(i);
+			Assert::IsTrue(left.search_policy().built() && right.search_policy().built(), L"the filters must be built");
+
+			left.swap(right);
+			Assert::IsFalse(left.search_policy().built() || right.search_policy().built(), L"a swap must drop the filters");
+			for (simple_t i = 0; i < 200; i++) {
+				Assert::AreEqual(i % 2 == 1, left.contains(i), L"lookup mismatch after swap");
+				Assert::AreEqual(i % 2 == 0, right.contains(i), L"lookup mismatch after swap");
+			}
+		}
+	};
+
+}
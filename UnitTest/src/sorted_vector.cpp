@@ -1,5 +1,8 @@
 #include "head.h"
 
+#include <map>
+#include <numeric>
+
 namespace lux::test::containers
 {
 
@@ -1734,4 +1737,978 @@ namespace lux::test::containers
 
 	};
 
+	TEST_CLASS(sorted_vector_search)
+	{
+		template< class Search >
+		static void check_bounds(const std::vector<simple_t>& keys) {
+			Search search;
+			std::less<simple_t> comp;
+
+			for (simple_t key = -1; key <= MAX_KEY_VALUE; key += 7) {
+				auto lb = search.lower_bound(keys.data(), keys.size(), key, comp);
+				auto ub = search.upper_bound(keys.data(), keys.size(), key, comp);
+
+				Assert::AreEqual(size_t(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin()), lb, L"lower_bound mismatch");
+				Assert::AreEqual(size_t(std::upper_bound(keys.begin(), keys.end(), key) - keys.begin()), ub, L"upper_bound mismatch");
+			}
+		}
+
+		template< class Search >
+		static void check_policy() {
+			std::vector<simple_t> keys;
+			check_bounds<Search>(keys);
+
+			for (size_t len : { 1, 2, 3, 64, 100, 1000 }) {
+				keys.clear();
+				for (size_t i = 0; i < len; i++)
+					keys.push_back(rand() % MAX_KEY_VALUE);
+				std::sort(keys.begin(), keys.end());
+
+				check_bounds<Search>(keys);
+			}
+		}
+
+	public:
+		sorted_vector_search() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(binary_search) {
+			check_policy<lux::binary_search>();
+		}
+		TEST_METHOD(branchless_search) {
+			check_policy<lux::branchless_search>();
+		}
+		TEST_METHOD(simd_index_search) {
+			check_policy<lux::simd_index_search<>>();
+		}
+
+		TEST_METHOD(interpolation_search) {
+			check_policy<lux::interpolation_search<>>();
+		}
+
+		TEST_METHOD(interpolation_skew) {
+			// cubic keys are far from uniform
+			std::vector<uint64_t> keys;
+			for (uint64_t i = 0; i < 10000; i++)
+				keys.push_back(i * i * i);
+
+			lux::interpolation_search<> search;
+			std::less<uint64_t> comp;
+			for (uint64_t i = 0; i < 2000; i++) {
+				auto key = (i * 7919) % 10000;
+				key = key * key * key + (i % 2);
+
+				Assert::AreEqual(size_t(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin()), search.lower_bound(keys.data(), keys.size(), key, comp), L"lower_bound mismatch");
+				Assert::AreEqual(size_t(std::upper_bound(keys.begin(), keys.end(), key) - keys.begin()), search.upper_bound(keys.data(), keys.size(), key, comp), L"upper_bound mismatch");
+			}
+			Assert::IsTrue(search.skewed(), L"skew not detected");
+		}
+
+		TEST_METHOD(interpolation_lookup) {
+			using ov_type = lux::sorted_vector<uint64_t, simple_t, std::less<uint64_t>, std::allocator<lux::sorted_vector_type<uint64_t, simple_t>>, lux::interpolation_search<>>;
+
+			ov_type ov;
+			for (uint64_t i = 0; i < 10000; i++)
+				ov.emplace(i * 3, simple_t(i));
+
+			for (uint64_t key = 0; key < 30010; key++) {
+				Assert::AreEqual(key < 30000 && key % 3 == 0, ov.contains(key), L"contains mismatch");
+				Assert::AreEqual(ov.contains(key), ov.find(key) != ov.end(), L"find mismatch");
+
+				auto lb = ov.lower_bound(key);
+				if (lb != ov.end())
+					Assert::IsTrue(lb->key() >= key && (lb == ov.begin() || (lb - 1)->key() < key), L"lower_bound mismatch");
+				auto ub = ov.upper_bound(key);
+				if (ub != ov.end())
+					Assert::IsTrue(ub->key() > key && (ub == ov.begin() || (ub - 1)->key() <= key), L"upper_bound mismatch");
+			}
+			Assert::IsFalse(ov.search_policy().skewed(), L"uniform keys reported as skewed");
+		}
+
+		TEST_METHOD(learned_search) {
+			check_policy<lux::learned_search<>>();
+			check_policy<lux::learned_search<4>>();
+		}
+
+		TEST_METHOD(learned_model) {
+			// piecewise shapes: quadratic, then a jump, then dense runs with duplicates
+			std::vector<uint64_t> keys;
+			for (uint64_t i = 0; i < 20000; i++)
+				keys.push_back(i * i);
+			for (uint64_t i = 0; i < 20000; i++)
+				keys.push_back(uint64_t(1) << 40 | (i / 3));
+
+			lux::learned_search<16> search;
+			std::less<uint64_t> comp;
+			auto check = [&](uint64_t key) {
+				Assert::AreEqual(size_t(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin()), search.lower_bound(keys.data(), keys.size(), key, comp), L"lower_bound mismatch");
+				Assert::AreEqual(size_t(std::upper_bound(keys.begin(), keys.end(), key) - keys.begin()), search.upper_bound(keys.data(), keys.size(), key, comp), L"upper_bound mismatch");
+			};
+
+			for (size_t i = 0; i < 5000; i++) {
+				check(keys[rand() % keys.size()]);
+				check(keys[rand() % keys.size()] + 1);
+			}
+			check(0), check(uint64_t(-1));
+
+			Assert::IsTrue(search.trained(), L"model not trained");
+			Assert::IsTrue(search.segments() > 1 && search.segments() < keys.size() / 16, L"unexpected segment count");
+
+			// a stale model must still give exact results
+			for (auto& key : keys)
+				key *= 2;
+			for (size_t i = 0; i < 2000; i++)
+				check(keys[rand() % keys.size()] + rand() % 2);
+		}
+
+		TEST_METHOD(learned_lookup) {
+			using ov_type = lux::sorted_vector<uint64_t, simple_t, std::less<uint64_t>, std::allocator<lux::sorted_vector_type<uint64_t, simple_t>>, lux::learned_search<>>;
+
+			ov_type ov;
+			for (uint64_t i = 0; i < 10000; i++)
+				ov.emplace(i * i, simple_t(i));
+
+			auto check = [&]() {
+				for (size_t i = 0; i < 2000; i++) {
+					auto key = uint64_t(rand() % 10000);
+					key = key * key + rand() % 2;
+
+					auto expected = std::partition_point(ov.begin(), ov.end(), [&](const auto& el) { return el.key() < key; });
+					Assert::IsTrue(expected == ov.lower_bound(key), L"lower_bound mismatch");
+					Assert::AreEqual(expected != ov.end() && expected->key() == key, ov.contains(key), L"contains mismatch");
+					Assert::AreEqual(ov.contains(key), ov.find(key) != ov.end(), L"find mismatch");
+					auto ub = ov.upper_bound(key);
+					if (ub != ov.end())
+						Assert::IsTrue(ub->key() > key && (ub == ov.begin() || (ub - 1)->key() <= key), L"upper_bound mismatch");
+				}
+			};
+
+			check();
+			Assert::IsTrue(ov.search_policy().trained(), L"model not trained");
+			Assert::IsTrue(ov.contains(99 * 99), L"contains mismatch");
+			Assert::IsFalse(ov.contains(99 * 99 + 1), L"contains mismatch");
+
+			// every mutation drops the model, it is trained again on the new keys
+			ov.emplace(3, 0);
+			Assert::IsFalse(ov.search_policy().trained(), L"emplace must invalidate the model");
+			ov.erase_range(100, 100000);
+			Assert::IsFalse(ov.search_policy().trained(), L"erase must invalidate the model");
+			check();
+			Assert::IsTrue(ov.search_policy().trained(), L"model not trained again");
+			Assert::IsTrue(ov.contains(3) && !ov.contains(400) && ov.contains(400 * 400), L"lookup after the mutations mismatch");
+
+			auto copy = ov;
+			Assert::IsFalse(copy.search_policy().trained(), L"a copy must train its own model");
+			Assert::AreEqual(ov.size(), copy.size(), L"copy mismatch");
+		}
+
+		TEST_METHOD(learned_subranges) {
+			using ov_type = lux::sorted_vector<uint64_t, simple_t, std::less<uint64_t>, std::allocator<lux::sorted_vector_type<uint64_t, simple_t>>, lux::learned_search<>>;
+
+			ov_type ov;
+			for (uint64_t i = 0; i < 10000; i++)
+				ov.emplace(i * 3, simple_t(i));
+
+			// galloping and hinted lookups search subranges first, they must not train the model
+			std::vector<uint64_t> sorted_keys;
+			for (uint64_t i = 0; i < 30000; i += 7)
+				sorted_keys.push_back(i);
+			std::vector<size_t> out(sorted_keys.size());
+			for (size_t i = 0; i < 20; i++)
+				ov.lower_bound_many(sorted_keys, out);
+			Assert::IsFalse(ov.search_policy().trained(), L"a subrange must not train the model");
+
+			for (uint64_t i = 0; i < 2000; i++)
+				Assert::IsTrue(ov.contains((i * 5 % 10000) * 3), L"contains mismatch");
+			Assert::AreEqual(ov.size(), ov.search_policy().model_size(), L"the model must cover the whole array");
+			for (uint64_t i = 0; i < 2000; i++)
+				Assert::AreEqual(size_t(i * 5 % 10000), size_t(ov.lower_bound((i * 5 % 10000) * 3) - ov.begin()), L"lower_bound mismatch");
+
+			// a lookup over another array trains a new model once it has paid for it
+			lux::learned_search<> search;
+			std::vector<uint64_t> small(1000), large(4000);
+			std::iota(small.begin(), small.end(), uint64_t(0));
+			std::iota(large.begin(), large.end(), uint64_t(0));
+			for (size_t i = 0; i < 200; i++)
+				search.lower_bound(small.data(), small.size(), uint64_t(rand() % 1000), std::less<uint64_t>());
+			Assert::AreEqual(small.size(), search.model_size(), L"model of the first array mismatch");
+			for (size_t i = 0; i < 400; i++)
+				Assert::AreEqual(size_t(i * 7), search.lower_bound(large.data(), large.size(), uint64_t(i * 7), std::less<uint64_t>()), L"lower_bound mismatch");
+			Assert::AreEqual(large.size(), search.model_size(), L"the model must follow the array");
+
+			// the sibling containers drop the model on their changes
+			lux::split_sorted_vector<uint64_t, simple_t, std::less<uint64_t>, std::allocator<uint64_t>, lux::learned_search<>> split;
+			for (uint64_t i = 0; i < 4000; i++)
+				split.emplace(i * 2, simple_t(i));
+			for (uint64_t i = 0; i < 1000; i++)
+				split.contains(i * 4);
+			Assert::IsTrue(split.search_policy().trained(), L"split model not trained");
+			split.emplace(1, 0);
+			Assert::IsFalse(split.search_policy().trained(), L"an insert must drop the split model");
+			for (uint64_t i = 0; i < 1000; i++)
+				Assert::IsTrue(split.contains(i * 4), L"split contains mismatch");
+			Assert::AreEqual(split.size(), split.search_policy().model_size(), L"split model not trained again");
+
+			lux::sorted_multivector<uint64_t, simple_t, std::less<uint64_t>, std::allocator<lux::sorted_vector_type<uint64_t, simple_t>>, lux::learned_search<>> multi;
+			for (uint64_t i = 0; i < 4000; i++)
+				multi.emplace(i / 2, simple_t(i));
+			for (uint64_t i = 0; i < 1000; i++)
+				Assert::AreEqual(size_t(2), multi.count(i), L"multivector count mismatch");
+			// the lower bound of an equal range trains the model, the upper bound searched in the rest must not replace it
+			Assert::AreEqual(multi.size(), multi.search_policy().model_size(), L"multivector model not trained");
+			multi.erase(uint64_t(5));
+			Assert::IsFalse(multi.search_policy().trained(), L"an erase must drop the multivector model");
+		}
+
+		TEST_METHOD(bloom_search) {
+			check_policy<lux::bloom_search<>>();
+		}
+
+		TEST_METHOD(bloom_filter) {
+			using ov_type = lux::sorted_vector<uint64_t, simple_t, std::less<uint64_t>, std::allocator<lux::sorted_vector_type<uint64_t, simple_t>>, lux::bloom_search<>>;
+
+			ov_type ov;
+			for (uint64_t i = 0; i < 20000; i++)
+				ov.emplace(i * 2, simple_t(i));
+
+			// the even keys are present, the odd ones are the misses
+			auto check = [&](size_t lookups) {
+				for (size_t i = 0; i < lookups; i++) {
+					const auto key = uint64_t(rand() % 50000);
+					const bool present = key % 2 == 0 && key < 40000 && !(key >= 1000 && key < 2000);
+					Assert::AreEqual(present, ov.contains(key), L"contains mismatch");
+					Assert::AreEqual(size_t(present), ov.count(key), L"count mismatch");
+					Assert::AreEqual(present, ov.find(key) != ov.end(), L"find mismatch");
+				}
+			};
+
+			ov.erase_range(1000, 2000);
+			check(2000);
+			const auto& filter = ov.search_policy();
+			Assert::IsTrue(filter.built(), L"filter not built");
+
+			size_t passed = 0, misses = 0;
+			const auto& keys = std::as_const(ov).vector();
+			for (uint64_t key = 40001; key < 240001; key += 2, misses++)
+				passed += filter.may_contain(keys.data(), keys.size(), key, std::less<uint64_t>(), [](const auto& el) -> const uint64_t& { return el.key(); });
+			const double measured = double(passed) / double(misses);
+			Assert::IsTrue(measured < 0.03, L"too many false positives");
+			Assert::IsTrue(filter.false_positive_rate() > 0.001 && filter.false_positive_rate() < 0.03, L"unexpected false positive estimate");
+			Assert::IsTrue(filter.memory_usage() <= ov.size() * 2 + 64, L"filter too large");
+
+			// the new keys join the filter, an erase drops it
+			for (uint64_t key = 40000; key < 42000; key += 2)
+				ov.emplace(key, 0);
+			Assert::IsTrue(filter.built(), L"inserts must keep the filter");
+			for (uint64_t key = 40000; key < 42000; key += 2)
+				Assert::IsTrue(ov.contains(key), L"an inserted key was rejected");
+			ov.erase_range(40000, 42000);
+			Assert::IsFalse(filter.built(), L"erase must drop the filter");
+			check(2000);
+
+			// past the room left for the inserts the filter is rebuilt
+			for (uint64_t key = 100001; key < 120001; key += 2)
+				ov.emplace(key, 0);
+			Assert::IsFalse(filter.built(), L"an overfull filter must be dropped");
+			Assert::IsTrue(ov.contains(100001) && !ov.contains(100000), L"contains mismatch");
+
+			// a key edited in place keeps the size, the mutable vector must still drop the filter
+			check(2000);
+			Assert::IsTrue(filter.built(), L"filter not built");
+			ov.vector()[10] = ov_type::value_type(21, 0);
+			Assert::IsFalse(filter.built(), L"the mutable vector must drop the filter");
+			Assert::IsTrue(ov.contains(21) && !ov.contains(20), L"an edited key was rejected");
+		}
+
+		TEST_METHOD(bloom_siblings) {
+			using ssv_type = lux::split_sorted_vector<uint64_t, simple_t, std::less<uint64_t>, std::allocator<uint64_t>, lux::bloom_search<>>;
+			using multi_type = lux::sorted_multivector<uint64_t, simple_t, std::less<uint64_t>, std::allocator<lux::sorted_vector_type<uint64_t, simple_t>>, lux::bloom_search<>>;
+
+			ssv_type ssv;
+			multi_type multi;
+			for (uint64_t i = 0; i < 4000; i++)
+				ssv.emplace(i * 2, simple_t(i)), multi.emplace(i * 2, simple_t(i));
+
+			for (uint64_t key = 0; key < 8000; key++) {
+				Assert::AreEqual(key % 2 == 0, ssv.contains(key), L"split contains mismatch");
+				Assert::AreEqual(size_t(key % 2 == 0), multi.count(key), L"multivector count mismatch");
+			}
+			Assert::IsTrue(ssv.search_policy().built() && multi.search_policy().built(), L"filter not built");
+
+			// the inserted keys join the filters, an erase drops them
+			ssv.emplace(uint64_t(1), 0);
+			multi.emplace(uint64_t(1), 0);
+			multi.emplace(uint64_t(1), 1);
+			Assert::IsTrue(ssv.search_policy().built() && multi.search_policy().built(), L"inserts must keep the filter");
+			Assert::IsTrue(ssv.contains(1) && ssv.find(1) != ssv.end(), L"an inserted key was rejected");
+			Assert::AreEqual(size_t(2), multi.count(1), L"an inserted key was rejected");
+
+			ssv.erase(uint64_t(1));
+			multi.erase(uint64_t(1));
+			Assert::IsFalse(ssv.search_policy().built() || multi.search_policy().built(), L"erase must drop the filter");
+			Assert::IsFalse(ssv.contains(1) || multi.contains(1), L"an erased key was found");
+		}
+
+		template< class Ty >
+		static void check_simd_keys() {
+			std::vector<Ty> keys;
+			for (size_t i = 0; i < 4000; i++)
+				keys.push_back(static_cast<Ty>(rand() % 8000) - static_cast<Ty>(std::is_signed_v<Ty> ? 4000 : 0));
+			keys.push_back(std::numeric_limits<Ty>::max());
+			std::sort(keys.begin(), keys.end());
+
+			lux::simd_index_search<> search;
+			std::less<Ty> comp;
+			auto check = [&](Ty key) {
+				Assert::AreEqual(size_t(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin()), search.lower_bound(keys.data(), keys.size(), key, comp), L"lower_bound mismatch");
+				Assert::AreEqual(size_t(std::upper_bound(keys.begin(), keys.end(), key) - keys.begin()), search.upper_bound(keys.data(), keys.size(), key, comp), L"upper_bound mismatch");
+			};
+
+			for (size_t i = 0; i < 4000; i++)
+				check(static_cast<Ty>(i * 2) - static_cast<Ty>(std::is_signed_v<Ty> ? 4000 : 0));
+			for (Ty key : { keys.front(), keys.back(), std::numeric_limits<Ty>::lowest(), static_cast<Ty>(0), static_cast<Ty>(7999) })
+				check(key);
+			// the 64 bit keys go to the fallback
+			Assert::AreEqual(lux::cpu().sse42 && sizeof(Ty) == 4 ? keys.size() : size_t(0), search.index_size(), L"index size mismatch");
+
+			// the index is stale once the keys change without invalidate(), the results must stay exact
+			for (auto& key : keys)
+				key = key / 2;
+			for (size_t i = 0; i < 4000; i++)
+				check(static_cast<Ty>(i) - static_cast<Ty>(std::is_signed_v<Ty> ? 2000 : 0));
+		}
+
+		TEST_METHOD(simd_key_types) {
+			check_simd_keys<int32_t>();
+			check_simd_keys<uint32_t>();
+			check_simd_keys<int64_t>();
+			check_simd_keys<uint64_t>();
+			check_simd_keys<float>();
+			check_simd_keys<double>();
+		}
+
+		TEST_METHOD(simd_index_map) {
+			// the keys of a map are not contiguous, they are indexed all the same
+			lux::sorted_vector<uint32_t, simple_t, std::less<uint32_t>, std::allocator<lux::sorted_vector_type<uint32_t, simple_t>>, lux::simd_index_search<>> sv;
+			for (uint32_t i = 0; i < 5000; i++)
+				sv.emplace(i * 3, simple_t(i));
+
+			for (int pass = 0; pass < 2; pass++) {
+				for (uint32_t key = 0; key < 15010; key++) {
+					Assert::AreEqual(key < 15000 && key % 3 == 0, sv.contains(key), L"contains mismatch");
+					auto ub = sv.upper_bound(key);
+					Assert::IsTrue(ub == sv.end() || (ub->key() > key && (ub == sv.begin() || (ub - 1)->key() <= key)), L"upper_bound mismatch");
+				}
+				if (lux::cpu().sse42)
+					Assert::AreEqual(sv.size(), sv.search_policy().index_size(), L"index not built");
+
+				sv.emplace(uint32_t(15000), 0);
+				Assert::IsFalse(sv.search_policy().indexed(), L"an insert must drop the index");
+				sv.erase(uint32_t(15000));
+			}
+
+			auto copy = sv;
+			Assert::IsFalse(copy.search_policy().indexed(), L"a copy must build its own index");
+		}
+
+		TEST_METHOD(policy_lookup) {
+			using ov_type = lux::sorted_vector<simple_t, simple_t, std::less<simple_t>, std::allocator<lux::sorted_vector_type<simple_t, simple_t>>, lux::binary_search>;
+
+			ov_type ov;
+			for (simple_t i = 0; i < 100; i += 2)
+				ov.emplace(i, i * 10);
+
+			for (simple_t i = -1; i < 101; i++) {
+				Assert::AreEqual(i >= 0 && i < 100 && i % 2 == 0, ov.contains(i), L"contains mismatch");
+				Assert::AreEqual(ov.contains(i), ov.find(i) != ov.end(), L"find mismatch");
+			}
+
+			// missing keys past the end are inserted, not rejected
+			ov[1000] = 1;
+			Assert::AreEqual(1, ov.at(1000), L"op_array failure");
+			Assert::ExpectException<std::out_of_range>([&]() { ov.at(2000); }, L"at failure");
+		}
+	};
+
+	TEST_CLASS(sorted_vector_batch)
+	{
+		using ov_type = lux::sorted_vector<simple_t, simple_t>;
+
+		ov_type _ov;
+
+		void check(const std::vector<simple_t>& keys) {
+			std::vector<ov_type::size_type> pos(keys.size());
+			std::vector<ov_type::iterator> its(keys.size());
+			std::unique_ptr<bool[]> found(new bool[keys.size()]);
+
+			_ov.lower_bound_many(keys, pos);
+			_ov.find_many(keys, its);
+			_ov.contains_many(keys, std::span<bool>(found.get(), keys.size()));
+
+			for (size_t i = 0; i < keys.size(); i++) {
+				Assert::IsTrue(_ov.begin() + pos[i] == _ov.lower_bound(keys[i]), L"lower_bound_many mismatch");
+				Assert::IsTrue(its[i] == _ov.find(keys[i]), L"find_many mismatch");
+				Assert::AreEqual(_ov.contains(keys[i]), found[i], L"contains_many mismatch");
+			}
+		}
+
+		template< class Search >
+		static auto check_policy() {
+			lux::sorted_vector<simple_t, simple_t, std::less<simple_t>, std::allocator<lux::sorted_vector_type<simple_t, simple_t>>, Search> ov;
+			for (size_t i = 0; i < KEYC; i++)
+				ov.emplace(rand() % MAX_KEY_VALUE, rand());
+
+			// a sorted prefix walked by galloping, then keys in any order
+			std::vector<simple_t> keys;
+			for (size_t i = 0; i < 50; i++)
+				keys.push_back(rand() % (MAX_KEY_VALUE + 10) - 5);
+			std::sort(keys.begin(), keys.end());
+			for (size_t i = 0; i < 200; i++)
+				keys.push_back(rand() % (MAX_KEY_VALUE + 10) - 5);
+
+			std::vector<size_t> pos(keys.size());
+			std::vector<typename decltype(ov)::const_iterator> its(keys.size());
+			std::unique_ptr<bool[]> found(new bool[keys.size()]);
+			for (size_t round = 0; round < 20; round++) {
+				std::as_const(ov).lower_bound_many(keys, pos);
+				std::as_const(ov).find_many(keys, its);
+				ov.contains_many(keys, std::span<bool>(found.get(), keys.size()));
+			}
+
+			for (size_t i = 0; i < keys.size(); i++) {
+				Assert::IsTrue(ov.cbegin() + pos[i] == std::as_const(ov).lower_bound(keys[i]), L"lower_bound_many mismatch");
+				Assert::IsTrue(its[i] == std::as_const(ov).find(keys[i]), L"find_many mismatch");
+				Assert::AreEqual(ov.contains(keys[i]), found[i], L"contains_many mismatch");
+			}
+			return ov;
+		}
+
+	public:
+		sorted_vector_batch() {
+			srand(time(nullptr));
+			for (size_t i = 0; i < KEYC; i++)
+				_ov.emplace(rand() % MAX_KEY_VALUE, rand());
+		}
+
+		TEST_METHOD(unsorted_keys) {
+			std::vector<simple_t> keys;
+			for (size_t i = 0; i < 101; i++)
+				keys.push_back(rand() % (MAX_KEY_VALUE + 10) - 5);
+			check(keys);
+		}
+		TEST_METHOD(sorted_keys) {
+			std::vector<simple_t> keys;
+			for (size_t i = 0; i < 101; i++)
+				keys.push_back(rand() % (MAX_KEY_VALUE + 10) - 5);
+			std::sort(keys.begin(), keys.end());
+			check(keys);
+		}
+		TEST_METHOD(empty) {
+			std::vector<simple_t> keys{ 3, 1, 2 };
+			_ov.clear();
+			check(keys);
+			check({});
+		}
+		TEST_METHOD(policies) {
+			check_policy<lux::binary_search>();
+			check_policy<lux::simd_index_search<>>();
+			check_policy<lux::interpolation_search<>>();
+			check_policy<lux::bloom_search<>>();
+
+			// the keys out of order are searched by the policy itself, so the model is trained on the whole array
+			auto ov = check_policy<lux::learned_search<>>();
+			Assert::IsTrue(ov.search_policy().trained(), L"the batched searches must go through the policy");
+		}
+		TEST_METHOD(short_output) {
+			std::vector<simple_t> keys{ 1, 2, 3 };
+			std::vector<ov_type::size_type> pos(2);
+			Assert::ExpectException<std::invalid_argument>([&]() { _ov.lower_bound_many(keys, pos); }, L"short output accepted");
+		}
+	};
+
+	TEST_CLASS(sorted_vector_bulk)
+	{
+		using ov_type = lux::sorted_vector<simple_t, simple_t>;
+
+		static std::vector<std::pair<simple_t, simple_t>> generate(size_t count) {
+			std::vector<std::pair<simple_t, simple_t>> res;
+			for (size_t i = 0; i < count; i++)
+				res.emplace_back(rand() % 1000, rand());
+			return res;
+		}
+
+		static void compare(const ov_type& left, const ov_type& right) {
+			Assert::AreEqual(left.size(), right.size(), L"sizes mismatch");
+			for (auto l = left.begin(), r = right.begin(); l != left.end(); ++l, ++r) {
+				Assert::AreEqual(l->key(), r->key(), L"keys mismatch");
+				Assert::AreEqual(l->value(), r->value(), L"values mismatch");
+			}
+		}
+
+	public:
+		sorted_vector_bulk() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(range_insert) {
+			auto first = generate(300), second = generate(300);
+
+			// one by one insertion is the reference
+			ov_type expected;
+			for (auto& el : first)
+				expected.emplace(el.first, el.second);
+			for (auto& el : second)
+				expected.emplace(el.first, el.second);
+
+			ov_type ov(first.begin(), first.end());
+			Assert::IsTrue(sorted<false>(ov), L"constructor sorted failed");
+			ov.insert(second.begin(), second.end());
+			Assert::IsTrue(sorted<false>(ov), L"insert sorted failed");
+
+			compare(expected, ov);
+		}
+
+		TEST_METHOD(append_only) {
+			ov_type ov{ { 1, 1 }, { 2, 2 } };
+			std::vector<std::pair<simple_t, simple_t>> tail{ { 5, 5 }, { 3, 3 }, { 4, 4 }, { 3, 0 } };
+			ov.insert(tail.begin(), tail.end());
+
+			compare(ov_type{ { 1, 1 }, { 2, 2 }, { 3, 3 }, { 4, 4 }, { 5, 5 } }, ov);
+		}
+
+		TEST_METHOD(sorted_unique) {
+			ov_type source{ { 1, 10 }, { 3, 30 }, { 5, 50 } };
+			auto data = source.extract();
+			Assert::IsTrue(source.empty(), L"extract left entries");
+
+			const auto buffer = data.data();
+			ov_type ov(lux::sorted_unique, std::move(data));
+			Assert::IsTrue(buffer == ov.vector().data(), L"buffer not adopted");
+			compare(ov_type{ { 1, 10 }, { 3, 30 }, { 5, 50 } }, ov);
+
+			ov_type other;
+			other.replace(ov.extract());
+			Assert::IsTrue(buffer == other.vector().data(), L"buffer not replaced");
+			Assert::AreEqual(30, other.at(3), L"lookup after replace failed");
+
+			std::vector<std::pair<simple_t, simple_t>> range{ { 2, 2 }, { 4, 4 } };
+			ov_type copied(lux::sorted_unique, range.begin(), range.end());
+			compare(ov_type{ { 2, 2 }, { 4, 4 } }, copied);
+
+#ifdef _DEBUG
+			ov_type::vector_type unsorted{ { 5, 5 }, { 1, 1 } };
+			Assert::ExpectException<std::invalid_argument>([&]() { ov_type ov(lux::sorted_unique, std::move(unsorted)); }, L"unsorted data accepted");
+#endif // _DEBUG
+		}
+
+		TEST_METHOD(input_iterator) {
+			std::istringstream in("5 3 9 3 1");
+			lux::sorted_vector<simple_t> ov(std::istream_iterator<simple_t>(in), std::istream_iterator<simple_t>{});
+
+			Assert::AreEqual(size_t(4), ov.size(), L"size mismatch");
+			Assert::IsTrue(sorted<false>(ov), L"sorted failed");
+		}
+	};
+
+	TEST_CLASS(sorted_vector_transparent)
+	{
+	public:
+		TEST_METHOD(string_view_lookup) {
+			using tv_type = lux::sorted_vector<std::string, simple_t, std::less<>>;
+
+			tv_type tv;
+			for (simple_t i = 0; i < 200; i++)
+				tv.emplace(std::to_string(i * 2), i);
+
+			for (simple_t i = 0; i < 400; i++) {
+				auto str = std::to_string(i);
+				std::string_view key = str;
+
+				Assert::AreEqual(tv.contains(str), tv.contains(key), L"contains mismatch");
+				Assert::AreEqual(tv.count(str), tv.count(key), L"count mismatch");
+				Assert::IsTrue(tv.find(str) == tv.find(key), L"find mismatch");
+				Assert::IsTrue(tv.lower_bound(str) == tv.lower_bound(key), L"lower_bound mismatch");
+				Assert::IsTrue(tv.upper_bound(str) == tv.upper_bound(key), L"upper_bound mismatch");
+				Assert::IsTrue(tv.equal_range(str) == tv.equal_range(key), L"equal_range mismatch");
+				if (tv.contains(key))
+					Assert::AreEqual(tv.at(str), tv.at(key), L"at mismatch");
+				else
+					Assert::ExpectException<std::out_of_range>([&]() { tv.at(key); }, L"at with a missing key must throw");
+			}
+
+			const auto& ctv = tv;
+			Assert::AreEqual(simple_t(5), ctv.at(std::string_view("10")), L"const at mismatch");
+			Assert::IsTrue(ctv.find(std::string_view("11")) == ctv.end(), L"const find mismatch");
+
+			Assert::AreEqual(size_t(1), tv.erase(std::string_view("10")), L"erase failed");
+			Assert::AreEqual(size_t(0), tv.erase(std::string_view("10")), L"erase of a missing key");
+			Assert::AreEqual(size_t(199), tv.size(), L"size mismatch");
+		}
+
+		TEST_METHOD(lux_less) {
+			using tv_type = lux::sorted_vector<simple_t, simple_t, lux::less<>>;
+
+			tv_type tv;
+			for (simple_t i = 0; i < 100; i++)
+				tv.emplace(i * 3, i);
+
+			for (simple_t i = 0; i < 300; i++) {
+				// a wider key type is compared without converting it
+				long long key = i;
+				Assert::AreEqual(tv.contains(i), tv.contains(key), L"contains mismatch");
+				Assert::IsTrue(tv.lower_bound(i) == tv.lower_bound(key), L"lower_bound mismatch");
+				Assert::IsTrue(tv.upper_bound(i) == tv.upper_bound(key), L"upper_bound mismatch");
+			}
+
+			lux::less<simple_t, long long> comp;
+			Assert::IsTrue(comp(1, 2LL), L"lux::less mismatch");
+			Assert::IsFalse(comp(2LL, 1), L"lux::less mismatch");
+		}
+	};
+
+	TEST_CLASS(sorted_vector_bulk_erase)
+	{
+		using ov_type = lux::sorted_vector<simple_t, simple_t>;
+
+		static ov_type generate(size_t count) {
+			ov_type ov;
+			for (size_t i = 0; i < count; i++)
+				ov.emplace(rand() % MAX_KEY_VALUE, rand());
+			return ov;
+		}
+
+		static bool same(const ov_type& left, const ov_type& right) {
+			return std::equal(left.begin(), left.end(), right.begin(), right.end(), [](auto& l, auto& r) {
+				return l.key() == r.key() && l.value() == r.value();
+			});
+		}
+
+	public:
+		sorted_vector_bulk_erase() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(erase_if) {
+			auto ov = generate(KEYC * 4);
+			auto expected = ov;
+			auto odd = [](const ov_type::value_type& val) { return val.key() % 2 != 0; };
+
+			size_t count = 0;
+			for (auto it = expected.begin(); it != expected.end();) {
+				if (odd(*it))
+					it = expected.erase(it), count++;
+				else
+					++it;
+			}
+
+			Assert::AreEqual(count, ov.erase_if(odd), L"erase_if count mismatch");
+			Assert::IsTrue(same(ov, expected), L"erase_if result mismatch");
+			Assert::AreEqual(size_t(0), lux::erase_if(ov, odd), L"free erase_if count mismatch");
+		}
+
+		TEST_METHOD(erase_keys) {
+			for (size_t len : { size_t(0), size_t(1), size_t(100), size_t(KEYC * 4) }) {
+				auto ov = generate(len);
+				auto expected = ov;
+
+				std::vector<simple_t> keys;
+				for (size_t i = 0; i < len / 2 + 3; i++)
+					keys.push_back(rand() % (MAX_KEY_VALUE + 10) - 5);
+				std::sort(keys.begin(), keys.end());
+				keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+				size_t count = 0;
+				for (auto key : keys)
+					count += expected.erase(key);
+
+				Assert::AreEqual(count, ov.erase_keys(keys.begin(), keys.end()), L"erase_keys count mismatch");
+				Assert::IsTrue(same(ov, expected), L"erase_keys result mismatch");
+			}
+
+			// duplicated keys are harmless
+			ov_type ov{ { 1, 1 }, { 2, 2 }, { 3, 3 } };
+			std::vector<simple_t> keys{ 2, 2, 3, 3 };
+			Assert::AreEqual(size_t(2), ov.erase_keys(keys.begin(), keys.end()), L"erase_keys count mismatch");
+			Assert::AreEqual(size_t(1), ov.size(), L"erase_keys result mismatch");
+		}
+
+		TEST_METHOD(erase_range) {
+			auto ov = generate(KEYC * 4);
+			for (size_t i = 0; i < 20; i++) {
+				simple_t lo = rand() % MAX_KEY_VALUE, hi = lo + rand() % 1000;
+				auto expected = ov;
+
+				size_t count = 0;
+				for (simple_t key = lo; key < hi; key++)
+					count += expected.erase(key);
+
+				Assert::AreEqual(count, ov.erase_range(lo, hi), L"erase_range count mismatch");
+				Assert::IsTrue(same(ov, expected), L"erase_range result mismatch");
+			}
+			Assert::AreEqual(size_t(0), ov.erase_range(10, 5), L"an empty range erases nothing");
+		}
+	};
+
+	TEST_CLASS(sorted_vector_set_algebra)
+	{
+		using ov_type = lux::sorted_vector<simple_t, simple_t>;
+
+		static ov_type generate(size_t count, simple_t tag) {
+			ov_type ov;
+			for (size_t i = 0; i < count; i++)
+				ov.emplace(rand() % MAX_KEY_VALUE, tag);
+			return ov;
+		}
+
+		static std::vector<simple_t> keys(const ov_type& ov) {
+			std::vector<simple_t> res;
+			for (auto& el : ov)
+				res.push_back(el.key());
+			return res;
+		}
+
+		template< class Op >
+		static void check(const ov_type& res, const ov_type& left, const ov_type& right, Op op) {
+			auto lk = keys(left), rk = keys(right);
+			std::vector<simple_t> expected;
+			op(lk.begin(), lk.end(), rk.begin(), rk.end(), std::back_inserter(expected));
+			Assert::IsTrue(keys(res) == expected, L"keys mismatch");
+
+			// the entries of left win on equal keys
+			for (auto& el : res) {
+				if (left.contains(el.key()))
+					Assert::AreEqual(simple_t(0), el.value(), L"the entry of left must be kept");
+			}
+		}
+
+		// sizes with both balanced and unbalanced pairs
+		static constexpr size_t sizes[] = { 0, 1, 10, 500, 5000 };
+
+	public:
+		sorted_vector_set_algebra() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(free_functions) {
+			for (size_t n : sizes) for (size_t m : sizes) {
+				auto left = generate(n, 0), right = generate(m, 1);
+
+				check(lux::set_union(left, right), left, right, [](auto... args) { return std::set_union(args...); });
+				check(lux::set_intersection(left, right), left, right, [](auto... args) { return std::set_intersection(args...); });
+				check(lux::set_difference(left, right), left, right, [](auto... args) { return std::set_difference(args...); });
+				check(lux::set_symmetric_difference(left, right), left, right, [](auto... args) { return std::set_symmetric_difference(args...); });
+			}
+		}
+
+		TEST_METHOD(in_place) {
+			for (size_t n : sizes) for (size_t m : sizes) {
+				auto left = generate(n, 0), right = generate(m, 1);
+
+				auto merged = left;
+				auto expected = lux::set_union(left, right);
+				Assert::AreEqual(expected.size() - left.size(), merged.merge(right), L"merge count mismatch");
+				check(merged, left, right, [](auto... args) { return std::set_union(args...); });
+
+				auto moved = left, source = right;
+				moved.merge(std::move(source));
+				Assert::IsTrue(source.empty(), L"merge must empty the source");
+				check(moved, left, right, [](auto... args) { return std::set_union(args...); });
+
+				auto inter = left;
+				Assert::AreEqual(left.size() - lux::set_intersection(left, right).size(), inter.intersect(right), L"intersect count mismatch");
+				check(inter, left, right, [](auto... args) { return std::set_intersection(args...); });
+
+				auto diff = left;
+				Assert::AreEqual(left.size() - lux::set_difference(left, right).size(), diff.subtract(right), L"subtract count mismatch");
+				check(diff, left, right, [](auto... args) { return std::set_difference(args...); });
+			}
+		}
+	};
+
+	TEST_CLASS(sorted_vector_kway)
+	{
+		using ov_type = lux::sorted_vector<simple_t, simple_t>;
+
+		static std::vector<ov_type> generate(size_t k) {
+			std::vector<ov_type> res(k);
+			for (size_t i = 0; i < k; i++) {
+				auto len = rand() % 300;
+				for (size_t j = 0; j < len; j++)
+					res[i].emplace(rand() % 2000, rand() % 100);
+			}
+			return res;
+		}
+
+		template< class Fold >
+		static void check(const ov_type& res, const std::vector<ov_type>& inputs, Fold fold) {
+			std::map<simple_t, simple_t> expected;
+			for (auto& sv : inputs) {
+				for (auto& el : sv) {
+					auto [it, inserted] = expected.emplace(el.key(), el.value());
+					if (!inserted)
+						it->second = fold(it->second, el.value());
+				}
+			}
+
+			Assert::AreEqual(expected.size(), res.size(), L"size mismatch");
+			auto e_it = expected.begin();
+			for (auto& el : res) {
+				Assert::AreEqual(e_it->first, el.key(), L"order mismatch");
+				Assert::AreEqual(e_it->second, el.value(), L"resolved value mismatch");
+				++e_it;
+			}
+		}
+
+	public:
+		sorted_vector_kway() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(resolvers) {
+			for (size_t k : { 0, 1, 2, 3, 7, 64, 100 }) {
+				auto inputs = generate(k);
+
+				check(lux::merge_all(inputs.begin(), inputs.end()), inputs, [](simple_t kept, simple_t) { return kept; });
+				check(lux::merge_all(inputs.begin(), inputs.end(), lux::last_wins{}), inputs, [](simple_t, simple_t incoming) { return incoming; });
+				check(lux::merge_all(inputs.begin(), inputs.end(), lux::combine{ std::plus<>{} }), inputs, std::plus<>{});
+			}
+		}
+
+		TEST_METHOD(empty_inputs) {
+			std::vector<ov_type> inputs(5);
+			inputs[2].emplace(1, 1);
+			inputs[4].emplace(1, 2), inputs[4].emplace(0, 0);
+
+			auto res = lux::merge_all(inputs.begin(), inputs.end(), lux::last_wins{});
+			Assert::AreEqual(size_t(2), res.size(), L"size mismatch");
+			Assert::AreEqual(simple_t(2), res.at(1), L"last_wins mismatch");
+		}
+	};
+
+	TEST_CLASS(sorted_vector_parallel)
+	{
+		using sv_type = lux::sorted_vector<simple_t, simple_t>;
+
+	public:
+		sorted_vector_parallel() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(construction) {
+			std::vector<sv_type::value_type> input;
+			for (size_t i = 0; i < 50000; i++)
+				input.emplace_back(rand() % 20000, simple_t(i));
+
+			sv_type expected(input.begin(), input.end());
+			sv_type par(std::execution::par, input.begin(), input.end());
+			sv_type seq(std::execution::seq, input.begin(), input.end());
+
+			Assert::AreEqual(expected.size(), par.size(), L"size mismatch");
+			Assert::AreEqual(expected.size(), seq.size(), L"size mismatch");
+			for (size_t i = 0; i < expected.size(); i++) {
+				Assert::AreEqual(expected.vector()[i].key(), par.vector()[i].key(), L"order mismatch");
+				// the first entry of a key wins, like with the sequential insertion
+				Assert::AreEqual(expected.vector()[i].value(), par.vector()[i].value(), L"values mismatch");
+				Assert::AreEqual(expected.vector()[i].value(), seq.vector()[i].value(), L"values mismatch");
+			}
+		}
+
+		TEST_METHOD(insertion) {
+			sv_type sv, par;
+			for (size_t round = 0; round < 5; round++) {
+				std::vector<std::pair<simple_t, simple_t>> input;
+				for (size_t i = 0; i < 5000; i++)
+					input.emplace_back(rand() % 20000, rand());
+
+				sv.insert(input.begin(), input.end());
+				par.insert(std::execution::par_unseq, input.begin(), input.end());
+
+				Assert::AreEqual(sv.size(), par.size(), L"size mismatch");
+				for (size_t i = 0; i < sv.size(); i++) {
+					Assert::AreEqual(sv.vector()[i].key(), par.vector()[i].key(), L"order mismatch");
+					Assert::AreEqual(sv.vector()[i].value(), par.vector()[i].value(), L"values mismatch");
+				}
+			}
+		}
+	};
+
+	TEST_CLASS(sorted_vector_hint)
+	{
+		using sv_type = lux::sorted_vector<simple_t, simple_t>;
+
+		static void same(const std::map<simple_t, simple_t>& map, const sv_type& sv) {
+			Assert::AreEqual(map.size(), sv.size(), L"size mismatch");
+			auto m_it = map.begin();
+			for (auto& el : sv) {
+				Assert::AreEqual(m_it->first, el.key(), L"order mismatch");
+				Assert::AreEqual(m_it->second, el.value(), L"values mismatch");
+				++m_it;
+			}
+		}
+
+	public:
+		sorted_vector_hint() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(append) {
+			std::map<simple_t, simple_t> map;
+			sv_type sv;
+			for (simple_t key = 0; key < 5000; key += 1 + rand() % 3) {
+				auto val = rand();
+				Assert::IsTrue(sv.emplace(key, val).second, L"append failed");
+				map.emplace(key, val);
+				Assert::IsFalse(sv.emplace(key, 0).second, L"the last key must not be appended twice");
+			}
+			Assert::IsTrue(sv.try_emplace(10000, 1).second, L"try_emplace append failed");
+			map.emplace(10000, 1);
+			same(map, sv);
+		}
+
+		TEST_METHOD(hinted) {
+			std::map<simple_t, simple_t> map;
+			sv_type sv;
+
+			// nearly sorted stream, the previous result is the hint
+			auto hint = sv.cend();
+			for (simple_t i = 0; i < 5000; i++) {
+				auto key = i * 4 + rand() % 12;
+				auto val = rand();
+				auto it = sv.emplace_hint(hint, key, val);
+				map.emplace(key, val);
+				Assert::AreEqual(key, it->key(), L"emplace_hint must return the entry of the key");
+				hint = it + 1;
+			}
+			same(map, sv);
+
+			// any hint, right or wrong, gives the same container
+			for (size_t i = 0; i < 3000; i++) {
+				auto key = simple_t(rand() % 25000);
+				auto val = rand();
+				auto at = sv.cbegin() + rand() % (sv.size() + 1);
+				sv_type::iterator it;
+				switch (rand() % 3) {
+				case 0:
+					it = sv.emplace_hint(at, key, val);
+					break;
+				case 1:
+					it = sv.insert(at, sv_type::value_type(key, val));
+					break;
+				default:
+					it = sv.insert(at, std::make_pair(key, val));
+					break;
+				}
+				map.emplace(key, val);
+				Assert::AreEqual(key, it->key(), L"hinted insert must return the entry of the key");
+				Assert::AreEqual(map[key], it->value(), L"an existing entry must not be replaced");
+			}
+			same(map, sv);
+
+			Assert::AreEqual(map.begin()->first, sv.emplace_hint(sv.cend(), map.begin()->first, 0)->key(), L"hint at the end mismatch");
+			Assert::AreEqual(map.rbegin()->first, sv.emplace_hint(sv.cbegin(), map.rbegin()->first, 0)->key(), L"hint at the front mismatch");
+			same(map, sv);
+		}
+	};
+
 }
@@ -0,0 +1,155 @@
+#include "head.h"
+
+#include <map>
+
+namespace lux::test::containers
+{
+
+	TEST_CLASS(split_sorted_vector)
+	{
+		using sv_type = lux::sorted_vector<simple_t, complex_t>;
+		using pv_type = lux::split_sorted_vector<simple_t, complex_t>;
+
+		static void compare(const sv_type& sv, const pv_type& pv) {
+			Assert::AreEqual(sv.size(), pv.size(), L"size mismatch");
+
+			auto s_it = sv.begin();
+			for (auto p_it = pv.begin(); p_it != pv.end(); ++p_it, ++s_it) {
+				Assert::AreEqual(s_it->key(), p_it->key(), L"order mismatch");
+				Assert::AreEqual(s_it->value(), p_it->value(), L"values mismatch");
+			}
+			Assert::IsTrue(std::is_sorted(pv.keys().begin(), pv.keys().end()), L"keys are not sorted");
+		}
+
+	public:
+		split_sorted_vector() {
+			srand(time(nullptr));
+		}
+
+		TEST_METHOD(modifiers) {
+			sv_type sv;
+			pv_type pv;
+
+			for (size_t i = 0; i < 3000; i++) {
+				auto key = rand() % 500;
+				complex_t val{ rand(), rand() };
+				switch (rand() % 5) {
+				case 0:
+					Assert::AreEqual(sv.erase(key), pv.erase(key), L"erase mismatch");
+					break;
+				case 1:
+					Assert::AreEqual(sv.insert_or_assign(key, val).second, pv.insert_or_assign(key, val).second, L"insert_or_assign mismatch");
+					break;
+				case 2:
+					Assert::AreEqual(sv.try_emplace(key, val).second, pv.try_emplace(key, val).second, L"try_emplace mismatch");
+					break;
+				case 3:
+					sv[key].x += 1, pv[key].x += 1;
+					break;
+				default:
+					Assert::AreEqual(sv.emplace(key, val).second, pv.emplace(key, val.x, val.y).second, L"emplace mismatch");
+					break;
+				}
+			}
+			compare(sv, pv);
+
+			std::vector<std::pair<simple_t, complex_t>> range;
+			for (size_t i = 0; i < 500; i++)
+				range.emplace_back(rand() % 1000, complex_t{ rand(), rand() });
+			for (auto& [key, val] : range)
+				sv.emplace(key, val);
+			pv.insert(range.begin(), range.end());
+			compare(sv, pv);
+
+			pv.erase(pv.begin(), pv.begin() + 10);
+			sv.erase(sv.begin(), sv.begin() + 10);
+			compare(sv, pv);
+		}
+
+		TEST_METHOD(lookup) {
+			sv_type sv;
+			for (size_t i = 0; i < 1000; i++)
+				sv.emplace(rand() % 5000, complex_t{ rand(), rand() });
+			pv_type pv;
+			for (auto& el : sv)
+				pv.emplace(el.key(), el.value());
+
+			for (simple_t key = -1; key <= 5000; key++) {
+				Assert::AreEqual(sv.contains(key), pv.contains(key), L"contains mismatch");
+				Assert::AreEqual(sv.count(key), pv.count(key), L"count mismatch");
+				Assert::AreEqual(size_t(sv.lower_bound(key) - sv.begin()), size_t(pv.lower_bound(key) - pv.begin()), L"lower_bound mismatch");
+				Assert::AreEqual(size_t(sv.upper_bound(key) - sv.begin()), size_t(pv.upper_bound(key) - pv.begin()), L"upper_bound mismatch");
+
+				auto it = pv.find(key);
+				if (sv.contains(key)) {
+					Assert::AreEqual(sv.at(key), pv.at(key), L"at mismatch");
+					Assert::AreEqual(sv.at(key), it->value(), L"find mismatch");
+				}
+				else {
+					Assert::IsTrue(it == pv.end(), L"find mismatch");
+					Assert::ExpectException<std::out_of_range>([&]() { pv.at(key); }, L"at with a missing key must throw");
+				}
+			}
+		}
+
+		TEST_METHOD(range_insertion) {
+			using str_type = lux::split_sorted_vector<simple_t, std::string>;
+
+			// into an empty container, in front of, past and between the entries, with duplicates in the range
+			for (auto [from, step, present] : { std::tuple{ 0, 1, 0 }, std::tuple{ -1000, 1, 300 }, std::tuple{ 1000, 1, 300 }, std::tuple{ 0, 1, 300 }, std::tuple{ 0, 7, 300 } }) {
+				std::map<simple_t, std::string> ref;
+				str_type pv;
+				for (simple_t i = 0; i < present; i += 3)
+					ref.emplace(i, std::to_string(i)), pv.emplace(i, std::to_string(i));
+
+				std::vector<std::pair<simple_t, std::string>> range;
+				for (simple_t i = 0; i < 200; i++) {
+					const auto key = from + i * step % 150;
+					range.emplace_back(key, std::string(20, 'a' + i % 26));
+				}
+				for (auto& [key, val] : range)
+					ref.emplace(key, val);
+				pv.insert(range.begin(), range.end());
+
+				Assert::AreEqual(ref.size(), pv.size(), L"size mismatch");
+				auto r_it = ref.begin();
+				for (auto ref_entry : pv) {
+					Assert::AreEqual(r_it->first, ref_entry.key(), L"order mismatch");
+					// the entries already present and the first of the duplicates win
+					Assert::IsTrue(r_it->second == ref_entry.value(), L"value mismatch");
+					++r_it;
+				}
+			}
+		}
+
+		TEST_METHOD(transparent) {
+			lux::split_sorted_vector<simple_t, complex_t, std::less<>> pv{ { 1, { 1, 1 } }, { 3, { 3, 3 } }, { 5, { 5, 5 } } };
+
+			auto [first, last] = pv.equal_range(3LL);
+			Assert::IsTrue(last - first == 1 && first->key() == 3, L"equal_range mismatch");
+			auto [c_first, c_last] = std::as_const(pv).equal_range(4LL);
+			Assert::IsTrue(c_first == c_last && c_first->key() == 5, L"equal_range of a missing key must be empty");
+			Assert::IsTrue(pv.equal_range(6LL).first == pv.end(), L"equal_range past the end mismatch");
+		}
+
+		TEST_METHOD(proxy_iterator) {
+			pv_type pv{ { 3, { 3, 3 } }, { 1, { 1, 1 } }, { 2, { 2, 2 } } };
+			Assert::AreEqual(size_t(3), pv.size(), L"size mismatch");
+
+			for (auto ref : pv)
+				ref.value().x *= 10;
+			Assert::AreEqual(complex_t{ 20, 2 }, pv.at(2), L"write through the proxy failed");
+
+			std::vector<std::pair<simple_t, complex_t>> copy(pv.begin(), pv.end());
+			Assert::AreEqual(simple_t(1), copy.front().first, L"conversion mismatch");
+			Assert::AreEqual(complex_t{ 30, 3 }, copy.back().second, L"conversion mismatch");
+
+			pv_type::const_iterator c_it = pv.begin();
+			Assert::AreEqual(simple_t(3), c_it[2].key(), L"random access mismatch");
+			Assert::AreEqual(simple_t(3), pv.rbegin()->key(), L"reverse iteration mismatch");
+			Assert::IsTrue(std::lower_bound(pv.keys().begin(), pv.keys().end(), 2) - pv.keys().begin() == 1, L"keys mismatch");
+			Assert::AreEqual(complex_t{ 10, 1 }, pv.values()[0], L"values mismatch");
+		}
+	};
+
+}
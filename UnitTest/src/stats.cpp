@@ -0,0 +1,197 @@
+#include "head.h"
+
+namespace lux::test::containers
+{
+
+	TEST_CLASS(stats)
+	{
+		// a binary search reads one key per halving, so its depth is known
+		using alloc_type = std::allocator<lux::sorted_vector_type<simple_t, simple_t>>;
+		using sv_type = lux::sorted_vector<simple_t, simple_t, std::less<simple_t>, alloc_type, lux::binary_search, lux::counting_stats>;
+		using plain_sv_type = lux::sorted_vector<simple_t, simple_t, std::less<simple_t>, alloc_type, lux::binary_search>;
+
+		// the members of dynamic_array without the recorder
+		struct array_layout {
+			std::allocator<simple_t> alloc;
+			size_t size;
+			simple_t* data;
+		};
+		static_assert(sizeof(lux::dynamic_array<simple_t>) == sizeof(array_layout), "no_stats must take no space");
+		static_assert(sizeof(plain_sv_type) == sizeof(plain_sv_type::vector_type) + sizeof(void*), "no_stats must take no space");
+		static_assert(!std::is_same_v<sv_type, plain_sv_type>, "the stats policy must be part of the type");
+
+	public:
+		TEST_METHOD(json) {
+			lux::container_stats stats;
+			Assert::AreEqual(std::string("{\"enabled\":false,\"comparisons\":0,\"moves\":0,\"bytes_allocated\":0,\"reallocations\":0,"
+				"\"searches\":0,\"search_depth\":0,\"max_search_depth\":0}"), stats.to_json(), L"empty json mismatch");
+			Assert::AreEqual(0.0, stats.mean_search_depth(), L"mean of no search must be 0");
+
+			stats.enabled = true;
+			stats.comparisons = 12, stats.searches = 4, stats.search_depth = 10, stats.max_search_depth = 5;
+			Assert::AreEqual(std::string("{\"enabled\":true,\"comparisons\":12,\"moves\":0,\"bytes_allocated\":0,\"reallocations\":0,"
+				"\"searches\":4,\"search_depth\":10,\"max_search_depth\":5}"), stats.to_json(), L"json mismatch");
+			Assert::AreEqual(2.5, stats.mean_search_depth(), L"mean search depth mismatch");
+		}
+
+		TEST_METHOD(recorder) {
+			lux::counting_stats rec;
+			rec.compared();
+			rec.searched(3);
+			rec.searched(7);
+			rec.searched(2);
+			rec.moved(5);
+			rec.reallocated(64, 4);
+
+			auto stats = rec.get();
+			Assert::IsTrue(stats.enabled, L"enabled mismatch");
+			Assert::AreEqual(uint64_t(13), stats.comparisons, L"comparisons mismatch");
+			Assert::AreEqual(uint64_t(3), stats.searches, L"searches mismatch");
+			Assert::AreEqual(uint64_t(12), stats.search_depth, L"search depth mismatch");
+			Assert::AreEqual(uint64_t(7), stats.max_search_depth, L"max search depth mismatch");
+			Assert::AreEqual(uint64_t(9), stats.moves, L"moves mismatch");
+			Assert::AreEqual(uint64_t(64), stats.bytes_allocated, L"bytes mismatch");
+			Assert::AreEqual(uint64_t(1), stats.reallocations, L"reallocations mismatch");
+
+			auto copy = rec;
+			Assert::AreEqual(uint64_t(0), copy.get().comparisons, L"a copy must start from zero");
+
+			rec.reset();
+			Assert::AreEqual(lux::container_stats{ true }.to_json(), rec.get().to_json(), L"reset failed");
+
+			lux::no_stats off;
+			off.searched(3);
+			Assert::IsFalse(off.get().enabled, L"no_stats must not count");
+			Assert::AreEqual(uint64_t(0), off.get().comparisons, L"no_stats must not count");
+		}
+
+		TEST_METHOD(sorted_vector) {
+			sv_type sv;
+			for (simple_t i = 1000; i > 0; i--)
+				sv.emplace(i, i);
+
+			auto stats = sv.stats();
+			Assert::IsTrue(stats.enabled, L"enabled mismatch");
+			// every entry was inserted at the front
+			Assert::IsTrue(stats.moves >= 999 * 1000 / 2, L"the shifted entries must be counted");
+			Assert::IsTrue(stats.reallocations > 0 && stats.bytes_allocated >= 1000 * sizeof(sv_type::value_type), L"the growth must be counted");
+			Assert::AreEqual(uint64_t(999), stats.searches, L"every insertion after the first must search once");
+
+			sv.reset_stats();
+			for (simple_t i = 0; i < 100; i++)
+				sv.contains(i * 10);
+
+			stats = sv.stats();
+			Assert::AreEqual(uint64_t(100), stats.searches, L"searches mismatch");
+			Assert::IsTrue(stats.max_search_depth <= 11 && stats.search_depth >= 100 * 9, L"a binary search reads about log2(n) keys");
+			Assert::IsTrue(stats.comparisons > stats.search_depth, L"the key match must be counted");
+			Assert::AreEqual(uint64_t(0), stats.moves, L"a lookup must not move");
+
+			sv.erase(sv.begin());
+			Assert::AreEqual(uint64_t(999), sv.stats().moves, L"the erase shift must be counted");
+
+			auto copy = sv;
+			Assert::AreEqual(uint64_t(0), copy.stats().searches, L"a copy must start from zero");
+		}
+
+		TEST_METHOD(no_stats) {
+			// the default policy, in the same program as the counting containers above
+			plain_sv_type sv;
+			for (simple_t i = 1000; i > 0; i--)
+				sv.emplace(i, i);
+			for (simple_t i = 0; i < 100; i++)
+				sv.contains(i * 10);
+			Assert::AreEqual(lux::container_stats{}.to_json(), sv.stats().to_json(), L"the counters must be compiled out");
+
+			lux::sorted_multivector<simple_t, simple_t> mv;
+			mv.emplace(1, 1);
+			Assert::AreEqual(lux::container_stats{}.to_json(), mv.stats().to_json(), L"the counters must be compiled out");
+
+			lux::dynamic_array<simple_t> arr(size_t(10));
+			arr.resize(20);
+			Assert::AreEqual(lux::container_stats{}.to_json(), arr.stats().to_json(), L"the counters must be compiled out");
+		}
+
+		TEST_METHOD(batched_lookups) {
+			sv_type sv;
+			for (simple_t i = 0; i < 1000; i++)
+				sv.emplace(i, i);
+
+			// the first key is found by the galloping walk, the unsorted rest by the batched search
+			std::vector<simple_t> keys;
+			for (simple_t i = 100; i > 0; i--)
+				keys.push_back(i * 7);
+			std::unique_ptr<bool[]> found(new bool[keys.size()]);
+
+			sv.reset_stats();
+			sv.contains_many(keys, std::span<bool>(found.get(), keys.size()));
+			auto stats = sv.stats();
+			Assert::AreEqual(uint64_t(100), stats.searches, L"every batched key must be searched once");
+			Assert::IsTrue(stats.search_depth >= 99 * 9, L"the batched search reads about log2(n) keys per key");
+			Assert::IsTrue(stats.comparisons > stats.search_depth, L"the order check and the key match must be counted");
+		}
+
+		TEST_METHOD(sorted_multivector) {
+			lux::sorted_multivector<simple_t, simple_t, std::less<simple_t>, alloc_type, lux::binary_search, lux::counting_stats> mv;
+			for (simple_t i = 0; i < 1000; i++)
+				mv.emplace(i / 2, i);
+
+			auto stats = mv.stats();
+			Assert::IsTrue(stats.enabled, L"enabled mismatch");
+			// every key is not less than the last one, so it is appended after a single comparison
+			Assert::AreEqual(uint64_t(0), stats.searches, L"an append must not search");
+			Assert::AreEqual(uint64_t(999), stats.comparisons, L"an append costs a single comparison");
+			Assert::IsTrue(stats.reallocations > 0, L"the growth must be counted");
+
+			mv.reset_stats();
+			Assert::AreEqual(size_t(2), mv.count(10), L"count mismatch");
+			Assert::AreEqual(uint64_t(2), mv.stats().searches, L"the upper bound is searched after the lower one");
+
+			mv.reset_stats();
+			Assert::AreEqual(size_t(0), mv.count(-1), L"count mismatch");
+			Assert::AreEqual(uint64_t(1), mv.stats().searches, L"a missing key must cost a single search");
+
+			mv.erase(mv.begin());
+			Assert::AreEqual(uint64_t(999), mv.stats().moves, L"the erase shift must be counted");
+		}
+
+		TEST_METHOD(bulk_erase) {
+			sv_type sv;
+			for (simple_t i = 0; i < 100; i++)
+				sv.emplace(i, i);
+
+			sv.reset_stats();
+			Assert::AreEqual(size_t(50), sv.erase_if([](const auto& entry) { return entry.key() % 2 == 0; }), L"erase_if mismatch");
+			Assert::AreEqual(uint64_t(50), sv.stats().moves, L"erase_if moves every kept entry behind a hole");
+
+			sv_type other;
+			for (simple_t i = 0; i < 100; i += 4)
+				other.emplace(i + 1, i + 1);
+
+			sv.reset_stats();
+			Assert::AreEqual(size_t(25), sv.subtract(other), L"subtract mismatch");
+			Assert::AreEqual(uint64_t(25), sv.stats().moves, L"subtract moves every kept entry behind a hole");
+
+			other.clear();
+			for (simple_t i = 0; i < 100; i += 8)
+				other.emplace(i + 3, i + 3);
+
+			sv.reset_stats();
+			sv.intersect(other);
+			Assert::AreEqual(size_t(13), sv.size(), L"intersect mismatch");
+			Assert::AreEqual(uint64_t(12), sv.stats().moves, L"intersect moves every kept entry behind a hole");
+		}
+
+		TEST_METHOD(dynamic_array) {
+			lux::dynamic_array<simple_t, std::allocator<simple_t>, lux::counting_stats> arr(size_t(10));
+			arr.resize(20);
+			arr.resize(5);
+
+			auto stats = arr.stats();
+			Assert::AreEqual(uint64_t(2), stats.reallocations, L"reallocations mismatch");
+			Assert::AreEqual(uint64_t(15), stats.moves, L"moves mismatch");
+			Assert::AreEqual(uint64_t(35 * sizeof(simple_t)), stats.bytes_allocated, L"bytes mismatch");
+		}
+	};
+
+}